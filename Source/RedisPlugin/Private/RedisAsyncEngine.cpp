@@ -0,0 +1,596 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisAsyncEngine.h"
+#include "RedisClient.h"
+#include "RedisLatency.h"
+#include "RedisStats.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include "hiredis.h"
+#include "async.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#if PLATFORM_WINDOWS
+typedef SOCKET FRedisSocket;
+typedef int FRedisSockLen;
+#define REDIS_INVALID_SOCKET INVALID_SOCKET
+#define RedisPoll WSAPoll
+#define RedisCloseSocket closesocket
+#else
+typedef int FRedisSocket;
+typedef socklen_t FRedisSockLen;
+#define REDIS_INVALID_SOCKET (-1)
+#define RedisPoll poll
+#define RedisCloseSocket close
+#endif
+
+/** Seconds to wait before reopening a dropped connection. */
+static const double RedisReconnectDelay = 1.0;
+
+/** Upper bound on how long poll() sleeps, so dropped connections get reopened. */
+static const int32 RedisPollTimeoutMs = 100;
+
+struct FRedisAsyncConnection
+{
+	FRedisAsyncConnection() :
+		Context(nullptr), bConnected(false), bReading(false), bWriting(false), Outstanding(0), NextConnectTime(0.0)
+	{	}
+
+	redisAsyncContext*	Context;
+	bool				bConnected;
+	bool				bReading;
+	bool				bWriting;
+	int32				Outstanding;
+	double				NextConnectTime;
+};
+
+/* hiredis event hooks. All of them run on the I/O thread. */
+
+static void RedisAddRead(void* PrivData)
+{
+	((FRedisAsyncConnection*)PrivData)->bReading = true;
+}
+
+static void RedisDelRead(void* PrivData)
+{
+	((FRedisAsyncConnection*)PrivData)->bReading = false;
+}
+
+static void RedisAddWrite(void* PrivData)
+{
+	((FRedisAsyncConnection*)PrivData)->bWriting = true;
+}
+
+static void RedisDelWrite(void* PrivData)
+{
+	((FRedisAsyncConnection*)PrivData)->bWriting = false;
+}
+
+static void RedisCleanup(void* PrivData)
+{
+	FRedisAsyncConnection* Connection = (FRedisAsyncConnection*)PrivData;
+	Connection->bReading = false;
+	Connection->bWriting = false;
+}
+
+static void OnRedisConnectionLost(FRedisAsyncConnection* Connection)
+{
+	Connection->Context = nullptr;
+	Connection->bConnected = false;
+	Connection->NextConnectTime = FPlatformTime::Seconds() + RedisReconnectDelay;
+}
+
+static void OnRedisAsyncConnect(const redisAsyncContext* Context, int Status)
+{
+	FRedisAsyncConnection* Connection = (FRedisAsyncConnection*)Context->data;
+	if (Status != REDIS_OK)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Async connect redis failed. error = %d"), Context->err);
+		OnRedisConnectionLost(Connection);
+		return;
+	}
+	Connection->bConnected = true;
+}
+
+static void OnRedisAsyncDisconnect(const redisAsyncContext* Context, int Status)
+{
+	FRedisAsyncConnection* Connection = (FRedisAsyncConnection*)Context->data;
+	if (Status != REDIS_OK)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Async redis connection lost. error = %d"), Context->err);
+	}
+	OnRedisConnectionLost(Connection);
+}
+
+static void OnRedisSetupReply(redisAsyncContext* Context, void* Reply, void* PrivData)
+{
+	redisReply* RedisReplyPtr = (redisReply*)Reply;
+	if (RedisReplyPtr && RedisReplyPtr->type == REDIS_REPLY_ERROR)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Async redis connection setup failed: %s"), UTF8_TO_TCHAR(RedisReplyPtr->str));
+	}
+}
+
+static void OnRedisRequestReply(redisAsyncContext* Context, void* Reply, void* PrivData)
+{
+	FRedisAsyncConnection* Connection = (FRedisAsyncConnection*)Context->data;
+	--Connection->Outstanding;
+
+	FRedisAsyncRequest* Request = (FRedisAsyncRequest*)PrivData;
+	FRedisStats::EndCommand(Request->TraceId, (const redisReply*)Reply);
+	if (Reply)
+	{
+		const uint64 ReplyCycles = FPlatformTime::Cycles64();
+		FRedisLatency::Record(FRedisLatency::FindCommand(Request->Args.GetName()), Request->WriteCycles - Request->SubmitCycles, ReplyCycles - Request->WriteCycles);
+	}
+	if (Request->OnReply)
+	{
+		Request->OnReply((redisReply*)Reply);
+	}
+	delete Request;
+}
+
+
+FRedisAsyncEngine::FRedisAsyncEngine()
+	: Port(0)
+	, Thread(nullptr)
+	, RepointPort(0)
+	, WakeupSocket((uint64)REDIS_INVALID_SOCKET)
+{
+}
+
+FRedisAsyncEngine::~FRedisAsyncEngine()
+{
+	Shutdown();
+}
+
+bool FRedisAsyncEngine::Start(const FString& InHost, int32 InPort, const FString& InPassword, int32 InConnectionNum)
+{
+	if (bRunning)
+	{
+		return true;
+	}
+
+	Host = InHost;
+	Port = InPort;
+	Password = InPassword;
+
+	if (!CreateWakeupSocket())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Async redis engine failed to create its wakeup socket"));
+		return false;
+	}
+
+	Connections.Reset();
+	for (int32 i = 0; i < FMath::Max(1, InConnectionNum); ++i)
+	{
+		Connections.Add(MakeUnique<FRedisAsyncConnection>());
+	}
+
+	bStopping = false;
+	bRunning = true;
+	Thread = FRunnableThread::Create(this, TEXT("RedisAsyncEngine"), 0, TPri_Normal);
+	if (!Thread)
+	{
+		bRunning = false;
+		CloseWakeupSocket();
+		return false;
+	}
+	return true;
+}
+
+void FRedisAsyncEngine::Shutdown()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	CloseWakeupSocket();
+}
+
+void FRedisAsyncEngine::Stop()
+{
+	bStopping = true;
+	Wakeup();
+}
+
+void FRedisAsyncEngine::Submit(FRedisAsyncRequest* InRequest)
+{
+	if (!bRunning)
+	{
+		while (InRequest)
+		{
+			FRedisAsyncRequest* Next = InRequest->NextInBatch;
+			CompleteRequest(InRequest, nullptr);
+			InRequest = Next;
+		}
+		return;
+	}
+
+	const uint64 SubmitCycles = FPlatformTime::Cycles64();
+	for (FRedisAsyncRequest* Request = InRequest; Request; Request = Request->NextInBatch)
+	{
+		Request->SubmitCycles = SubmitCycles;
+	}
+
+	PendingRequests.Enqueue(InRequest);
+	if (!bWakeupPending.AtomicSet(true))
+	{
+		Wakeup();
+	}
+}
+
+void FRedisAsyncEngine::SubmitBatch(const TArray<FRedisAsyncRequest*>& InRequests)
+{
+	if (InRequests.Num() == 0)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i + 1 < InRequests.Num(); ++i)
+	{
+		InRequests[i]->NextInBatch = InRequests[i + 1];
+	}
+	Submit(InRequests[0]);
+}
+
+void FRedisAsyncEngine::SelectIndex(int32 InIndex)
+{
+	DbIndex.Set(InIndex);
+	bSelectPending = true;
+	Wakeup();
+}
+
+void FRedisAsyncEngine::Repoint(const FString& InHost, int32 InPort)
+{
+	{
+		FScopeLock ScopeLock(&RepointLock);
+		RepointHost = InHost;
+		RepointPort = InPort;
+	}
+	bRepointPending = true;
+	Wakeup();
+}
+
+uint32 FRedisAsyncEngine::Run()
+{
+	while (!bStopping)
+	{
+		ApplyPendingRepoint();
+
+		const double Now = FPlatformTime::Seconds();
+		for (auto& Connection : Connections)
+		{
+			if (!Connection->Context && Now >= Connection->NextConnectTime)
+			{
+				Connect(*Connection);
+			}
+		}
+
+		ApplyPendingSelect();
+		DispatchPendingRequests();
+		PollOnce(RedisPollTimeoutMs);
+	}
+
+	bRunning = false;
+
+	// Freeing a context runs every outstanding callback with a null reply
+	for (auto& Connection : Connections)
+	{
+		if (Connection->Context)
+		{
+			redisAsyncFree(Connection->Context);
+			Connection->Context = nullptr;
+		}
+	}
+
+	FRedisAsyncRequest* Request = nullptr;
+	while (PendingRequests.Dequeue(Request))
+	{
+		while (Request)
+		{
+			FRedisAsyncRequest* Next = Request->NextInBatch;
+			CompleteRequest(Request, nullptr);
+			Request = Next;
+		}
+	}
+
+	return 0;
+}
+
+bool FRedisAsyncEngine::Connect(FRedisAsyncConnection& InConnection)
+{
+	FString SocketPath;
+	redisAsyncContext* Context = nullptr;
+	if (URedisClient::ParseUnixSocketHost(Host, SocketPath))
+	{
+#if PLATFORM_WINDOWS
+		// The Win64 hiredis build has no unix socket support
+		UE_LOG(LogTemp, Warning, TEXT("Redis unix:// hosts are not supported on Windows: %s"), *Host);
+#else
+		Context = redisAsyncConnectUnix(TCHAR_TO_UTF8(*SocketPath));
+#endif
+	}
+	else
+	{
+		Context = redisAsyncConnect(TCHAR_TO_ANSI(*Host), Port);
+	}
+	if (!Context || Context->err)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Async connect redis failed. error = %d"), Context ? Context->err : 0);
+		if (Context)
+		{
+			redisAsyncFree(Context);
+		}
+		InConnection.NextConnectTime = FPlatformTime::Seconds() + RedisReconnectDelay;
+		return false;
+	}
+
+	InConnection.Context = Context;
+	InConnection.bConnected = false;
+	InConnection.Outstanding = 0;
+
+	Context->data = &InConnection;
+	Context->ev.data = &InConnection;
+	Context->ev.addRead = RedisAddRead;
+	Context->ev.delRead = RedisDelRead;
+	Context->ev.addWrite = RedisAddWrite;
+	Context->ev.delWrite = RedisDelWrite;
+	Context->ev.cleanup = RedisCleanup;
+
+	redisAsyncSetConnectCallback(Context, OnRedisAsyncConnect);
+	redisAsyncSetDisconnectCallback(Context, OnRedisAsyncDisconnect);
+
+	// Queued ahead of any request, so they are the first commands on the wire
+	FRedisCommandArgs SetupArgs;
+	if (!Password.IsEmpty())
+	{
+		SetupArgs.Reset().Add("AUTH").Add(Password);
+		redisAsyncCommandArgv(Context, OnRedisSetupReply, nullptr, SetupArgs.Num(), SetupArgs.GetArgv(), SetupArgs.GetArgvLen());
+	}
+	if (DbIndex.GetValue() != 0)
+	{
+		SetupArgs.Reset().Add("SELECT").Add(DbIndex.GetValue());
+		redisAsyncCommandArgv(Context, OnRedisSetupReply, nullptr, SetupArgs.Num(), SetupArgs.GetArgv(), SetupArgs.GetArgvLen());
+	}
+
+	return true;
+}
+
+FRedisAsyncConnection* FRedisAsyncEngine::PickConnection() const
+{
+	// Least outstanding requests, preferring connections that finished connecting
+	FRedisAsyncConnection* Best = nullptr;
+	for (auto& Connection : Connections)
+	{
+		if (!Connection->Context)
+		{
+			continue;
+		}
+		if (!Best
+			|| (Connection->bConnected && !Best->bConnected)
+			|| (Connection->bConnected == Best->bConnected && Connection->Outstanding < Best->Outstanding))
+		{
+			Best = Connection.Get();
+		}
+	}
+	return Best;
+}
+
+void FRedisAsyncEngine::Dispatch(FRedisAsyncConnection* InConnection, FRedisAsyncRequest* InRequest)
+{
+	if (!InConnection || !InConnection->Context)
+	{
+		CompleteRequest(InRequest, nullptr);
+		return;
+	}
+
+	FRedisCommandArgs& Args = InRequest->Args;
+	InRequest->WriteCycles = FPlatformTime::Cycles64();
+	if (redisAsyncCommandArgv(InConnection->Context, OnRedisRequestReply, InRequest, Args.Num(), Args.GetArgv(), Args.GetArgvLen()) != REDIS_OK)
+	{
+		CompleteRequest(InRequest, nullptr);
+		return;
+	}
+	InRequest->TraceId = FRedisStats::BeginCommand(Args);
+	++InConnection->Outstanding;
+}
+
+void FRedisAsyncEngine::DispatchPendingRequests()
+{
+	FRedisAsyncRequest* Request = nullptr;
+	while (PendingRequests.Dequeue(Request))
+	{
+		FRedisAsyncConnection* Connection = PickConnection();
+		while (Request)
+		{
+			FRedisAsyncRequest* Next = Request->NextInBatch;
+			Request->NextInBatch = nullptr;
+			Dispatch(Connection, Request);
+			Request = Next;
+		}
+	}
+}
+
+void FRedisAsyncEngine::ApplyPendingSelect()
+{
+	if (!bSelectPending.AtomicSet(false))
+	{
+		return;
+	}
+
+	FRedisCommandArgs SelectArgs;
+	SelectArgs.Add("SELECT").Add(DbIndex.GetValue());
+	for (auto& Connection : Connections)
+	{
+		if (Connection->Context)
+		{
+			redisAsyncCommandArgv(Connection->Context, OnRedisSetupReply, nullptr, SelectArgs.Num(), SelectArgs.GetArgv(), SelectArgs.GetArgvLen());
+		}
+	}
+}
+
+void FRedisAsyncEngine::ApplyPendingRepoint()
+{
+	if (!bRepointPending.AtomicSet(false))
+	{
+		return;
+	}
+
+	{
+		FScopeLock ScopeLock(&RepointLock);
+		Host = RepointHost;
+		Port = RepointPort;
+	}
+
+	// The old server is likely gone: fail what is in flight now instead of waiting for a timeout
+	for (auto& Connection : Connections)
+	{
+		if (Connection->Context)
+		{
+			redisAsyncFree(Connection->Context);
+			Connection->Context = nullptr;
+		}
+		Connection->bConnected = false;
+		Connection->NextConnectTime = 0.0;
+	}
+}
+
+void FRedisAsyncEngine::PollOnce(int32 TimeoutMs)
+{
+	TArray<pollfd, TInlineAllocator<8>> PollFds;
+	TArray<FRedisAsyncConnection*, TInlineAllocator<8>> PollConnections;
+
+	pollfd& WakeupFd = PollFds.AddZeroed_GetRef();
+	WakeupFd.fd = (FRedisSocket)WakeupSocket;
+	WakeupFd.events = POLLIN;
+
+	for (auto& Connection : Connections)
+	{
+		if (Connection->Context && (Connection->bReading || Connection->bWriting))
+		{
+			pollfd& Fd = PollFds.AddZeroed_GetRef();
+			Fd.fd = (FRedisSocket)Connection->Context->c.fd;
+			Fd.events = (Connection->bReading ? POLLIN : 0) | (Connection->bWriting ? POLLOUT : 0);
+			PollConnections.Add(Connection.Get());
+		}
+	}
+
+	if (RedisPoll(PollFds.GetData(), PollFds.Num(), TimeoutMs) <= 0)
+	{
+		return;
+	}
+
+	if (PollFds[0].revents & POLLIN)
+	{
+		char Drain[64];
+		while (recv((FRedisSocket)WakeupSocket, Drain, sizeof(Drain), 0) > 0)
+		{
+		}
+		bWakeupPending = false;
+	}
+
+	for (int32 i = 1; i < PollFds.Num(); ++i)
+	{
+		const int32 Events = PollFds[i].revents;
+		FRedisAsyncConnection* Connection = PollConnections[i - 1];
+
+		// Each handler may drop the connection, which clears Context
+		if ((Events & (POLLIN | POLLERR | POLLHUP)) && Connection->Context && Connection->bReading)
+		{
+			redisAsyncHandleRead(Connection->Context);
+		}
+		if ((Events & (POLLOUT | POLLERR | POLLHUP)) && Connection->Context && Connection->bWriting)
+		{
+			redisAsyncHandleWrite(Connection->Context);
+		}
+	}
+}
+
+void FRedisAsyncEngine::CompleteRequest(FRedisAsyncRequest* InRequest, redisReply* InReply)
+{
+	if (InRequest->OnReply)
+	{
+		InRequest->OnReply(InReply);
+	}
+	delete InRequest;
+}
+
+bool FRedisAsyncEngine::CreateWakeupSocket()
+{
+	if ((FRedisSocket)WakeupSocket != REDIS_INVALID_SOCKET)
+	{
+		return true;
+	}
+
+	FRedisSocket Socket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (Socket == REDIS_INVALID_SOCKET)
+	{
+		return false;
+	}
+
+	// Bind to an ephemeral loopback port and connect the socket to itself
+	sockaddr_in Addr;
+	FMemory::Memzero(Addr);
+	Addr.sin_family = AF_INET;
+	Addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	Addr.sin_port = 0;
+	FRedisSockLen AddrLen = sizeof(Addr);
+
+	if (bind(Socket, (sockaddr*)&Addr, sizeof(Addr)) != 0
+		|| getsockname(Socket, (sockaddr*)&Addr, &AddrLen) != 0
+		|| connect(Socket, (sockaddr*)&Addr, AddrLen) != 0)
+	{
+		RedisCloseSocket(Socket);
+		return false;
+	}
+
+#if PLATFORM_WINDOWS
+	u_long NonBlocking = 1;
+	ioctlsocket(Socket, FIONBIO, &NonBlocking);
+#else
+	fcntl(Socket, F_SETFL, fcntl(Socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+	WakeupSocket = (uint64)Socket;
+	return true;
+}
+
+void FRedisAsyncEngine::CloseWakeupSocket()
+{
+	if ((FRedisSocket)WakeupSocket != REDIS_INVALID_SOCKET)
+	{
+		RedisCloseSocket((FRedisSocket)WakeupSocket);
+		WakeupSocket = (uint64)REDIS_INVALID_SOCKET;
+	}
+}
+
+void FRedisAsyncEngine::Wakeup()
+{
+	if ((FRedisSocket)WakeupSocket != REDIS_INVALID_SOCKET)
+	{
+		const char Byte = 1;
+		send((FRedisSocket)WakeupSocket, &Byte, 1, 0);
+	}
+}
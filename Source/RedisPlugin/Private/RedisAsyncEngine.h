@@ -0,0 +1,136 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/Queue.h"
+#include "RedisCommandArgs.h"
+
+struct redisReply;
+struct FRedisAsyncConnection;
+class FRunnableThread;
+
+/** One command handed to FRedisAsyncEngine. */
+struct FRedisAsyncRequest
+{
+	FRedisAsyncRequest() :
+		NextInBatch(nullptr),
+		SubmitCycles(0),
+		WriteCycles(0),
+		TraceId(0)
+	{	}
+
+	/** Encoded on the submitting thread. */
+	FRedisCommandArgs Args;
+
+	/**
+	 * Runs on the I/O thread. Reply is null when the connection dropped before the reply arrived.
+	 * The reply is freed by hiredis once this returns, so copy out what you need.
+	 */
+	TFunction<void(redisReply*)> OnReply;
+
+	/** Requests linked here are written back to back on the same connection. */
+	FRedisAsyncRequest* NextInBatch;
+
+	/** When Submit queued it and when it was written out, for FRedisLatency. */
+	uint64 SubmitCycles;
+	uint64 WriteCycles;
+
+	/** From FRedisStats::BeginCommand once written. */
+	uint64 TraceId;
+};
+
+/**
+ * Event-driven command engine on top of hiredis' redisAsyncContext.
+ * A single I/O thread polls a small set of non-blocking connections and multiplexes any
+ * number of in-flight commands over them, so async throughput is bound by the network
+ * instead of by thread-pool width. Requests can be submitted from any thread.
+ */
+class FRedisAsyncEngine : public FRunnable
+{
+public:
+
+	FRedisAsyncEngine();
+	virtual ~FRedisAsyncEngine();
+
+	bool Start(const FString& InHost, int32 InPort, const FString& InPassword, int32 InConnectionNum);
+
+	/** Stops the I/O thread. Requests still in flight complete with a null reply. */
+	void Shutdown();
+
+	bool IsRunning() const
+	{
+		return bRunning;
+	}
+
+	/** Takes ownership of the request (and of anything linked through NextInBatch). */
+	void Submit(FRedisAsyncRequest* InRequest);
+
+	/** Takes ownership of the requests and writes them back to back on one connection. */
+	void SubmitBatch(const TArray<FRedisAsyncRequest*>& InRequests);
+
+	void SelectIndex(int32 InIndex);
+
+	/**
+	 * Moves every connection to a new server, e.g. after a failover. Requests in flight on the
+	 * old one complete with a null reply; new ones queue until the new connections are up.
+	 */
+	void Repoint(const FString& InHost, int32 InPort);
+
+	/* FRunnable */
+	virtual uint32 Run() override;
+
+	virtual void Stop() override;
+
+private:
+
+	bool CreateWakeupSocket();
+
+	void CloseWakeupSocket();
+
+	void Wakeup();
+
+	bool Connect(FRedisAsyncConnection& InConnection);
+
+	FRedisAsyncConnection* PickConnection() const;
+
+	void Dispatch(FRedisAsyncConnection* InConnection, FRedisAsyncRequest* InRequest);
+
+	void DispatchPendingRequests();
+
+	void ApplyPendingSelect();
+
+	void ApplyPendingRepoint();
+
+	void PollOnce(int32 TimeoutMs);
+
+	static void CompleteRequest(FRedisAsyncRequest* InRequest, redisReply* InReply);
+
+private:
+	FString		Host;
+	int32		Port;
+	FString		Password;
+
+	TArray<TUniquePtr<FRedisAsyncConnection>>	Connections;
+
+	TQueue<FRedisAsyncRequest*, EQueueMode::Mpsc>	PendingRequests;
+
+	FRunnableThread*	Thread;
+	FThreadSafeBool		bRunning;
+	FThreadSafeBool		bStopping;
+	FThreadSafeBool		bWakeupPending;
+	FThreadSafeBool		bSelectPending;
+	FThreadSafeBool		bRepointPending;
+
+	/** Address handed over by Repoint; Host and Port themselves are only touched by the I/O thread once running. */
+	FCriticalSection	RepointLock;
+	FString				RepointHost;
+	int32				RepointPort;
+	FThreadSafeCounter	DbIndex;
+
+	/** Loopback UDP socket polled alongside the connections so Submit can interrupt poll(). */
+	uint64				WakeupSocket;
+};
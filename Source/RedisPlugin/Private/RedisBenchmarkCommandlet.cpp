@@ -0,0 +1,877 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisBenchmarkCommandlet.h"
+#include "RedisObject.h"
+#include "RedisClient.h"
+#include "RedisCompression.h"
+#include "RedisCommandArgs.h"
+#include "RedisPipeline.h"
+#include "RedisTransaction.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+#include <sstream>
+
+struct FRedisBenchmarkParams
+{
+	FString		Params;
+	FString		Host;
+	int32		Port;
+	FString		Password;
+	/** 0 until given with -Iterations=; each suite then picks its own default. */
+	int32		Iterations;
+};
+
+/** Percentiles in milliseconds of InSeconds, which gets sorted. */
+static void GetPercentilesMs(TArray<double>& InSeconds, double& OutP50, double& OutP99)
+{
+	OutP50 = 0.0;
+	OutP99 = 0.0;
+	if (InSeconds.Num() == 0)
+	{
+		return;
+	}
+	InSeconds.Sort();
+	OutP50 = InSeconds[(InSeconds.Num() - 1) / 2] * 1000.0;
+	OutP99 = InSeconds[FMath::Min(InSeconds.Num() - 1, FMath::CeilToInt(InSeconds.Num() * 0.99) - 1)] * 1000.0;
+}
+
+/** Comma separated integers of InName=, or InDefault when it is not given. */
+static TArray<int32> ParseIntList(const FString& InParams, const TCHAR* InName, const TArray<int32>& InDefault)
+{
+	TArray<int32> Values;
+	FString List;
+	if (FParse::Value(*InParams, InName, List, false))
+	{
+		TArray<FString> Items;
+		List.ParseIntoArray(Items, TEXT(","));
+		for (const FString& it : Items)
+		{
+			Values.Add(FCString::Atoi(*it));
+		}
+	}
+	return Values.Num() ? Values : InDefault;
+}
+
+/** Player-state shaped JSON of about InSize characters: repeated keys, small numbers, a few words. */
+static FString MakeJsonPayload(int32 InSize, FRandomStream& InRandom)
+{
+	static const TCHAR* Words[] = { TEXT("sword"), TEXT("shield"), TEXT("potion"), TEXT("scroll"), TEXT("helmet"), TEXT("boots"), TEXT("ring"), TEXT("amulet") };
+
+	FString Json = TEXT("{\"items\":[");
+	Json.Reserve(InSize + 256);
+	while (Json.Len() < InSize)
+	{
+		Json += FString::Printf(TEXT("{\"id\":%d,\"name\":\"%s_%d\",\"level\":%d,\"durability\":%.2f,\"tags\":[\"%s\",\"%s\"]},"),
+			InRandom.RandRange(0, 1000000),
+			Words[InRandom.RandRange(0, UE_ARRAY_COUNT(Words) - 1)], InRandom.RandRange(0, 99),
+			InRandom.RandRange(1, 60),
+			InRandom.FRandRange(0.f, 100.f),
+			Words[InRandom.RandRange(0, UE_ARRAY_COUNT(Words) - 1)], Words[InRandom.RandRange(0, UE_ARRAY_COUNT(Words) - 1)]);
+	}
+	Json += TEXT("{}]}");
+	return Json;
+}
+
+/** A URedisObject connected to the benchmark server, or null when nothing answers there. */
+static URedisObject* ConnectRedisObject(const FRedisBenchmarkParams& InParams)
+{
+	// Probed first: Init does not report failure
+	URedisClient Probe;
+	if (!Probe.ConnectToRedis(InParams.Host, InParams.Port, InParams.Password))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("RedisBenchmark found no server at %s:%d, round trips are left out"), *InParams.Host, InParams.Port);
+		return nullptr;
+	}
+
+	URedisObject* RedisObject = NewObject<URedisObject>(GetTransientPackage());
+	RedisObject->AddToRoot();
+	RedisObject->Init(InParams.Host, InParams.Port, InParams.Password);
+	return RedisObject;
+}
+
+static void ReleaseRedisObject(URedisObject* InRedisObject)
+{
+	if (InRedisObject)
+	{
+		InRedisObject->RemoveFromRoot();
+		InRedisObject->ConditionalBeginDestroy();
+	}
+}
+
+static int32 RunCompressionBenchmark(const FRedisBenchmarkParams& InParams)
+{
+	const TArray<int32> Sizes = ParseIntList(InParams.Params, TEXT("Sizes="), { 4096, 65536, 524288 });
+	const int32 Iterations = InParams.Iterations > 0 ? InParams.Iterations : 50;
+	const ERedisCompression Codecs[] = { ERedisCompression::None, ERedisCompression::LZ4, ERedisCompression::Zlib, ERedisCompression::Gzip, ERedisCompression::Oodle };
+	const FString Key = TEXT("redisbenchmark:compression");
+
+	URedisObject* RedisObject = ConnectRedisObject(InParams);
+	FRandomStream Random(1234);
+	int32 Result = 0;
+
+	UE_LOG(LogTemp, Display, TEXT("RedisBenchmark Compression, %d iterations"), Iterations);
+	UE_LOG(LogTemp, Display, TEXT("%-8s %10s %10s %8s %12s %12s %12s %12s"), TEXT("Codec"), TEXT("Raw"), TEXT("Stored"), TEXT("Ratio"), TEXT("CompressUs"), TEXT("DecompressUs"), TEXT("SetGetP50Ms"), TEXT("SetGetP99Ms"));
+	for (int32 Size : Sizes)
+	{
+		const FString Payload = MakeJsonPayload(Size, Random);
+		const int32 RawSize = FTCHARToUTF8(*Payload).Length();
+
+		for (ERedisCompression Codec : Codecs)
+		{
+			const FString CodecName = StaticEnum<ERedisCompression>()->GetNameStringByValue((int64)Codec);
+
+			TArray<uint8> Compressed;
+			bool bCompressed = false;
+			double CompressSeconds = 0.0;
+			for (int32 i = 0; i < Iterations; ++i)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				bCompressed = FRedisCompression::Compress(Codec, 0, Payload, Compressed);
+				CompressSeconds += FPlatformTime::Seconds() - StartTime;
+			}
+			if (Codec != ERedisCompression::None && !bCompressed)
+			{
+				UE_LOG(LogTemp, Display, TEXT("%-8s %10d    unavailable or not smaller"), *CodecName, RawSize);
+				continue;
+			}
+
+			double DecompressSeconds = 0.0;
+			if (bCompressed)
+			{
+				FString Decompressed;
+				for (int32 i = 0; i < Iterations; ++i)
+				{
+					const double StartTime = FPlatformTime::Seconds();
+					FRedisCompression::ToString((const char*)Compressed.GetData(), Compressed.Num(), Decompressed);
+					DecompressSeconds += FPlatformTime::Seconds() - StartTime;
+				}
+				if (Decompressed != Payload)
+				{
+					UE_LOG(LogTemp, Error, TEXT("RedisBenchmark %s did not round-trip a %d byte value"), *CodecName, RawSize);
+					Result = 1;
+				}
+			}
+			else
+			{
+				CompressSeconds = 0.0;
+			}
+
+			// What SetStr/GetStr cost end to end with this codec, compression and transfer together
+			TArray<double> RoundTrips;
+			if (RedisObject)
+			{
+				RedisObject->Compression = Codec;
+				RedisObject->CompressionThreshold = 0;
+				FString Read;
+				for (int32 i = 0; i < Iterations; ++i)
+				{
+					const double StartTime = FPlatformTime::Seconds();
+					if (!RedisObject->SetStr(Key, Payload) || !RedisObject->GetStr(Key, Read))
+					{
+						UE_LOG(LogTemp, Error, TEXT("RedisBenchmark SetStr/GetStr failed with %s"), *CodecName);
+						Result = 1;
+						break;
+					}
+					RoundTrips.Add(FPlatformTime::Seconds() - StartTime);
+				}
+			}
+			double P50 = 0.0;
+			double P99 = 0.0;
+			GetPercentilesMs(RoundTrips, P50, P99);
+
+			const int32 StoredSize = bCompressed ? Compressed.Num() : RawSize;
+			UE_LOG(LogTemp, Display, TEXT("%-8s %10d %10d %8.2f %12.1f %12.1f %12.3f %12.3f"), *CodecName, RawSize, StoredSize, (double)RawSize / StoredSize,
+				CompressSeconds * 1000000.0 / Iterations, DecompressSeconds * 1000000.0 / Iterations, P50, P99);
+		}
+	}
+
+	if (RedisObject)
+	{
+		RedisObject->DelKey(Key);
+	}
+	ReleaseRedisObject(RedisObject);
+	return Result;
+}
+
+/** One command on its own connection to 127.0.0.1:InPort; false if it could not run or the server answered an error. */
+static bool QueryLocalRedis(int32 InPort, const TArray<FString>& InCommand, FRedisReply& OutReply)
+{
+	URedisClient RedisClient;
+	if (!RedisClient.ConnectToRedis(TEXT("127.0.0.1"), InPort, FString(), 0.2f))
+	{
+		return false;
+	}
+	FRedisPipeline Pipeline;
+	Pipeline.Command(InCommand);
+	TArray<FRedisReply> Replies;
+	if (!RedisClient.ExecPipeline(Pipeline, Replies) || Replies.Num() != 1 || Replies[0].IsError())
+	{
+		return false;
+	}
+	OutReply = Replies[0];
+	return true;
+}
+
+/** Polls InCondition every 100ms for up to InTimeout seconds. */
+static bool WaitUntil(float InTimeout, TFunctionRef<bool()> InCondition)
+{
+	const double EndTime = FPlatformTime::Seconds() + InTimeout;
+	while (!InCondition())
+	{
+		if (FPlatformTime::Seconds() > EndTime)
+		{
+			return false;
+		}
+		FPlatformProcess::Sleep(0.1f);
+	}
+	return true;
+}
+
+/** Starts InExe with the config file InConfig, both under InDir. */
+static FProcHandle LaunchRedis(const FString& InExe, const FString& InDir, const FString& InConfig, const FString& InContent, const TCHAR* InExtraArgs)
+{
+	const FString ConfigPath = FPaths::ConvertRelativePathToFull(InDir / InConfig);
+	if (!FFileHelper::SaveStringToFile(InContent, *ConfigPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark could not write %s"), *ConfigPath);
+		return FProcHandle();
+	}
+	const FString Args = FString::Printf(TEXT("\"%s\"%s"), *ConfigPath, InExtraArgs);
+	return FPlatformProcess::CreateProc(*InExe, *Args, false, true, true, nullptr, 0, *InDir, nullptr);
+}
+
+static void StopRedis(FProcHandle& InProc)
+{
+	if (InProc.IsValid())
+	{
+		FPlatformProcess::TerminateProc(InProc, true);
+		FPlatformProcess::WaitForProc(InProc);
+		FPlatformProcess::CloseProc(InProc);
+	}
+}
+
+static int32 RunFailover(const FRedisBenchmarkParams& InParams, const FString& InRedisServer, int32 InPrimaryPort, int32 InReplicaPort, int32 InSentinelPort, FProcHandle (&InOutProcs)[3])
+{
+	const FString MasterName = TEXT("bench");
+	const FString Dir = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("RedisBenchmark") / TEXT("Failover"));
+	IFileManager::Get().MakeDirectory(*Dir, true);
+
+	const FString ServerConfig = TEXT("save \"\"\nappendonly no\nbind 127.0.0.1\n");
+	InOutProcs[0] = LaunchRedis(InRedisServer, Dir, TEXT("primary.conf"), ServerConfig + FString::Printf(TEXT("port %d\ndbfilename primary.rdb\n"), InPrimaryPort), TEXT(""));
+	InOutProcs[1] = LaunchRedis(InRedisServer, Dir, TEXT("replica.conf"), ServerConfig + FString::Printf(TEXT("port %d\ndbfilename replica.rdb\nreplicaof 127.0.0.1 %d\n"), InReplicaPort, InPrimaryPort), TEXT(""));
+	// Rewritten by the sentinel as it learns the topology, so written fresh every run
+	InOutProcs[2] = LaunchRedis(InRedisServer, Dir, TEXT("sentinel.conf"), FString::Printf(TEXT("port %d\nbind 127.0.0.1\nsentinel monitor %s 127.0.0.1 %d 1\nsentinel down-after-milliseconds %s 1000\nsentinel failover-timeout %s 5000\n"),
+		InSentinelPort, *MasterName, InPrimaryPort, *MasterName, *MasterName), TEXT(" --sentinel"));
+	if (!InOutProcs[0].IsValid() || !InOutProcs[1].IsValid() || !InOutProcs[2].IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark could not start %s"), *InRedisServer);
+		return 1;
+	}
+
+	FRedisReply Reply;
+	const bool bReplicaUp = WaitUntil(10.f, [&]()
+	{
+		return QueryLocalRedis(InReplicaPort, { TEXT("INFO"), TEXT("replication") }, Reply) && Reply.Str.Contains(TEXT("master_link_status:up"));
+	});
+	// SENTINEL MASTER answers a flat field/value list
+	const bool bSentinelReady = bReplicaUp && WaitUntil(30.f, [&]()
+	{
+		if (!QueryLocalRedis(InSentinelPort, { TEXT("SENTINEL"), TEXT("MASTER"), MasterName }, Reply))
+		{
+			return false;
+		}
+		const int32 Index = Reply.Elements.IndexOfByKey(TEXT("num-slaves"));
+		return Index != INDEX_NONE && Index + 1 < Reply.Elements.Num() && FCString::Atoi(*Reply.Elements[Index + 1]) > 0;
+	});
+	if (!bSentinelReady)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Failover: the replica or the sentinel did not come up"));
+		return 1;
+	}
+
+	URedisObject* RedisObject = NewObject<URedisObject>(GetTransientPackage());
+	RedisObject->AddToRoot();
+	RedisObject->SentinelHosts = { FString::Printf(TEXT("127.0.0.1:%d"), InSentinelPort) };
+	RedisObject->SentinelMasterName = MasterName;
+	RedisObject->Init(TEXT("127.0.0.1"), InPrimaryPort, FString());
+
+	const FString Key = TEXT("redisbenchmark:failover");
+	int32 Switches = 0;
+	double RepointSeconds = 0.0;
+	if (!RedisObject->SetStr(Key, TEXT("before")) || !RedisObject->GetSentinelSwitches(Switches, RepointSeconds))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Failover: no write to the primary, or no sentinel running"));
+		ReleaseRedisObject(RedisObject);
+		return 1;
+	}
+
+	const bool bKill = FParse::Param(*InParams.Params, TEXT("Kill"));
+	const double TriggerTime = FPlatformTime::Seconds();
+	if (bKill)
+	{
+		StopRedis(InOutProcs[0]);
+	}
+	else if (!QueryLocalRedis(InSentinelPort, { TEXT("SENTINEL"), TEXT("FAILOVER"), MasterName }, Reply))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Failover: SENTINEL FAILOVER was refused"));
+		ReleaseRedisObject(RedisObject);
+		return 1;
+	}
+
+	// Ticked the way the game thread would while the sentinel thread repoints everything
+	const float FrameTime = 1.f / 60.f;
+	TArray<double> TickSeconds;
+	double SwitchTime = 0.0;
+	double LastTickTime = FPlatformTime::Seconds();
+	while (FPlatformTime::Seconds() - TriggerTime < 30.0)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		RedisObject->Tick((float)(StartTime - LastTickTime));
+		LastTickTime = FPlatformTime::Seconds();
+		TickSeconds.Add(LastTickTime - StartTime);
+
+		int32 NewSwitches = 0;
+		RedisObject->GetSentinelSwitches(NewSwitches, RepointSeconds);
+		if (NewSwitches > Switches)
+		{
+			SwitchTime = LastTickTime;
+			break;
+		}
+		FPlatformProcess::Sleep(FMath::Max(0.f, FrameTime - (float)(LastTickTime - StartTime)));
+	}
+	if (SwitchTime == 0.0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Failover: no primary change within 30s"));
+		ReleaseRedisObject(RedisObject);
+		return 1;
+	}
+
+	// Retried until the new primary has finished promoting itself
+	const bool bWritten = WaitUntil(10.f, [&]() { return RedisObject->SetStr(Key, TEXT("after")); });
+	const double WriteTime = FPlatformTime::Seconds();
+
+	const double MaxTickSeconds = FMath::Max(TickSeconds);
+	double P50 = 0.0;
+	double P99 = 0.0;
+	GetPercentilesMs(TickSeconds, P50, P99);
+
+	UE_LOG(LogTemp, Display, TEXT("RedisBenchmark Failover (%s)"), bKill ? TEXT("primary killed") : TEXT("SENTINEL FAILOVER"));
+	UE_LOG(LogTemp, Display, TEXT("  primary change seen after   %10.1f ms"), (SwitchTime - TriggerTime) * 1000.0);
+	UE_LOG(LogTemp, Display, TEXT("  OnSwitchMaster repoint      %10.3f ms"), RepointSeconds * 1000.0);
+	UE_LOG(LogTemp, Display, TEXT("  first write after           %10.1f ms%s"), (WriteTime - TriggerTime) * 1000.0, bWritten ? TEXT("") : TEXT(" (failed)"));
+	UE_LOG(LogTemp, Display, TEXT("  Tick p50 / p99 / max        %10.3f / %.3f / %.3f ms over %d ticks"), P50, P99, MaxTickSeconds * 1000.0, TickSeconds.Num());
+
+	int32 Result = bWritten ? 0 : 1;
+	float MaxStallMs = 0.f;
+	FParse::Value(*InParams.Params, TEXT("MaxStallMs="), MaxStallMs);
+	if (MaxStallMs > 0.f && MaxTickSeconds * 1000.0 > MaxStallMs)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Failover: a Tick took %.3f ms, over -MaxStallMs=%.1f"), MaxTickSeconds * 1000.0, MaxStallMs);
+		Result = 1;
+	}
+
+	RedisObject->DelKey(Key);
+	ReleaseRedisObject(RedisObject);
+	return Result;
+}
+
+static int32 RunFailoverBenchmark(const FRedisBenchmarkParams& InParams)
+{
+	FString RedisServer;
+	if (!FParse::Value(*InParams.Params, TEXT("RedisServer="), RedisServer) || !FPaths::FileExists(RedisServer))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Failover needs -RedisServer=<path to redis-server>"));
+		return 1;
+	}
+
+	int32 BasePort = 17000;
+	FParse::Value(*InParams.Params, TEXT("BasePort="), BasePort);
+
+	// Primary, replica, sentinel; always stopped, whatever the run ended with
+	FProcHandle Procs[3];
+	const int32 Result = RunFailover(InParams, RedisServer, BasePort, BasePort + 1, BasePort + 2, Procs);
+	for (FProcHandle& it : Procs)
+	{
+		StopRedis(it);
+	}
+	return Result;
+}
+
+/** Sequential SET, GET and HGETALL round trips, then pipelined SET + GET, on one connection. */
+static bool MeasureTransport(const TCHAR* InName, URedisClient& InRedisClient, int32 InIterations, int32 InBatch, const FString& InValue)
+{
+	const FString Key = TEXT("redisbenchmark:transport");
+	const FString HashKey = TEXT("redisbenchmark:transport:hash");
+	TMap<FString, FString> Fields;
+	for (int32 i = 0; i < 16; ++i)
+	{
+		Fields.Add(FString::Printf(TEXT("field%d"), i), InValue);
+	}
+	if (!InRedisClient.HMSet(HashKey, Fields))
+	{
+		return false;
+	}
+
+	TArray<double> SetSeconds;
+	TArray<double> GetSeconds;
+	TArray<double> HGetAllSeconds;
+	FString Read;
+	TMap<FString, FString> ReadFields;
+	for (int32 i = 0; i < InIterations; ++i)
+	{
+		double StartTime = FPlatformTime::Seconds();
+		if (!InRedisClient.SetStr(Key, InValue))
+		{
+			return false;
+		}
+		SetSeconds.Add(FPlatformTime::Seconds() - StartTime);
+
+		StartTime = FPlatformTime::Seconds();
+		if (!InRedisClient.GetStr(Key, Read))
+		{
+			return false;
+		}
+		GetSeconds.Add(FPlatformTime::Seconds() - StartTime);
+
+		ReadFields.Reset();
+		StartTime = FPlatformTime::Seconds();
+		if (!InRedisClient.HGetAll(HashKey, ReadFields))
+		{
+			return false;
+		}
+		HGetAllSeconds.Add(FPlatformTime::Seconds() - StartTime);
+	}
+
+	FRedisPipeline Pipeline;
+	const int32 Pairs = FMath::Max(1, InBatch / 2);
+	for (int32 i = 0; i < Pairs; ++i)
+	{
+		Pipeline.SetStr(Key, InValue).GetStr(Key);
+	}
+	TArray<FRedisReply> Replies;
+	const int32 Rounds = FMath::Max(1, InIterations / 10);
+	const double PipelineStart = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Rounds; ++i)
+	{
+		Replies.Reset();
+		if (!InRedisClient.ExecPipeline(Pipeline, Replies))
+		{
+			return false;
+		}
+	}
+	const double PipelineSeconds = FPlatformTime::Seconds() - PipelineStart;
+
+	double SetP50, SetP99, GetP50, GetP99, HGetAllP50, HGetAllP99;
+	GetPercentilesMs(SetSeconds, SetP50, SetP99);
+	GetPercentilesMs(GetSeconds, GetP50, GetP99);
+	GetPercentilesMs(HGetAllSeconds, HGetAllP50, HGetAllP99);
+	UE_LOG(LogTemp, Display, TEXT("%-6s %9.3f %9.3f %9.3f %9.3f %11.3f %11.3f %14.0f"), InName, SetP50, SetP99, GetP50, GetP99, HGetAllP50, HGetAllP99,
+		Pairs * 2.0 * Rounds / FMath::Max(PipelineSeconds, 1e-9));
+
+	InRedisClient.DelKey(Key);
+	InRedisClient.DelKey(HashKey);
+	return true;
+}
+
+static int32 RunTransportBenchmark(const FRedisBenchmarkParams& InParams)
+{
+	const int32 Iterations = InParams.Iterations > 0 ? InParams.Iterations : 10000;
+	int32 ValueSize = 64;
+	int32 Batch = 100;
+	FString Socket;
+	FParse::Value(*InParams.Params, TEXT("ValueSize="), ValueSize);
+	FParse::Value(*InParams.Params, TEXT("Batch="), Batch);
+	FParse::Value(*InParams.Params, TEXT("Socket="), Socket);
+	const FString Value = FString::ChrN(FMath::Max(1, ValueSize), TEXT('x'));
+
+	UE_LOG(LogTemp, Display, TEXT("RedisBenchmark Transport, %d iterations, %d character values, pipelines of %d"), Iterations, ValueSize, Batch);
+	UE_LOG(LogTemp, Display, TEXT("%-6s %9s %9s %9s %9s %11s %11s %14s"), TEXT("Link"), TEXT("SetP50Ms"), TEXT("SetP99Ms"), TEXT("GetP50Ms"), TEXT("GetP99Ms"), TEXT("HGetAllP50"), TEXT("HGetAllP99"), TEXT("PipelinedOps/s"));
+
+	int32 Result = 0;
+	URedisClient TcpClient;
+	if (!TcpClient.ConnectToRedis(InParams.Host, InParams.Port, InParams.Password)
+		|| !MeasureTransport(TEXT("TCP"), TcpClient, Iterations, Batch, Value))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Transport failed over TCP to %s:%d"), *InParams.Host, InParams.Port);
+		Result = 1;
+	}
+
+	if (Socket.IsEmpty())
+	{
+		UE_LOG(LogTemp, Display, TEXT("RedisBenchmark Transport: no -Socket=, the unix socket run is left out"));
+		return Result;
+	}
+
+	// ConnectContext logs why when unix sockets are not supported on this platform
+	URedisClient UnixClient;
+	if (!UnixClient.ConnectToRedis(TEXT("unix://") + Socket, 0, InParams.Password)
+		|| !MeasureTransport(TEXT("UDS"), UnixClient, Iterations, Batch, Value))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Transport failed over the unix socket %s"), *Socket);
+		Result = 1;
+	}
+	return Result;
+}
+
+/**
+ * Passes everything on to the allocator it replaces, counting the allocations made by one thread.
+ * Only swapped into GMalloc around a measured loop.
+ */
+class FRedisCountingMalloc : public FMalloc
+{
+public:
+
+	explicit FRedisCountingMalloc(FMalloc* InInner) :
+		Inner(InInner),
+		ThreadId(FPlatformTLS::GetCurrentThreadId()),
+		Allocations(0)
+	{	}
+
+	virtual void* Malloc(SIZE_T InCount, uint32 InAlignment) override
+	{
+		CountAllocation();
+		return Inner->Malloc(InCount, InAlignment);
+	}
+
+	virtual void* Realloc(void* InOriginal, SIZE_T InCount, uint32 InAlignment) override
+	{
+		if (InCount)
+		{
+			CountAllocation();
+		}
+		return Inner->Realloc(InOriginal, InCount, InAlignment);
+	}
+
+	virtual void Free(void* InOriginal) override
+	{
+		Inner->Free(InOriginal);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T InCount, uint32 InAlignment) override
+	{
+		return Inner->QuantizeSize(InCount, InAlignment);
+	}
+
+	virtual bool GetAllocationSize(void* InOriginal, SIZE_T& OutSize) override
+	{
+		return Inner->GetAllocationSize(InOriginal, OutSize);
+	}
+
+	virtual void Trim(bool bTrimThreadCaches) override
+	{
+		Inner->Trim(bTrimThreadCaches);
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return Inner->IsInternallyThreadSafe();
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return Inner->GetDescriptiveName();
+	}
+
+	int64 GetAllocations() const
+	{
+		return Allocations;
+	}
+
+private:
+
+	void CountAllocation()
+	{
+		if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+		{
+			++Allocations;
+		}
+	}
+
+	FMalloc*	Inner;
+	uint32		ThreadId;
+	int64		Allocations;
+};
+
+/** Runs InCall InIterations times with GMalloc counting; returns microseconds and engine allocations per call. */
+static void MeasureCalls(int32 InIterations, TFunctionRef<void()> InCall, double& OutUs, double& OutAllocations)
+{
+	// Warmed up first, so reused buffers have already grown
+	InCall();
+
+	FMalloc* Inner = GMalloc;
+	FRedisCountingMalloc CountingMalloc(Inner);
+	GMalloc = &CountingMalloc;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < InIterations; ++i)
+	{
+		InCall();
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	GMalloc = Inner;
+
+	OutUs = Seconds * 1000000.0 / InIterations;
+	OutAllocations = (double)CountingMalloc.GetAllocations() / InIterations;
+}
+
+static int32 RunArgsBenchmark(const FRedisBenchmarkParams& InParams)
+{
+	const TArray<int32> Counts = ParseIntList(InParams.Params, TEXT("Counts="), { 1, 10, 1000 });
+	const int32 Iterations = InParams.Iterations > 0 ? InParams.Iterations : 10000;
+
+	UE_LOG(LogTemp, Display, TEXT("RedisBenchmark Args, %d iterations, MGET with N keys formatted into the RESP request"), Iterations);
+	UE_LOG(LogTemp, Display, TEXT("%-6s %12s %12s %12s %12s"), TEXT("N"), TEXT("LegacyUs"), TEXT("LegacyAllocs"), TEXT("ArgvUs"), TEXT("ArgvAllocs"));
+	for (int32 Count : Counts)
+	{
+		TArray<FString> Keys;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			Keys.Add(FString::Printf(TEXT("player:%d:inventory"), i));
+		}
+
+		// What MGet did before FRedisCommandArgs: one string through TCHAR_TO_ANSI, split again by hiredis
+		double LegacyUs = 0.0;
+		double LegacyAllocations = 0.0;
+		MeasureCalls(Iterations, [&Keys]()
+		{
+			std::ostringstream redisCmd;
+			redisCmd << "MGET";
+			for (const FString& it : Keys)
+			{
+				redisCmd << " " << TCHAR_TO_ANSI(*it);
+			}
+			char* Command = nullptr;
+			redisFormatCommand(&Command, redisCmd.str().c_str());
+			free(Command);
+		}, LegacyUs, LegacyAllocations);
+
+		// Kept across calls, as URedisClient keeps one per connection
+		FRedisCommandArgs Args;
+		double ArgvUs = 0.0;
+		double ArgvAllocations = 0.0;
+		MeasureCalls(Iterations, [&Keys, &Args]()
+		{
+			Args.Reset().Add("MGET");
+			for (const FString& it : Keys)
+			{
+				Args.Add(it);
+			}
+			char* Command = nullptr;
+			redisFormatCommandArgv(&Command, Args.Num(), Args.GetArgv(), Args.GetArgvLen());
+			free(Command);
+		}, ArgvUs, ArgvAllocations);
+
+		UE_LOG(LogTemp, Display, TEXT("%-6d %12.3f %12.1f %12.3f %12.1f"), Count, LegacyUs, LegacyAllocations, ArgvUs, ArgvAllocations);
+	}
+	return 0;
+}
+
+/** What one contending thread saw. */
+struct FRedisContenderStats
+{
+	TArray<double>	Seconds;
+	int32			Attempts = 0;
+	int32			Failures = 0;
+};
+
+/** InThreads threads each run InIncrement InIterations times at once; false if the key could not be reset. */
+static bool MeasureContention(URedisObject* InRedisObject, const FString& InKey, const FString& InField, int32 InThreads, int32 InIterations,
+	TFunctionRef<bool(FRedisContenderStats&)> InIncrement, TArray<FRedisContenderStats>& OutStats, double& OutSeconds, int64& OutFinalCount)
+{
+	if (!InRedisObject->HSet(InKey, InField, TEXT("0")))
+	{
+		return false;
+	}
+
+	OutStats.Reset();
+	OutStats.SetNum(InThreads);
+	const double StartTime = FPlatformTime::Seconds();
+	ParallelFor(InThreads, [&](int32 ThreadIndex)
+	{
+		FRedisContenderStats& Stats = OutStats[ThreadIndex];
+		Stats.Seconds.Reserve(InIterations);
+		for (int32 i = 0; i < InIterations; ++i)
+		{
+			const double CallStart = FPlatformTime::Seconds();
+			if (!InIncrement(Stats))
+			{
+				++Stats.Failures;
+			}
+			Stats.Seconds.Add(FPlatformTime::Seconds() - CallStart);
+		}
+	}, EParallelForFlags::Unbalanced);
+	OutSeconds = FPlatformTime::Seconds() - StartTime;
+
+	FString Count;
+	InRedisObject->HGet(InKey, InField, Count);
+	OutFinalCount = FCString::Atoi64(*Count);
+	return true;
+}
+
+static void LogContention(const TCHAR* InName, TArray<FRedisContenderStats>& InStats, double InSeconds, int64 InFinalCount, int64 InExpected)
+{
+	TArray<double> Seconds;
+	int32 Attempts = 0;
+	int32 Failures = 0;
+	for (FRedisContenderStats& it : InStats)
+	{
+		Seconds.Append(it.Seconds);
+		Attempts += it.Attempts;
+		Failures += it.Failures;
+	}
+	const int32 Calls = Seconds.Num();
+	double P50 = 0.0;
+	double P99 = 0.0;
+	GetPercentilesMs(Seconds, P50, P99);
+
+	// Retries only mean something for the transaction, where every attempt runs Build once
+	UE_LOG(LogTemp, Display, TEXT("%-11s %10.0f %9.3f %9.3f %10.2f %9d %12lld %12lld"), InName, Calls / FMath::Max(InSeconds, 1e-9), P50, P99,
+		Attempts > 0 ? (double)(Attempts - Calls) / FMath::Max(1, Calls) : 0.0, Failures, InExpected - InFinalCount, InFinalCount);
+}
+
+static int32 RunTransactionBenchmark(const FRedisBenchmarkParams& InParams)
+{
+	const int32 Iterations = InParams.Iterations > 0 ? InParams.Iterations : 1000;
+	int32 Threads = 8;
+	int32 MaxAttempts = 100;
+	FParse::Value(*InParams.Params, TEXT("Threads="), Threads);
+	FParse::Value(*InParams.Params, TEXT("MaxAttempts="), MaxAttempts);
+	Threads = FMath::Max(1, Threads);
+
+	URedisClient Probe;
+	if (!Probe.ConnectToRedis(InParams.Host, InParams.Port, InParams.Password))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Transaction found no server at %s:%d"), *InParams.Host, InParams.Port);
+		return 1;
+	}
+
+	URedisObject* RedisObject = NewObject<URedisObject>(GetTransientPackage());
+	RedisObject->AddToRoot();
+	// One pooled connection per contender, so they only wait on the key
+	RedisObject->MinPoolSize = Threads;
+	RedisObject->MaxPoolSize = FMath::Max(RedisObject->MaxPoolSize, Threads);
+	RedisObject->Init(InParams.Host, InParams.Port, InParams.Password);
+
+	const FString Key = TEXT("redisbenchmark:transaction");
+	const FString Field = TEXT("count");
+	const int64 Expected = (int64)Threads * Iterations;
+
+	UE_LOG(LogTemp, Display, TEXT("RedisBenchmark Transaction, %d threads x %d increments of one hash field"), Threads, Iterations);
+	UE_LOG(LogTemp, Display, TEXT("%-11s %10s %9s %9s %10s %9s %12s %12s"), TEXT("Method"), TEXT("Ops/s"), TEXT("P50Ms"), TEXT("P99Ms"), TEXT("Retries/op"), TEXT("GaveUp"), TEXT("LostUpdates"), TEXT("FinalCount"));
+
+	int32 Result = 0;
+	TArray<FRedisContenderStats> Stats;
+	double Seconds = 0.0;
+	int64 FinalCount = 0;
+
+	// Read-modify-write with nothing in between: fastest, and loses updates under contention
+	const bool bPlain = MeasureContention(RedisObject, Key, Field, Threads, Iterations, [RedisObject, &Key, &Field](FRedisContenderStats& OutStats)
+	{
+		FString Value;
+		if (!RedisObject->HGet(Key, Field, Value))
+		{
+			return false;
+		}
+		return RedisObject->HSet(Key, Field, FString::Printf(TEXT("%lld"), FCString::Atoi64(*Value) + 1));
+	}, Stats, Seconds, FinalCount);
+	if (bPlain)
+	{
+		LogContention(TEXT("HGET+HSET"), Stats, Seconds, FinalCount, Expected);
+	}
+
+	// The same increment under WATCH: a nil EXEC retries it from the HGET
+	const bool bTransaction = bPlain && MeasureContention(RedisObject, Key, Field, Threads, Iterations, [RedisObject, &Key, &Field, MaxAttempts](FRedisContenderStats& OutStats)
+	{
+		FRedisTransaction Transaction;
+		Transaction.MaxAttempts = MaxAttempts;
+		Transaction.Watch(Key);
+		Transaction.Reads().HGet(Key, Field);
+		Transaction.Build = [&OutStats, &Key, &Field](const TArray<FRedisReply>& ReadReplies, FRedisPipeline& OutCommands)
+		{
+			++OutStats.Attempts;
+			const int64 Value = ReadReplies.Num() ? FCString::Atoi64(*ReadReplies[0].Str) : 0;
+			OutCommands.HSet(Key, Field, FString::Printf(TEXT("%lld"), Value + 1));
+			return true;
+		};
+		TArray<FRedisReply> Replies;
+		return RedisObject->ExecTransaction(Transaction, Replies);
+	}, Stats, Seconds, FinalCount);
+	if (bTransaction)
+	{
+		LogContention(TEXT("WATCH/EXEC"), Stats, Seconds, FinalCount, Expected);
+	}
+
+	if (!bPlain || !bTransaction)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisBenchmark Transaction could not reset %s"), *Key);
+		Result = 1;
+	}
+
+	RedisObject->DelKey(Key);
+	ReleaseRedisObject(RedisObject);
+	return Result;
+}
+
+URedisBenchmarkCommandlet::URedisBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 URedisBenchmarkCommandlet::Main(const FString& Params)
+{
+	FRedisBenchmarkParams BenchmarkParams;
+	BenchmarkParams.Params = Params;
+	BenchmarkParams.Host = TEXT("127.0.0.1");
+	BenchmarkParams.Port = 6379;
+	BenchmarkParams.Iterations = 0;
+	FParse::Value(*Params, TEXT("Host="), BenchmarkParams.Host);
+	FParse::Value(*Params, TEXT("Port="), BenchmarkParams.Port);
+	FParse::Value(*Params, TEXT("Password="), BenchmarkParams.Password);
+	FParse::Value(*Params, TEXT("Iterations="), BenchmarkParams.Iterations);
+
+	FString Suite;
+	FParse::Value(*Params, TEXT("Suite="), Suite);
+	if (Suite == TEXT("Args"))
+	{
+		return RunArgsBenchmark(BenchmarkParams);
+	}
+	if (Suite == TEXT("Compression"))
+	{
+		return RunCompressionBenchmark(BenchmarkParams);
+	}
+	if (Suite == TEXT("Failover"))
+	{
+		return RunFailoverBenchmark(BenchmarkParams);
+	}
+	if (Suite == TEXT("Transaction"))
+	{
+		return RunTransactionBenchmark(BenchmarkParams);
+	}
+	if (Suite == TEXT("Transport"))
+	{
+		return RunTransportBenchmark(BenchmarkParams);
+	}
+
+	UE_LOG(LogTemp, Error, TEXT("RedisBenchmark needs -Suite=Args, Compression, Failover, Transaction or Transport"));
+	return 1;
+}
@@ -0,0 +1,58 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisBinaryReply.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+void FRedisBinaryReply::Reset(redisReply* InReply)
+{
+	if (Reply)
+	{
+		freeReplyObject(Reply);
+	}
+	Reply = InReply;
+}
+
+int32 FRedisBinaryReply::Num() const
+{
+	if (!Reply)
+	{
+		return 0;
+	}
+	return Reply->type == REDIS_REPLY_ARRAY ? (int32)Reply->elements : 1;
+}
+
+bool FRedisBinaryReply::IsValid(int32 Index) const
+{
+	return GetValue(Index) != nullptr;
+}
+
+TArrayView<const uint8> FRedisBinaryReply::Get(int32 Index) const
+{
+	const redisReply* Value = GetValue(Index);
+	if (!Value)
+	{
+		return TArrayView<const uint8>();
+	}
+	return TArrayView<const uint8>((const uint8*)Value->str, (int32)Value->len);
+}
+
+const redisReply* FRedisBinaryReply::GetValue(int32 Index) const
+{
+	if (Index < 0 || Index >= Num())
+	{
+		return nullptr;
+	}
+
+	const redisReply* Value = Reply->type == REDIS_REPLY_ARRAY ? Reply->element[Index] : Reply;
+	return Value->type == REDIS_REPLY_STRING ? Value : nullptr;
+}
@@ -0,0 +1,87 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisBlockingConsumer.h"
+#include "RedisClient.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+/** Seconds between two connection attempts. */
+static const float RedisConsumerRetryDelay = 1.f;
+
+/** Seconds a reply may be late on top of the blocking time before the connection counts as dead. */
+static const float RedisConsumerReplyMargin = 5.f;
+
+FRedisBlockingConsumer::FRedisBlockingConsumer() :
+	Thread(nullptr)
+{
+	StopEvent = FPlatformProcess::GetSynchEventFromPool(true);
+}
+
+FRedisBlockingConsumer::~FRedisBlockingConsumer()
+{
+	Shutdown();
+	FPlatformProcess::ReturnSynchEventToPool(StopEvent);
+	StopEvent = nullptr;
+}
+
+bool FRedisBlockingConsumer::StartThread(const TCHAR* InThreadName)
+{
+	if (Thread)
+	{
+		return true;
+	}
+
+	bStopping = false;
+	bFinished = false;
+	StopEvent->Reset();
+	Thread = FRunnableThread::Create(this, InThreadName, 0, TPri_BelowNormal);
+	return Thread != nullptr;
+}
+
+void FRedisBlockingConsumer::Shutdown()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FRedisBlockingConsumer::Stop()
+{
+	bStopping = true;
+	StopEvent->Trigger();
+}
+
+uint32 FRedisBlockingConsumer::Run()
+{
+	while (!bStopping)
+	{
+		TSharedPtr<URedisClient> RedisClient = Connect ? Connect() : nullptr;
+		if (!RedisClient.IsValid())
+		{
+			StopEvent->Wait(FMath::RoundToInt(RedisConsumerRetryDelay * 1000.f));
+			continue;
+		}
+
+		RedisClient->SetReadTimeout(GetBlockTime() + RedisConsumerReplyMargin);
+
+		bool bReady = OnConnected(*RedisClient);
+		while (bReady && !bStopping)
+		{
+			bReady = Poll(*RedisClient);
+		}
+
+		if (!bStopping)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Redis %s reconnecting: %s"), *GetDescription(), *RedisClient->GetLastError());
+			StopEvent->Wait(FMath::RoundToInt(RedisConsumerRetryDelay * 1000.f));
+		}
+	}
+
+	bFinished = true;
+	return 0;
+}
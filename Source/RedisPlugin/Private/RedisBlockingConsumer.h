@@ -0,0 +1,70 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FRunnableThread;
+class FEvent;
+class URedisClient;
+
+/**
+ * Thread that owns one connection outside the pool and issues blocking reads on it (BLPOP,
+ * XREADGROUP ... BLOCK, ...) so they never tie up a pooled connection. Reconnects through
+ * Connect whenever a read fails. Subclasses must call Shutdown in their destructor.
+ */
+class FRedisBlockingConsumer : public FRunnable
+{
+public:
+
+	FRedisBlockingConsumer();
+	virtual ~FRedisBlockingConsumer();
+
+	/** Blocks until the read in flight returns. */
+	void Shutdown();
+
+	/** The thread has returned; Shutdown no longer blocks. */
+	bool IsFinished() const
+	{
+		return bFinished;
+	}
+
+	/* FRunnable */
+	virtual uint32 Run() override;
+
+	virtual void Stop() override;
+
+public:
+	/** Consumer thread: opens the connection, on every (re)connect. */
+	TFunction<TSharedPtr<URedisClient>()>	Connect;
+
+protected:
+
+	bool StartThread(const TCHAR* InThreadName);
+
+	/** Once per connection, before the first Poll. False reconnects. */
+	virtual bool OnConnected(URedisClient& InRedisClient)
+	{
+		return true;
+	}
+
+	/** One blocking read. False reconnects. */
+	virtual bool Poll(URedisClient& InRedisClient) = 0;
+
+	/** Seconds the server may hold back a reply, the read timeout goes on top of it. */
+	virtual float GetBlockTime() const = 0;
+
+	/** For the log. */
+	virtual FString GetDescription() const = 0;
+
+protected:
+	FThreadSafeBool		bStopping;
+
+private:
+	FRunnableThread*	Thread;
+	FThreadSafeBool		bFinished;
+	/** Interrupts the wait between reconnect attempts. */
+	FEvent*				StopEvent;
+};
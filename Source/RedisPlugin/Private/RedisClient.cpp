@@ -1,6 +1,19 @@
 // Copyright (C) 2019 GameSeed - All Rights Reserved
 
 #include "RedisClient.h"
+#include "RedisPipeline.h"
+#include "RedisScript.h"
+#include "RedisTransaction.h"
+#include "RedisCluster.h"
+#include "RedisScanIterator.h"
+#include "AsyncRedisDefines.h"
+#include "RedisReplyParser.h"
+#include "RedisReplyDecoder.h"
+#include "RedisBinaryReply.h"
+#include "RedisStructLayout.h"
+#include "RedisCompression.h"
+#include "RedisLatency.h"
+#include "RedisStats.h"
 
 #if PLATFORM_WINDOWS
 #include "Windows/WindowsHWrapper.h"
@@ -13,10 +26,6 @@
 #include "Windows/HideWindowsPlatformTypes.h"
 #endif
 
-#include <sstream>
-
-
-
 
 URedisClient::URedisClient()
 {
@@ -25,7 +34,10 @@ URedisClient::URedisClient()
 	Password = TEXT("");
 	Host = TEXT("");
 	Port = 0;
+	DbIndex = 0;
 	bSubscribed = false;
+	PendingTimingHead = 0;
+	QueueCycles = 0;
 }
 
 URedisClient::~URedisClient()
@@ -33,14 +45,13 @@ URedisClient::~URedisClient()
 	DisconnectRedis();
 }
 
-bool URedisClient::ConnectToRedis(const FString& InHost, int32 InPort, const FString& InPassword)
+bool URedisClient::ConnectToRedis(const FString& InHost, int32 InPort, const FString& InPassword, float InTimeout)
 {
 	Host = InHost;
 	Port = InPort;
 	Password = InPassword;
-	timeval TimeOut = { 1, 0 };// one sec
 
-	RedisContextPtr = redisConnectWithTimeout(TCHAR_TO_ANSI(*Host), Port, TimeOut);
+	RedisContextPtr = ConnectContext(Host, Port, InTimeout);
 	if (!RedisContextPtr)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Connect redis failed"));
@@ -54,7 +65,12 @@ bool URedisClient::ConnectToRedis(const FString& InHost, int32 InPort, const FSt
 		return false;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "AUTH %s", TCHAR_TO_ANSI(*InPassword));
+	if (InPassword.IsEmpty())
+	{
+		return true;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("AUTH").Add(InPassword));
 	if (!RedisReplyPtr)
 	{
 		redisFree(RedisContextPtr);
@@ -62,17 +78,17 @@ bool URedisClient::ConnectToRedis(const FString& InHost, int32 InPort, const FSt
 		return false;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_ERROR)
+	const bool bAuthFailed = RedisReplyPtr->type == REDIS_REPLY_ERROR;
+	if (bAuthFailed)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis AUTH failed. error = %s"), *FRedisReplyParser::ToString(RedisReplyPtr->str, RedisReplyPtr->len));
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	if (bAuthFailed)
 	{
-		if (InPassword.IsEmpty())
-		{
-			FString ErrorString = RedisReplyPtr->str;
-			if (ErrorString.Contains(TEXT("ERR Client sent AUTH, but no password is set")))
-			{
-				return true;
-			}
-		}
-		UE_LOG(LogTemp, Warning, TEXT("Connect redis failed. error = %d"), RedisContextPtr->err);
 		redisFree(RedisContextPtr);
 		RedisContextPtr = nullptr;
 		return false;
@@ -81,6 +97,37 @@ bool URedisClient::ConnectToRedis(const FString& InHost, int32 InPort, const FSt
 	return true;
 }
 
+bool URedisClient::ParseUnixSocketHost(const FString& InHost, FString& OutPath)
+{
+	static const TCHAR UnixScheme[] = TEXT("unix://");
+	if (!InHost.StartsWith(UnixScheme, ESearchCase::IgnoreCase))
+	{
+		return false;
+	}
+
+	OutPath = InHost.RightChop(UE_ARRAY_COUNT(UnixScheme) - 1);
+	return !OutPath.IsEmpty();
+}
+
+redisContext* URedisClient::ConnectContext(const FString& InHost, int32 InPort, float InTimeout)
+{
+	const int32 TimeoutUs = FMath::Max(1, FMath::RoundToInt(InTimeout * 1000000.f));
+	timeval TimeOut = { TimeoutUs / 1000000, TimeoutUs % 1000000 };
+
+	FString SocketPath;
+	if (ParseUnixSocketHost(InHost, SocketPath))
+	{
+#if PLATFORM_WINDOWS
+		// The Win64 hiredis build has no unix socket support
+		UE_LOG(LogTemp, Warning, TEXT("Redis unix:// hosts are not supported on Windows: %s"), *InHost);
+		return nullptr;
+#else
+		return redisConnectUnixWithTimeout(TCHAR_TO_UTF8(*SocketPath), TimeOut);
+#endif
+	}
+	return redisConnectWithTimeout(TCHAR_TO_ANSI(*InHost), InPort, TimeOut);
+}
+
 void URedisClient::DisconnectRedis()
 {
 	if (RedisReplyPtr)
@@ -93,23 +140,1109 @@ void URedisClient::DisconnectRedis()
 		redisFree(RedisContextPtr);
 		RedisContextPtr = nullptr;
 	}
-}
+	FailPendingTimings();
+}
+
+bool URedisClient::SetReadTimeout(float InTimeout)
+{
+	if (!RedisContextPtr)
+	{
+		return false;
+	}
+
+	const int32 TimeoutUs = FMath::Max(0, FMath::RoundToInt(InTimeout * 1000000.f));
+	timeval TimeOut = { TimeoutUs / 1000000, TimeoutUs % 1000000 };
+	return redisSetTimeout(RedisContextPtr, TimeOut) == REDIS_OK;
+}
+
+
+void URedisClient::Quit()
+{
+	if (!RedisContextPtr)
+	{
+		return;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("QUIT"));
+
+	DisconnectRedis();
+}
+
+
+bool URedisClient::IsConnected() const
+{
+	return RedisContextPtr && !RedisContextPtr->err;
+}
+
+bool URedisClient::Ping()
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("PING"));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type == REDIS_REPLY_STATUS)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::SelectIndex(int32 InIndex)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("SELECT").Add(InIndex));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		DbIndex = InIndex;
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::ExecCommand(const FString& InCommand)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	TArray<FString> CommandTokens;
+	InCommand.ParseIntoArrayWS(CommandTokens);
+	if (CommandTokens.Num() == 0)
+	{
+		return bResult;
+	}
+
+	CommandArgs.Reset();
+	for (auto& it : CommandTokens)
+	{
+		CommandArgs.Add(it);
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs);
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+	
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::ExecPipeline(const FRedisPipeline& InPipeline, TArray<FRedisReply>& OutReplies)
+{
+	bool bResult = false;
+
+	OutReplies.Reset(InPipeline.Num());
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	// Write every command into the output buffer first, nothing is sent until the first redisGetReply
+	int32 AppendedNum = 0;
+	bool bAppendFailed = false;
+
+	InPipeline.ForEachCommand([&](const FString* Args, int32 ArgCount)
+	{
+		if (bAppendFailed)
+		{
+			return;
+		}
+
+		CommandArgs.Reset();
+		for (int32 i = 0; i < ArgCount; ++i)
+		{
+			CommandArgs.Add(Args[i]);
+		}
+
+		if (AppendCommandArgv(CommandArgs))
+		{
+			++AppendedNum;
+		}
+		else
+		{
+			bAppendFailed = true;
+		}
+	});
+
+	bResult = !bAppendFailed;
+	for (int32 i = 0; i < AppendedNum; ++i)
+	{
+		if (!GetReply())
+		{
+			bResult = false;
+			break;
+		}
+
+		FRedisReplyParser::ToReply(RedisReplyPtr, OutReplies.AddDefaulted_GetRef());
+
+		freeReplyObject(RedisReplyPtr);
+		RedisReplyPtr = nullptr;
+	}
+
+	// Scripts the server had not cached: rerun as EVAL, which caches them for the next call
+	if (bResult && InPipeline.HasScripts())
+	{
+		int32 CommandIndex = 0;
+		InPipeline.ForEachCommand([&](const FString* Args, int32 ArgCount)
+		{
+			FRedisReply& Reply = OutReplies[CommandIndex];
+			TSharedPtr<URedisScript, ESPMode::ThreadSafe> Script = InPipeline.FindScript(CommandIndex++);
+			if (!Script.IsValid() || !Reply.IsError() || !URedisScript::IsNoScriptError(Reply.Str))
+			{
+				return;
+			}
+
+			CommandArgs.Reset().Add("EVAL").Add(Script->GetSource());
+			for (int32 i = 2; i < ArgCount; ++i)
+			{
+				CommandArgs.Add(Args[i]);
+			}
+			RedisReplyPtr = CommandArgv(CommandArgs);
+			FRedisReplyParser::ToReply(RedisReplyPtr, Reply);
+			if (RedisReplyPtr)
+			{
+				freeReplyObject(RedisReplyPtr);
+				RedisReplyPtr = nullptr;
+			}
+		});
+	}
+
+	// Commands whose reply never arrived are reported as errors so indices still line up
+	while (OutReplies.Num() < InPipeline.Num())
+	{
+		FRedisReply& Reply = OutReplies.AddDefaulted_GetRef();
+		Reply.Type = ERedisReplyType::Error;
+		Reply.Str = TEXT("ERR pipeline aborted");
+	}
+
+	return bResult;
+}
+
+bool URedisClient::ExecBatch(const TArray<FRedisCommandArgs*>& InCommands, TFunctionRef<void(int32, const redisReply*)> InOnReply)
+{
+	int32 AppendedNum = 0;
+	if (RedisContextPtr)
+	{
+		while (AppendedNum < InCommands.Num() && AppendCommandArgv(*InCommands[AppendedNum]))
+		{
+			++AppendedNum;
+		}
+	}
+
+	int32 ReadNum = 0;
+	for (; ReadNum < AppendedNum; ++ReadNum)
+	{
+		if (!GetReply())
+		{
+			break;
+		}
+
+		InOnReply(ReadNum, RedisReplyPtr);
+
+		freeReplyObject(RedisReplyPtr);
+		RedisReplyPtr = nullptr;
+	}
+
+	const bool bResult = ReadNum == InCommands.Num();
+	for (; ReadNum < InCommands.Num(); ++ReadNum)
+	{
+		InOnReply(ReadNum, nullptr);
+	}
+	return bResult;
+}
+
+bool URedisClient::ClusterSlots(TArray<FRedisSlotRange>& OutRanges)
+{
+	bool bResult = false;
+
+	OutRanges.Reset();
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("CLUSTER").Add("SLOTS"));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type == REDIS_REPLY_ARRAY)
+	{
+		// [start, end, [host, port, id], replicas...]
+		for (size_t i = 0; i < RedisReplyPtr->elements; ++i)
+		{
+			const redisReply* Entry = RedisReplyPtr->element[i];
+			if (Entry->type != REDIS_REPLY_ARRAY || Entry->elements < 3 || Entry->element[2]->type != REDIS_REPLY_ARRAY || Entry->element[2]->elements < 2)
+			{
+				continue;
+			}
+
+			const redisReply* Primary = Entry->element[2];
+			FRedisSlotRange& Range = OutRanges.AddDefaulted_GetRef();
+			Range.Start = (int32)Entry->element[0]->integer;
+			Range.End = (int32)Entry->element[1]->integer;
+			Range.Host = FRedisReplyParser::ToString(Primary->element[0]->str, Primary->element[0]->len);
+			Range.Port = (int32)Primary->element[1]->integer;
+		}
+		bResult = true;
+	}
+	else if (RedisReplyPtr->type == REDIS_REPLY_ERROR)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis CLUSTER SLOTS failed. error = %s"), *LastError);
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::Asking()
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("ASKING"));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	bResult = RedisReplyPtr->type == REDIS_REPLY_STATUS;
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::ExecTransaction(const FRedisTransaction& InTransaction, TArray<FRedisReply>& OutReplies)
+{
+	bool bResult = false;
+
+	OutReplies.Reset();
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	const TArray<FString>& WatchKeys = InTransaction.GetWatchKeys();
+	const FRedisPipeline& Reads = InTransaction.GetReads();
+	const bool bBuild = (bool)InTransaction.Build;
+
+	FRedisPipeline BuiltCommands;
+	TArray<FRedisReply> ReadReplies;
+
+	for (int32 Attempt = 0; Attempt < InTransaction.MaxAttempts; ++Attempt)
+	{
+		if (WatchKeys.Num())
+		{
+			CommandArgs.Reset().Add("WATCH");
+			for (auto& it : WatchKeys)
+			{
+				CommandArgs.Add(it);
+			}
+			if (!AppendCommandArgv(CommandArgs))
+			{
+				return bResult;
+			}
+		}
+		if (!AppendPipeline(Reads))
+		{
+			return bResult;
+		}
+
+		const FRedisPipeline* Body = &InTransaction.GetCommands();
+		if (bBuild)
+		{
+			// Round trip for WATCH and the reads, then let the caller decide what to write
+			if (WatchKeys.Num() && !ReadReply(nullptr))
+			{
+				return bResult;
+			}
+			ReadReplies.SetNum(Reads.Num());
+			for (FRedisReply& Reply : ReadReplies)
+			{
+				if (!ReadReply(&Reply))
+				{
+					return bResult;
+				}
+			}
+
+			BuiltCommands.Reset();
+			if (!InTransaction.Build(ReadReplies, BuiltCommands))
+			{
+				RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("UNWATCH"));
+				if (RedisReplyPtr)
+				{
+					freeReplyObject(RedisReplyPtr);
+					RedisReplyPtr = nullptr;
+				}
+				return bResult;
+			}
+			Body = &BuiltCommands;
+		}
+
+		if (!AppendCommandArgv(CommandArgs.Reset().Add("MULTI"))
+			|| !AppendPipeline(*Body)
+			|| !AppendCommandArgv(CommandArgs.Reset().Add("EXEC")))
+		{
+			return bResult;
+		}
+
+		// WATCH and reads (single write only), MULTI, one QUEUED per command
+		const int32 SkipNum = (bBuild ? 0 : (WatchKeys.Num() ? 1 : 0) + Reads.Num()) + 1 + Body->Num();
+		for (int32 i = 0; i < SkipNum; ++i)
+		{
+			if (!ReadReply(nullptr))
+			{
+				return bResult;
+			}
+		}
+
+		if (!GetReply())
+		{
+			return bResult;
+		}
+
+		const int ExecType = RedisReplyPtr->type;
+		if (ExecType == REDIS_REPLY_ARRAY)
+		{
+			OutReplies.SetNum(RedisReplyPtr->elements);
+			for (size_t i = 0; i < RedisReplyPtr->elements; ++i)
+			{
+				FRedisReplyParser::ToReply(RedisReplyPtr->element[i], OutReplies[i]);
+			}
+			bResult = true;
+		}
+		else if (ExecType == REDIS_REPLY_ERROR)
+		{
+			// EXECABORT: a command was rejected while queueing, retrying won't help
+			UE_LOG(LogTemp, Warning, TEXT("Redis transaction aborted. error = %s"), *FRedisReplyParser::ToString(RedisReplyPtr->str, RedisReplyPtr->len));
+		}
+
+		freeReplyObject(RedisReplyPtr);
+		RedisReplyPtr = nullptr;
+
+		if (ExecType != REDIS_REPLY_NIL)
+		{
+			return bResult;
+		}
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Redis transaction gave up after %d attempts on contended keys"), InTransaction.MaxAttempts);
+	return bResult;
+}
+
+bool URedisClient::ScriptLoad(const URedisScript& InScript)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("SCRIPT").Add("LOAD").Add(InScript.GetSource()));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	FString Sha1;
+	if (FRedisReplyParser::ParseString(RedisReplyPtr, Sha1))
+	{
+		bResult = Sha1.Equals(InScript.GetSha1(), ESearchCase::IgnoreCase);
+		if (!bResult)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Redis script %s loaded as %s, expected %s"), *InScript.GetName().ToString(), *Sha1, *InScript.GetSha1());
+		}
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::EvalScript(const URedisScript& InScript, const TArray<FString>& InKeys, const TArray<FString>& InArgs, FRedisReply& OutReply)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	BuildEvalCommand(CommandArgs, InScript, true, InKeys, InArgs);
+	RedisReplyPtr = CommandArgv(CommandArgs);
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	FRedisReplyParser::ToReply(RedisReplyPtr, OutReply);
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	if (OutReply.IsError() && URedisScript::IsNoScriptError(OutReply.Str))
+	{
+		BuildEvalCommand(CommandArgs, InScript, false, InKeys, InArgs);
+		RedisReplyPtr = CommandArgv(CommandArgs);
+		if (!RedisReplyPtr)
+		{
+			return bResult;
+		}
+
+		FRedisReplyParser::ToReply(RedisReplyPtr, OutReply);
+		freeReplyObject(RedisReplyPtr);
+		RedisReplyPtr = nullptr;
+	}
+
+	bResult = !OutReply.IsError();
+
+	return bResult;
+}
+
+void URedisClient::BuildEvalCommand(FRedisCommandArgs& OutArgs, const URedisScript& InScript, bool bBySha, const TArray<FString>& InKeys, const TArray<FString>& InArgs)
+{
+	OutArgs.Reset();
+	if (bBySha)
+	{
+		OutArgs.Add("EVALSHA").Add(InScript.GetSha1());
+	}
+	else
+	{
+		OutArgs.Add("EVAL").Add(InScript.GetSource());
+	}
+	OutArgs.Add(InKeys.Num());
+	for (auto& it : InKeys)
+	{
+		OutArgs.Add(it);
+	}
+	for (auto& it : InArgs)
+	{
+		OutArgs.Add(it);
+	}
+}
+
+redisReply* URedisClient::CommandArgv(FRedisCommandArgs& InArgs)
+{
+	const int32 Command = FRedisLatency::FindCommand(InArgs.GetName());
+	const uint64 TraceId = FRedisStats::BeginCommand(InArgs);
+	const uint64 SendCycles = FPlatformTime::Cycles64();
+	redisReply* Reply = (redisReply*)redisCommandArgv(RedisContextPtr, InArgs.Num(), InArgs.GetArgv(), InArgs.GetArgvLen());
+	FRedisStats::EndCommand(TraceId, Reply);
+	if (Reply)
+	{
+		FRedisLatency::Record(Command, QueueCycles, FPlatformTime::Cycles64() - SendCycles);
+		QueueCycles = 0;
+		if (Reply->type == REDIS_REPLY_ERROR)
+		{
+			LastError = FRedisReplyParser::ToString(Reply->str, Reply->len);
+		}
+	}
+	return Reply;
+}
+
+bool URedisClient::AppendCommandArgv(FRedisCommandArgs& InArgs)
+{
+	if (redisAppendCommandArgv(RedisContextPtr, InArgs.Num(), InArgs.GetArgv(), InArgs.GetArgvLen()) != REDIS_OK)
+	{
+		return false;
+	}
+
+	// Nothing is sent before the first read, so the round trip of a pipelined command includes the rest of the batch being written
+	FPendingTiming& Timing = PendingTimings.AddDefaulted_GetRef();
+	Timing.Command = FRedisLatency::FindCommand(InArgs.GetName());
+	Timing.Cycles = FPlatformTime::Cycles64();
+	Timing.TraceId = FRedisStats::BeginCommand(InArgs);
+	return true;
+}
+
+bool URedisClient::GetReply()
+{
+	if (redisGetReply(RedisContextPtr, (void**)&RedisReplyPtr) != REDIS_OK || !RedisReplyPtr)
+	{
+		FailPendingTimings();
+		return false;
+	}
+	FRedisStats::EndCommand(PopPendingTiming(), RedisReplyPtr);
+	return true;
+}
+
+uint64 URedisClient::PopPendingTiming()
+{
+	if (PendingTimingHead >= PendingTimings.Num())
+	{
+		return 0;
+	}
+
+	const FPendingTiming Timing = PendingTimings[PendingTimingHead];
+	FRedisLatency::Record(Timing.Command, QueueCycles, FPlatformTime::Cycles64() - Timing.Cycles);
+	QueueCycles = 0;
+	if (++PendingTimingHead == PendingTimings.Num())
+	{
+		PendingTimings.Reset();
+		PendingTimingHead = 0;
+	}
+	return Timing.TraceId;
+}
+
+void URedisClient::FailPendingTimings()
+{
+	// The replies still owed will never come on this connection
+	for (int32 i = PendingTimingHead; i < PendingTimings.Num(); ++i)
+	{
+		FRedisStats::EndCommand(PendingTimings[i].TraceId, nullptr);
+	}
+	PendingTimings.Reset();
+	PendingTimingHead = 0;
+}
+
+bool URedisClient::AppendPipeline(const FRedisPipeline& InPipeline)
+{
+	bool bAppended = true;
+	InPipeline.ForEachCommand([this, &bAppended](const FString* Args, int32 ArgCount)
+	{
+		if (!bAppended)
+		{
+			return;
+		}
+
+		CommandArgs.Reset();
+		for (int32 i = 0; i < ArgCount; ++i)
+		{
+			CommandArgs.Add(Args[i]);
+		}
+		bAppended = AppendCommandArgv(CommandArgs);
+	});
+	return bAppended;
+}
+
+bool URedisClient::ReadReply(FRedisReply* OutReply)
+{
+	if (!GetReply())
+	{
+		return false;
+	}
+
+	if (RedisReplyPtr->type == REDIS_REPLY_ERROR)
+	{
+		LastError = FRedisReplyParser::ToString(RedisReplyPtr->str, RedisReplyPtr->len);
+	}
+	if (OutReply)
+	{
+		FRedisReplyParser::ToReply(RedisReplyPtr, *OutReply);
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return true;
+}
+
+bool URedisClient::ReadDecoded(FRedisReplyDecoder& InDecoder)
+{
+	const bool bDecoded = InDecoder.Read(RedisContextPtr);
+	if (RedisContextPtr && !RedisContextPtr->err)
+	{
+		FRedisStats::EndCommand(PopPendingTiming(), true, InDecoder.GetSize());
+	}
+	else
+	{
+		FailPendingTimings();
+	}
+	if (!InDecoder.GetError().IsEmpty())
+	{
+		LastError = InDecoder.GetError();
+	}
+	return bDecoded;
+}
+
+bool URedisClient::Subscribe(const FString& InChannel)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("SUBSCRIBE").Add(InChannel));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+		bSubscribed = true;
+	}
+
+// 	freeReplyObject(RedisReplyPtr);
+// 	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+void URedisClient::Unsubscribe()
+{
+	bSubscribed = false;
+}
+
+bool URedisClient::Subscribed()
+{
+	return bSubscribed;
+}
+
+bool URedisClient::SubscribeReply(FString& Channel, FString& Message)
+{
+	if (redisGetReply(RedisContextPtr, (void**)&RedisReplyPtr) == REDIS_OK)
+	{
+		if (RedisReplyPtr->type == REDIS_REPLY_ARRAY && RedisReplyPtr->elements == 3)
+		{
+			Channel = FRedisReplyParser::ToString(RedisReplyPtr->element[1]->str, RedisReplyPtr->element[1]->len);
+			Message = FRedisReplyParser::ToString(RedisReplyPtr->element[2]->str, RedisReplyPtr->element[2]->len);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool URedisClient::UnsubscribeChannel(const FString& InChannel)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("UNSUBSCRIBE").Add(InChannel));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+
+bool URedisClient::Publish(const FString& InChannel, const FString& InMessage)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("PUBLISH").Add(InChannel).Add(InMessage));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::ExistsKey(const FString& InKey)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("EXISTS").Add(InKey));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = (bool)RedisReplyPtr->integer;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::ExpireKey(const FString& InKey, int32 Sec)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("EXPIRE").Add(InKey).Add(Sec));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+	
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = (bool)RedisReplyPtr->integer;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::PersistKey(const FString& InKey)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("PERSIST").Add(InKey));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = (bool)RedisReplyPtr->integer;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+
+bool URedisClient::RenameKey(const FString& CurrentKey, const FString& NewKey)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("RENAME").Add(CurrentKey).Add(NewKey));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::DelKey(const FString& InKey)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("DEL").Add(InKey));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::TypeKey(const FString& InKey, FString& OutType)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("TYPE").Add(InKey));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+	
+	if (RedisReplyPtr->type == REDIS_REPLY_STATUS)
+	{
+		OutType = FRedisReplyParser::ToString(RedisReplyPtr->str, RedisReplyPtr->len);// none string list set zset hash 
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::MSet(TMap<FString, FString>& InMemberMap)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	CommandArgs.Reset().Add("MSET");
+	for (auto &it : InMemberMap)
+	{
+		CommandArgs.Add(it.Key).Add(it.Value);
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs);
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	CommandArgs.Reset().Add("MGET");
+	for (auto& it : InKeyList)
+	{
+		CommandArgs.Add(it);
+	}
+	if (!AppendCommandArgv(CommandArgs))
+	{
+		return bResult;
+	}
+
+	FRedisReplyDecoder Decoder(OutMemberList);
+	Decoder.bDecompress = true;
+	bResult = ReadDecoded(Decoder);
+
+	return bResult;
+}
+
+bool URedisClient::SetInt(const FString& InKey, int32 InValue)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("SET").Add(InKey).Add(InValue));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::GetInt(const FString& InKey, int32& OutValue)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("GET").Add(InKey));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	switch (RedisReplyPtr->type)
+	{
+		case REDIS_REPLY_INTEGER:
+			{
+				OutValue = RedisReplyPtr->integer;
+				bResult = true;
+			}
+			break;
+		case REDIS_REPLY_STRING:
+			{
+				OutValue = atoi(RedisReplyPtr->str);
+				bResult = true;
+			}
+			break;
+		default:
+			break;
+	}
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::SetStr(const FString& InKey, const FString& InValue)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("SET").Add(InKey).Add(InValue));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
+	}
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	{
+		bResult = true;
+	}
 
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
 
-void URedisClient::Quit()
+	return bResult;
+}
+
+bool URedisClient::GetStr(const FString& InKey, FString& OutValue)
 {
+	bool bResult = false;
+
 	if (!RedisContextPtr)
 	{
-		return;
+		return bResult;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("GET").Add(InKey));
+	if (!RedisReplyPtr)
+	{
+		return bResult;
 	}
+	
+	bResult = FRedisCompression::ParseString(RedisReplyPtr, OutValue);
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "QUIT");
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
 
-	DisconnectRedis();
+	return bResult;
 }
 
 
-bool URedisClient::SelectIndex(int32 InIndex)
+bool URedisClient::Append(const FString& InKey, const FString& InValue)
 {
 	bool bResult = false;
 
@@ -118,7 +1251,7 @@ bool URedisClient::SelectIndex(int32 InIndex)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "SELECT %d", InIndex);
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("APPEND").Add(InKey).Add(InValue));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -135,7 +1268,7 @@ bool URedisClient::SelectIndex(int32 InIndex)
 	return bResult;
 }
 
-bool URedisClient::ExecCommand(const FString& InCommand)
+bool URedisClient::Scan(ERedisScanType InType, const FString& InKey, FString& InOutCursor, const FString& InMatch, int32 InCount, TArray<FString>& OutElements)
 {
 	bool bResult = false;
 
@@ -144,16 +1277,14 @@ bool URedisClient::ExecCommand(const FString& InCommand)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "%s", TCHAR_TO_ANSI(*InCommand));
+	BuildScanCommand(CommandArgs, InType, InKey, InOutCursor, InMatch, InCount);
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-	
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-	}
+
+	bResult = FRedisReplyParser::ParseScan(RedisReplyPtr, InOutCursor, OutElements);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -161,8 +1292,36 @@ bool URedisClient::ExecCommand(const FString& InCommand)
 	return bResult;
 }
 
+void URedisClient::BuildScanCommand(FRedisCommandArgs& OutArgs, ERedisScanType InType, const FString& InKey, const FString& InCursor, const FString& InMatch, int32 InCount)
+{
+	OutArgs.Reset();
+	switch (InType)
+	{
+	case ERedisScanType::Keys:
+		OutArgs.Add("SCAN");
+		break;
+	case ERedisScanType::Set:
+		OutArgs.Add("SSCAN").Add(InKey);
+		break;
+	case ERedisScanType::Hash:
+		OutArgs.Add("HSCAN").Add(InKey);
+		break;
+	case ERedisScanType::SortedSet:
+		OutArgs.Add("ZSCAN").Add(InKey);
+		break;
+	}
+	OutArgs.Add(InCursor);
+	if (!InMatch.IsEmpty())
+	{
+		OutArgs.Add("MATCH").Add(InMatch);
+	}
+	if (InCount > 0)
+	{
+		OutArgs.Add("COUNT").Add(InCount);
+	}
+}
 
-bool URedisClient::Subscribe(const FString& InChannel)
+bool URedisClient::ZAdd(const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag, int32& OutAdded)
 {
 	bool bResult = false;
 
@@ -171,49 +1330,45 @@ bool URedisClient::Subscribe(const FString& InChannel)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "SUBSCRIBE %s", TCHAR_TO_ANSI(*InChannel));
+	BuildZAddCommand(CommandArgs, InKey, InMemberList, InFlag);
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-		bSubscribed = true;
-	}
+	bResult = FRedisReplyParser::ParseInt(RedisReplyPtr, OutAdded);
 
-// 	freeReplyObject(RedisReplyPtr);
-// 	RedisReplyPtr = nullptr;
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
 
 	return bResult;
 }
 
-void URedisClient::Unsubscribe()
+bool URedisClient::ZIncrby(const FString& InKey, const FString& InMember, double Incre, double& OutScore)
 {
-	bSubscribed = false;
-}
+	bool bResult = false;
 
-bool URedisClient::Subscribed()
-{
-	return bSubscribed;
-}
+	if (!RedisContextPtr)
+	{
+		return bResult;
+	}
 
-bool URedisClient::SubscribeReply(FString& Channel, FString& Message)
-{
-	if (redisGetReply(RedisContextPtr, (void**)&RedisReplyPtr) == REDIS_OK)
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("ZINCRBY").Add(InKey).Add(Incre).Add(InMember));
+	if (!RedisReplyPtr)
 	{
-		if (RedisReplyPtr->type == REDIS_REPLY_ARRAY && RedisReplyPtr->elements == 3)
-		{
-			Channel = RedisReplyPtr->element[1]->str;
-			Message = RedisReplyPtr->element[2]->str;
-			return true;
-		}
+		return bResult;
 	}
-	return false;
+
+	bResult = FRedisReplyParser::ParseDouble(RedisReplyPtr, OutScore);
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
 }
 
-bool URedisClient::UnsubscribeChannel(const FString& InChannel)
+bool URedisClient::ZRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList)
 {
 	bool bResult = false;
 
@@ -222,16 +1377,13 @@ bool URedisClient::UnsubscribeChannel(const FString& InChannel)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "UNSUBSCRIBE %s", TCHAR_TO_ANSI(*InChannel));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("ZRANGE").Add(InKey).Add(Start).Add(Stop).Add("WITHSCORES"));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-	}
+	bResult = FRedisReplyParser::ParseScoredMembers(RedisReplyPtr, OutMemberList);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -239,8 +1391,7 @@ bool URedisClient::UnsubscribeChannel(const FString& InChannel)
 	return bResult;
 }
 
-
-bool URedisClient::Publish(const FString& InChannel, const FString& InMessage)
+bool URedisClient::ZRevRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList)
 {
 	bool bResult = false;
 
@@ -249,16 +1400,13 @@ bool URedisClient::Publish(const FString& InChannel, const FString& InMessage)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "PUBLISH %s %s", TCHAR_TO_ANSI(*InChannel), TCHAR_TO_ANSI(*InMessage));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("ZREVRANGE").Add(InKey).Add(Start).Add(Stop).Add("WITHSCORES"));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-	}
+	bResult = FRedisReplyParser::ParseScoredMembers(RedisReplyPtr, OutMemberList);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -266,7 +1414,7 @@ bool URedisClient::Publish(const FString& InChannel, const FString& InMessage)
 	return bResult;
 }
 
-bool URedisClient::ExistsKey(const FString& InKey)
+bool URedisClient::ZRangeByScore(const FString& InKey, double Min, double Max, int32 Offset, int32 Count, TArray<FRedisScoredMember>& OutMemberList)
 {
 	bool bResult = false;
 
@@ -275,16 +1423,14 @@ bool URedisClient::ExistsKey(const FString& InKey)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "EXISTS %s", TCHAR_TO_ANSI(*InKey));
+	BuildZRangeByScoreCommand(CommandArgs, InKey, Min, Max, Offset, Count);
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = (bool)RedisReplyPtr->integer;
-	}
+	bResult = FRedisReplyParser::ParseScoredMembers(RedisReplyPtr, OutMemberList);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -292,7 +1438,7 @@ bool URedisClient::ExistsKey(const FString& InKey)
 	return bResult;
 }
 
-bool URedisClient::ExpireKey(const FString& InKey, int32 Sec)
+bool URedisClient::ZRank(const FString& InKey, const FString& InMember, int32& OutRank)
 {
 	bool bResult = false;
 
@@ -301,15 +1447,17 @@ bool URedisClient::ExpireKey(const FString& InKey, int32 Sec)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "EXPIRE %s %d", TCHAR_TO_ANSI(*InKey), Sec);
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("ZRANK").Add(InKey).Add(InMember));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-	
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+
+	int64 Rank = 0;
+	if (FRedisReplyParser::ParseInt64(RedisReplyPtr, Rank))
 	{
-		bResult = (bool)RedisReplyPtr->integer;
+		OutRank = (int32)Rank;
+		bResult = true;
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -318,7 +1466,7 @@ bool URedisClient::ExpireKey(const FString& InKey, int32 Sec)
 	return bResult;
 }
 
-bool URedisClient::PersistKey(const FString& InKey)
+bool URedisClient::ZScore(const FString& InKey, const FString& InMember, double& OutScore)
 {
 	bool bResult = false;
 
@@ -327,16 +1475,13 @@ bool URedisClient::PersistKey(const FString& InKey)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "PERSIST %s", TCHAR_TO_ANSI(*InKey));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("ZSCORE").Add(InKey).Add(InMember));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = (bool)RedisReplyPtr->integer;
-	}
+	bResult = FRedisReplyParser::ParseDouble(RedisReplyPtr, OutScore);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -344,8 +1489,7 @@ bool URedisClient::PersistKey(const FString& InKey)
 	return bResult;
 }
 
-
-bool URedisClient::RenameKey(const FString& CurrentKey, const FString& NewKey)
+bool URedisClient::ZMScore(const FString& InKey, const TArray<FString>& InMemberList, TArray<FRedisScoredMember>& OutMemberList)
 {
 	bool bResult = false;
 
@@ -354,24 +1498,90 @@ bool URedisClient::RenameKey(const FString& CurrentKey, const FString& NewKey)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "RENAME %s %s", TCHAR_TO_ANSI(*CurrentKey), TCHAR_TO_ANSI(*NewKey));
+	CommandArgs.Reset().Add("ZMSCORE").Add(InKey);
+	for (auto& it : InMemberList)
+	{
+		CommandArgs.Add(it);
+	}
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	bResult = FRedisReplyParser::ParseScores(RedisReplyPtr, InMemberList, OutMemberList);
+
+	freeReplyObject(RedisReplyPtr);
+	RedisReplyPtr = nullptr;
+
+	return bResult;
+}
+
+bool URedisClient::ZRem(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
 	{
-		bResult = true;
+		return bResult;
+	}
+
+	CommandArgs.Reset().Add("ZREM").Add(InKey);
+	for (auto& it : InMemberList)
+	{
+		CommandArgs.Add(it);
+	}
+	RedisReplyPtr = CommandArgv(CommandArgs);
+	if (!RedisReplyPtr)
+	{
+		return bResult;
 	}
 
+	bResult = FRedisReplyParser::ParseStatus(RedisReplyPtr);
+
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
 
 	return bResult;
 }
 
-bool URedisClient::DelKey(const FString& InKey)
+void URedisClient::BuildZAddCommand(FRedisCommandArgs& OutArgs, const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag)
+{
+	OutArgs.Reset().Add("ZADD").Add(InKey);
+	switch (InFlag)
+	{
+	case ERedisZAddFlag::NX:
+		OutArgs.Add("NX");
+		break;
+	case ERedisZAddFlag::XX:
+		OutArgs.Add("XX");
+		break;
+	case ERedisZAddFlag::GT:
+		OutArgs.Add("GT");
+		break;
+	case ERedisZAddFlag::LT:
+		OutArgs.Add("LT");
+		break;
+	default:
+		break;
+	}
+	for (auto& it : InMemberList)
+	{
+		OutArgs.Add(it.Score).Add(it.Member);
+	}
+}
+
+void URedisClient::BuildZRangeByScoreCommand(FRedisCommandArgs& OutArgs, const FString& InKey, double Min, double Max, int32 Offset, int32 Count)
+{
+	OutArgs.Reset().Add("ZRANGEBYSCORE").Add(InKey).Add(Min).Add(Max).Add("WITHSCORES");
+	// Count 0 is what a fresh Blueprint pin holds, so it means no limit rather than LIMIT x 0
+	if (Offset > 0 || Count > 0)
+	{
+		OutArgs.Add("LIMIT").Add(Offset).Add(Count > 0 ? Count : -1);
+	}
+}
+
+bool URedisClient::SAdd(const FString& InKey, const TArray<FString>& InMemberList)
 {
 	bool bResult = false;
 
@@ -380,7 +1590,13 @@ bool URedisClient::DelKey(const FString& InKey)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "DEL %s", TCHAR_TO_ANSI(*InKey));
+	CommandArgs.Reset().Add("SADD").Add(InKey);
+	for (auto &it : InMemberList)
+	{
+		CommandArgs.Add(it);
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -397,7 +1613,8 @@ bool URedisClient::DelKey(const FString& InKey)
 	return bResult;
 }
 
-bool URedisClient::TypeKey(const FString& InKey, FString& OutType)
+
+bool URedisClient::SCard(const FString& InKey, int32& OutValue)
 {
 	bool bResult = false;
 
@@ -406,16 +1623,16 @@ bool URedisClient::TypeKey(const FString& InKey, FString& OutType)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "TYPE %s", TCHAR_TO_ANSI(*InKey));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("SCARD").Add(InKey));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-	
-	if (RedisReplyPtr->type == REDIS_REPLY_STATUS)
+
+	if (RedisReplyPtr->type == REDIS_REPLY_INTEGER)
 	{
-		OutType = RedisReplyPtr->str;// none string list set zset hash 
 		bResult = true;
+		OutValue = RedisReplyPtr->integer;
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -424,7 +1641,7 @@ bool URedisClient::TypeKey(const FString& InKey, FString& OutType)
 	return bResult;
 }
 
-bool URedisClient::MSet(TMap<FString, FString>& InMemberMap)
+bool URedisClient::SRem(const FString& InKey, const TArray<FString>& InMemberList)
 {
 	bool bResult = false;
 
@@ -433,14 +1650,13 @@ bool URedisClient::MSet(TMap<FString, FString>& InMemberMap)
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "MSET";
-	for (auto &it : InMemberMap)
+	CommandArgs.Reset().Add("SREM").Add(InKey);
+	for (auto &it : InMemberList)
 	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it.Key)) << " " << TCHAR_TO_ANSI(*(it.Value));
+		CommandArgs.Add(it);
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -457,7 +1673,7 @@ bool URedisClient::MSet(TMap<FString, FString>& InMemberMap)
 	return bResult;
 }
 
-bool URedisClient::MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList)
+bool URedisClient::SMembers(const FString& InKey, TArray<FString>& OutMemberList)
 {
 	bool bResult = false;
 
@@ -466,29 +1682,35 @@ bool URedisClient::MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMe
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "MGET";
-	for (auto &it : InKeyList)
+	if (!AppendCommandArgv(CommandArgs.Reset().Add("SMEMBERS").Add(InKey)))
+	{
+		return bResult;
+	}
+
+	FRedisReplyDecoder Decoder(OutMemberList);
+	bResult = ReadDecoded(Decoder);
+
+	return bResult;
+}
+
+bool URedisClient::HSet(const FString& InKey, const FString& InField, const FString& InValue)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
 	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it));
+		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("HSET").Add(InKey).Add(InField).Add(InValue));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_ARRAY)
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
 	{
 		bResult = true;
-		for (auto i = 0; i < RedisReplyPtr->elements; i++)
-		{
-			if (RedisReplyPtr->element[i]->str != NULL)
-			{
-				OutMemberList.Add(RedisReplyPtr->element[i]->str);
-			}
-		}
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -497,7 +1719,7 @@ bool URedisClient::MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMe
 	return bResult;
 }
 
-bool URedisClient::SetInt(const FString& InKey, int32 InValue)
+bool URedisClient::HGet(const FString& InKey, const FString& InField, FString& OutValue)
 {
 	bool bResult = false;
 
@@ -506,16 +1728,13 @@ bool URedisClient::SetInt(const FString& InKey, int32 InValue)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "SET %s %lld", TCHAR_TO_ANSI(*InKey), InValue);
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("HGET").Add(InKey).Add(InField));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-	}
+	
+	bResult = FRedisCompression::ParseString(RedisReplyPtr, OutValue);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -523,7 +1742,7 @@ bool URedisClient::SetInt(const FString& InKey, int32 InValue)
 	return bResult;
 }
 
-bool URedisClient::GetInt(const FString& InKey, int32& OutValue)
+bool URedisClient::HIncrby(const FString & InKey, const FString & InField, int32 Incre)
 {
 	bool bResult = false;
 
@@ -532,28 +1751,15 @@ bool URedisClient::GetInt(const FString& InKey, int32& OutValue)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "GET %s", TCHAR_TO_ANSI(*InKey));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("HINCRBY").Add(InKey).Add(InField).Add(Incre));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	switch (RedisReplyPtr->type)
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
 	{
-		case REDIS_REPLY_INTEGER:
-			{
-				OutValue = RedisReplyPtr->integer;
-				bResult = true;
-			}
-			break;
-		case REDIS_REPLY_STRING:
-			{
-				OutValue = atoi(RedisReplyPtr->str);
-				bResult = true;
-			}
-			break;
-		default:
-			break;
+		bResult = true;
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -562,7 +1768,9 @@ bool URedisClient::GetInt(const FString& InKey, int32& OutValue)
 	return bResult;
 }
 
-bool URedisClient::SetStr(const FString& InKey, const FString& InValue)
+
+
+bool URedisClient::HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap, const FRedisCompressionDictionary* InDictionary, int32 InThreshold)
 {
 	bool bResult = false;
 
@@ -571,7 +1779,14 @@ bool URedisClient::SetStr(const FString& InKey, const FString& InValue)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "SET %s %s", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*InValue));
+	CommandArgs.Reset().Add("HMSET").Add(InKey);
+	for (auto &it : InMemberMap)
+	{
+		CommandArgs.Add(it.Key);
+		FRedisCompression::AddValue(CommandArgs, it.Value, InDictionary, InThreshold);
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -588,7 +1803,7 @@ bool URedisClient::SetStr(const FString& InKey, const FString& InValue)
 	return bResult;
 }
 
-bool URedisClient::GetStr(const FString& InKey, FString& OutValue)
+bool URedisClient::HSetStruct(const FString& InKey, const FRedisStructLayout& InLayout, const void* InData, const void* InBaseline)
 {
 	bool bResult = false;
 
@@ -597,15 +1812,19 @@ bool URedisClient::GetStr(const FString& InKey, FString& OutValue)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "GET %s", TCHAR_TO_ANSI(*InKey));
+	if (InLayout.BuildHSet(CommandArgs, InKey, InData, InBaseline) == 0)
+	{
+		return true;
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-	
-	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
 	{
-		OutValue = RedisReplyPtr->str;
 		bResult = true;
 	}
 
@@ -615,26 +1834,23 @@ bool URedisClient::GetStr(const FString& InKey, FString& OutValue)
 	return bResult;
 }
 
-
-bool URedisClient::Append(const FString& InKey, const FString& InValue)
+bool URedisClient::HGetStruct(const FString& InKey, const FRedisStructLayout& InLayout, void* OutData)
 {
 	bool bResult = false;
 
-	if (!RedisContextPtr)
+	if (!RedisContextPtr || InLayout.Num() == 0)
 	{
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "APPEND %s %s", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*InValue));
+	InLayout.BuildHMGet(CommandArgs, InKey);
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-	}
+	bResult = InLayout.Decode(RedisReplyPtr, OutData);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -642,7 +1858,7 @@ bool URedisClient::Append(const FString& InKey, const FString& InValue)
 	return bResult;
 }
 
-bool URedisClient::SAdd(const FString& InKey, const TArray<FString>& InMemberList)
+bool URedisClient::HDel(const FString& InKey, const TArray<FString>& InFieldList)
 {
 	bool bResult = false;
 
@@ -651,14 +1867,13 @@ bool URedisClient::SAdd(const FString& InKey, const TArray<FString>& InMemberLis
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "SADD " << TCHAR_TO_ANSI(*InKey);
-	for (auto &it : InMemberList)
+	CommandArgs.Reset().Add("HDEL").Add(InKey);
+	for (auto &it : InFieldList)
 	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it));
+		CommandArgs.Add(it);
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -676,7 +1891,7 @@ bool URedisClient::SAdd(const FString& InKey, const TArray<FString>& InMemberLis
 }
 
 
-bool URedisClient::SCard(const FString& InKey, int32& OutValue)
+bool URedisClient::HExists(const FString& InKey, const FString& InField)
 {
 	bool bResult = false;
 
@@ -685,16 +1900,15 @@ bool URedisClient::SCard(const FString& InKey, int32& OutValue)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "SCARD %s ", TCHAR_TO_ANSI(*InKey));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("HEXISTS").Add(InKey).Add(InField));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_INTEGER)
+	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
 	{
-		bResult = true;
-		OutValue = RedisReplyPtr->integer;
+		bResult = (bool)RedisReplyPtr->integer;
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -703,7 +1917,7 @@ bool URedisClient::SCard(const FString& InKey, int32& OutValue)
 	return bResult;
 }
 
-bool URedisClient::SRem(const FString& InKey, const TArray<FString>& InMemberList)
+bool URedisClient::HMGet(const FString& InKey, const TSet<FString>& InFieldList, TMap<FString, FString>& OutMemberMap)
 {
 	bool bResult = false;
 
@@ -712,31 +1926,55 @@ bool URedisClient::SRem(const FString& InKey, const TArray<FString>& InMemberLis
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "SREM " << TCHAR_TO_ANSI(*InKey);
-	for (auto &it : InMemberList)
+	CommandArgs.Reset().Add("HMGET").Add(InKey);
+	for (auto &it : InFieldList)
+	{
+		CommandArgs.Add(it);
+		OutMemberMap.Add(it);
+	}
+	if (!AppendCommandArgv(CommandArgs))
+	{
+		return bResult;
+	}
+
+	// Values come back in request order; point each position at its map slot
+	TArray<FString*> ValueSlots;
+	ValueSlots.Reserve(InFieldList.Num());
+	for (auto &it : InFieldList)
 	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it));
+		ValueSlots.Add(OutMemberMap.Find(it));
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
-	if (!RedisReplyPtr)
+	FRedisReplyDecoder Decoder(ValueSlots);
+	Decoder.bDecompress = true;
+	bResult = ReadDecoded(Decoder);
+
+	return bResult;
+}
+
+
+bool URedisClient::HGetAll(const FString& InKey, TMap<FString, FString>& OutMemberMap)
+{
+	bool bResult = false;
+
+	if (!RedisContextPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	if (!AppendCommandArgv(CommandArgs.Reset().Add("HGETALL").Add(InKey)))
 	{
-		bResult = true;
+		return bResult;
 	}
 
-	freeReplyObject(RedisReplyPtr);
-	RedisReplyPtr = nullptr;
+	FRedisReplyDecoder Decoder(OutMemberMap);
+	Decoder.bDecompress = true;
+	bResult = ReadDecoded(Decoder);
 
 	return bResult;
 }
 
-bool URedisClient::SMembers(const FString& InKey, TArray<FString>& OutMemberList)
+bool URedisClient::LIndex(const FString& InKey, int32 InIndex, FString& OutValue)
 {
 	bool bResult = false;
 
@@ -745,22 +1983,16 @@ bool URedisClient::SMembers(const FString& InKey, TArray<FString>& OutMemberList
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "SMEMBERS %s ", TCHAR_TO_ANSI(*InKey));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LINDEX").Add(InKey).Add(InIndex));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_ARRAY)
+	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
 	{
+		OutValue = FRedisReplyParser::ToString(RedisReplyPtr->str, RedisReplyPtr->len);
 		bResult = true;
-		for (auto i = 0; i < RedisReplyPtr->elements; i++)
-		{
-			if (RedisReplyPtr->element[i]->str != NULL)
-			{
-				OutMemberList.Add(RedisReplyPtr->element[i]->str);
-			}
-		}
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -769,7 +2001,7 @@ bool URedisClient::SMembers(const FString& InKey, TArray<FString>& OutMemberList
 	return bResult;
 }
 
-bool URedisClient::HSet(const FString& InKey, const FString& InField, const FString& InValue)
+bool URedisClient::LInsertBefore(const FString& InKey, const FString& Pivot, const FString& InValue)
 {
 	bool bResult = false;
 
@@ -778,7 +2010,7 @@ bool URedisClient::HSet(const FString& InKey, const FString& InField, const FStr
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "HSET %s %s %s", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*InField), TCHAR_TO_ANSI(*InValue));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LINSERT").Add(InKey).Add("BEFORE").Add(Pivot).Add(InValue));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -795,7 +2027,7 @@ bool URedisClient::HSet(const FString& InKey, const FString& InField, const FStr
 	return bResult;
 }
 
-bool URedisClient::HGet(const FString& InKey, const FString& InField, FString& OutValue)
+bool URedisClient::LInsertAfter(const FString& InKey, const FString& Pivot, const FString& InValue)
 {
 	bool bResult = false;
 
@@ -804,15 +2036,14 @@ bool URedisClient::HGet(const FString& InKey, const FString& InField, FString& O
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "HGET %s %s", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*InField));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LINSERT").Add(InKey).Add("AFTER").Add(Pivot).Add(InValue));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-	
-	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
+
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
 	{
-		OutValue = RedisReplyPtr->str;
 		bResult = true;
 	}
 
@@ -822,7 +2053,7 @@ bool URedisClient::HGet(const FString& InKey, const FString& InField, FString& O
 	return bResult;
 }
 
-bool URedisClient::HIncrby(const FString & InKey, const FString & InField, int32 Incre)
+bool URedisClient::LLen(const FString& InKey, int32& Len)
 {
 	bool bResult = false;
 
@@ -831,15 +2062,28 @@ bool URedisClient::HIncrby(const FString & InKey, const FString & InField, int32
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "HINCRBY %s %s %d", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*InField), Incre);
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LLEN").Add(InKey));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	switch (RedisReplyPtr->type)
 	{
-		bResult = true;
+		case REDIS_REPLY_INTEGER:
+			{
+				Len = RedisReplyPtr->integer;
+				bResult = true;
+			}
+			break;
+		case REDIS_REPLY_STRING:
+			{
+				Len = atoi(RedisReplyPtr->str);
+				bResult = true;
+			}
+			break;
+		default:
+			break;
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -848,9 +2092,7 @@ bool URedisClient::HIncrby(const FString & InKey, const FString & InField, int32
 	return bResult;
 }
 
-
-
-bool URedisClient::HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap)
+bool URedisClient::LPop(const FString& InKey, FString& OutValue)
 {
 	bool bResult = false;
 
@@ -859,21 +2101,14 @@ bool URedisClient::HMSet(const FString& InKey, const TMap<FString, FString>& InM
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "HMSET " << TCHAR_TO_ANSI(*InKey);
-	for (auto &it : InMemberMap)
-	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it.Key)) << " " << TCHAR_TO_ANSI(*(it.Value));
-	}
-
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LPOP").Add(InKey));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
 	{
+		OutValue = FRedisReplyParser::ToString(RedisReplyPtr->str, RedisReplyPtr->len);
 		bResult = true;
 	}
 
@@ -883,7 +2118,7 @@ bool URedisClient::HMSet(const FString& InKey, const TMap<FString, FString>& InM
 	return bResult;
 }
 
-bool URedisClient::HDel(const FString& InKey, const TArray<FString>& InFieldList)
+bool URedisClient::LPush(const FString& InKey, const TArray<FString>& InFieldList)
 {
 	bool bResult = false;
 
@@ -892,14 +2127,13 @@ bool URedisClient::HDel(const FString& InKey, const TArray<FString>& InFieldList
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "HDEL " << TCHAR_TO_ANSI(*InKey);
-	for (auto &it : InFieldList)
+	CommandArgs.Reset().Add("LPUSH").Add(InKey);
+	for (auto& it : InFieldList)
 	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it));
+		CommandArgs.Add(it);
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -916,8 +2150,7 @@ bool URedisClient::HDel(const FString& InKey, const TArray<FString>& InFieldList
 	return bResult;
 }
 
-
-bool URedisClient::HExists(const FString& InKey, const FString& InField)
+bool URedisClient::LRange(const FString& InKey, int32 Start, int32 End, TArray<FString>& OutMemberList)
 {
 	bool bResult = false;
 
@@ -926,24 +2159,18 @@ bool URedisClient::HExists(const FString& InKey, const FString& InField)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "HEXISTS %s %s", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*InField));
-	if (!RedisReplyPtr)
+	if (!AppendCommandArgv(CommandArgs.Reset().Add("LRANGE").Add(InKey).Add(Start).Add(End)))
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
-	{
-		bResult = (bool)RedisReplyPtr->integer;
-	}
-
-	freeReplyObject(RedisReplyPtr);
-	RedisReplyPtr = nullptr;
+	FRedisReplyDecoder Decoder(OutMemberList);
+	bResult = ReadDecoded(Decoder);
 
 	return bResult;
 }
 
-bool URedisClient::HMGet(const FString& InKey, const TSet<FString>& InFieldList, TMap<FString, FString>& OutMemberMap)
+bool URedisClient::LRem(const FString& InKey, const FString& InValue, int32 Count /*= 0*/)
 {
 	bool bResult = false;
 
@@ -952,37 +2179,14 @@ bool URedisClient::HMGet(const FString& InKey, const TSet<FString>& InFieldList,
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "HMGET " << TCHAR_TO_ANSI(*InKey);
-	for (auto &it : InFieldList)
-	{
-		redisCmd << " " << TCHAR_TO_ANSI(*it);
-		OutMemberMap.Add(it);
-	}
-
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LREM").Add(InKey).Add(Count).Add(InValue));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_ARRAY)
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
 	{
-		int i = 0;
-		for (auto &it : OutMemberMap)
-		{
-			if (i >= RedisReplyPtr->elements)
-			{
-				break;
-			}
-
-			if (RedisReplyPtr->element[i]->str != NULL)
-			{
-				it.Value = RedisReplyPtr->element[i]->str;
-			}
-
-			++i;
-		}
 		bResult = true;
 	}
 
@@ -992,8 +2196,7 @@ bool URedisClient::HMGet(const FString& InKey, const TSet<FString>& InFieldList,
 	return bResult;
 }
 
-
-bool URedisClient::HGetAll(const FString& InKey, TMap<FString, FString>& OutMemberMap)
+bool URedisClient::LSet(const FString& InKey, int32 InIndex, const FString& InValue)
 {
 	bool bResult = false;
 
@@ -1002,21 +2205,14 @@ bool URedisClient::HGetAll(const FString& InKey, TMap<FString, FString>& OutMemb
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "HGETALL %s", TCHAR_TO_ANSI(*InKey));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LSET").Add(InKey).Add(InIndex).Add(InValue));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_ARRAY)
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
 	{
-		for (auto i = 0; i < RedisReplyPtr->elements; i += 2)
-		{
-			if (RedisReplyPtr->element[i]->str != NULL && RedisReplyPtr->element[i + 1]->str != NULL)
-			{
-				OutMemberMap.Add(RedisReplyPtr->element[i]->str, RedisReplyPtr->element[i + 1]->str);
-			}
-		}
 		bResult = true;
 	}
 
@@ -1026,7 +2222,7 @@ bool URedisClient::HGetAll(const FString& InKey, TMap<FString, FString>& OutMemb
 	return bResult;
 }
 
-bool URedisClient::LIndex(const FString& InKey, int32 InIndex, FString& OutValue)
+bool URedisClient::LTrim(const FString& InKey, int32 Start, int32 Stop)
 {
 	bool bResult = false;
 
@@ -1035,15 +2231,14 @@ bool URedisClient::LIndex(const FString& InKey, int32 InIndex, FString& OutValue
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LINDEX %s %d", TCHAR_TO_ANSI(*InKey), InIndex);
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("LTRIM").Add(InKey).Add(Start).Add(Stop));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
+	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
 	{
-		OutValue = RedisReplyPtr->str;
 		bResult = true;
 	}
 
@@ -1053,7 +2248,7 @@ bool URedisClient::LIndex(const FString& InKey, int32 InIndex, FString& OutValue
 	return bResult;
 }
 
-bool URedisClient::LInsertBefore(const FString& InKey, const FString& Pivot, const FString& InValue)
+bool URedisClient::RPop(const FString& InKey, FString& OutValue)
 {
 	bool bResult = false;
 
@@ -1062,14 +2257,14 @@ bool URedisClient::LInsertBefore(const FString& InKey, const FString& Pivot, con
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LINSERT %s BEFORE %s %s", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*Pivot), TCHAR_TO_ANSI(*InValue));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("RPOP").Add(InKey));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
 	{
+		OutValue = FRedisReplyParser::ToString(RedisReplyPtr->str, RedisReplyPtr->len);
 		bResult = true;
 	}
 
@@ -1079,7 +2274,7 @@ bool URedisClient::LInsertBefore(const FString& InKey, const FString& Pivot, con
 	return bResult;
 }
 
-bool URedisClient::LInsertAfter(const FString& InKey, const FString& Pivot, const FString& InValue)
+bool URedisClient::RPush(const FString& InKey, const TArray<FString>& InFieldList)
 {
 	bool bResult = false;
 
@@ -1088,7 +2283,13 @@ bool URedisClient::LInsertAfter(const FString& InKey, const FString& Pivot, cons
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LINSERT %s AFTER %s %s", TCHAR_TO_ANSI(*InKey), TCHAR_TO_ANSI(*Pivot), TCHAR_TO_ANSI(*InValue));
+	CommandArgs.Reset().Add("RPUSH").Add(InKey);
+	for (auto& it : InFieldList)
+	{
+		CommandArgs.Add(it);
+	}
+
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
@@ -1105,64 +2306,130 @@ bool URedisClient::LInsertAfter(const FString& InKey, const FString& Pivot, cons
 	return bResult;
 }
 
-bool URedisClient::LLen(const FString& InKey, int32& Len)
+
+bool URedisClient::SetBytes(const FString& InKey, TArrayView<const uint8> InValue)
 {
-	bool bResult = false;
+	FRedisBinaryReply Reply;
+	return RedisContextPtr && CommandBinary(CommandArgs.Reset().Add("SET").Add(InKey).AddRaw(InValue.GetData(), InValue.Num()), Reply);
+}
+
+bool URedisClient::GetBytes(const FString& InKey, TArray<uint8>& OutValue)
+{
+	FRedisBinaryReply Reply;
+	return GetBytes(InKey, Reply) && CopyBytes(Reply, OutValue);
+}
+
+bool URedisClient::GetBytes(const FString& InKey, FRedisBinaryReply& OutValue)
+{
+	return RedisContextPtr && CommandBinary(CommandArgs.Reset().Add("GET").Add(InKey), OutValue);
+}
+
+bool URedisClient::HSetBytes(const FString& InKey, const FString& InField, TArrayView<const uint8> InValue)
+{
+	FRedisBinaryReply Reply;
+	return RedisContextPtr && CommandBinary(CommandArgs.Reset().Add("HSET").Add(InKey).Add(InField).AddRaw(InValue.GetData(), InValue.Num()), Reply);
+}
+
+bool URedisClient::HGetBytes(const FString& InKey, const FString& InField, TArray<uint8>& OutValue)
+{
+	FRedisBinaryReply Reply;
+	return HGetBytes(InKey, InField, Reply) && CopyBytes(Reply, OutValue);
+}
 
+bool URedisClient::HGetBytes(const FString& InKey, const FString& InField, FRedisBinaryReply& OutValue)
+{
+	return RedisContextPtr && CommandBinary(CommandArgs.Reset().Add("HGET").Add(InKey).Add(InField), OutValue);
+}
+
+bool URedisClient::MGetBytes(const TArray<FString>& InKeyList, FRedisBinaryReply& OutValues)
+{
 	if (!RedisContextPtr)
 	{
-		return bResult;
+		return false;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LLEN %s", TCHAR_TO_ANSI(*InKey));
-	if (!RedisReplyPtr)
+	CommandArgs.Reset().Add("MGET");
+	for (auto& it : InKeyList)
 	{
-		return bResult;
+		CommandArgs.Add(it);
 	}
+	return CommandBinary(CommandArgs, OutValues);
+}
 
-	switch (RedisReplyPtr->type)
+bool URedisClient::HGetAllBytes(const FString& InKey, FRedisBinaryReply& OutValues)
+{
+	return RedisContextPtr && CommandBinary(CommandArgs.Reset().Add("HGETALL").Add(InKey), OutValues);
+}
+
+bool URedisClient::PublishBytes(const FString& InChannel, TArrayView<const uint8> InMessage)
+{
+	FRedisBinaryReply Reply;
+	return RedisContextPtr && CommandBinary(CommandArgs.Reset().Add("PUBLISH").Add(InChannel).AddRaw(InMessage.GetData(), InMessage.Num()), Reply);
+}
+
+bool URedisClient::CommandBinary(FRedisCommandArgs& InArgs, FRedisBinaryReply& OutReply)
+{
+	redisReply* Reply = CommandArgv(InArgs);
+	if (!Reply)
 	{
-		case REDIS_REPLY_INTEGER:
-			{
-				Len = RedisReplyPtr->integer;
-				bResult = true;
-			}
-			break;
-		case REDIS_REPLY_STRING:
-			{
-				Len = atoi(RedisReplyPtr->str);
-				bResult = true;
-			}
-			break;
-		default:
-			break;
+		OutReply.Reset();
+		return false;
 	}
 
-	freeReplyObject(RedisReplyPtr);
-	RedisReplyPtr = nullptr;
-
+	const bool bResult = Reply->type != REDIS_REPLY_ERROR;
+	OutReply.Reset(Reply);
 	return bResult;
 }
 
-bool URedisClient::LPop(const FString& InKey, FString& OutValue)
+bool URedisClient::CopyBytes(const FRedisBinaryReply& InReply, TArray<uint8>& OutValue)
+{
+	if (!InReply.IsValid())
+	{
+		return false;
+	}
+
+	TArrayView<const uint8> Value = InReply.Get();
+	OutValue.SetNumUninitialized(Value.Num(), false);
+	if (Value.Num())
+	{
+		FMemory::Memcpy(OutValue.GetData(), Value.GetData(), Value.Num());
+	}
+	return true;
+}
+
+bool URedisClient::BPop(ERedisListEnd InFrom, const TArray<FString>& InKeys, float InTimeout, FString& OutKey, FString& OutValue, bool& bOutPopped)
 {
 	bool bResult = false;
+	bOutPopped = false;
 
 	if (!RedisContextPtr)
 	{
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LPOP %s", TCHAR_TO_ANSI(*InKey));
+	CommandArgs.Reset().Add(InFrom == ERedisListEnd::Left ? "BLPOP" : "BRPOP");
+	for (auto& it : InKeys)
+	{
+		CommandArgs.Add(it);
+	}
+	CommandArgs.Add((double)InTimeout);
+
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
+
+	// [key, value], or nil on timeout
+	if (RedisReplyPtr->type == REDIS_REPLY_NIL)
 	{
-		OutValue = RedisReplyPtr->str;
 		bResult = true;
 	}
+	else if (RedisReplyPtr->type == REDIS_REPLY_ARRAY && RedisReplyPtr->elements == 2)
+	{
+		bResult = FRedisReplyParser::ParseString(RedisReplyPtr->element[0], OutKey) && FRedisReplyParser::ParseString(RedisReplyPtr->element[1], OutValue);
+		bOutPopped = bResult;
+	}
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -1170,32 +2437,31 @@ bool URedisClient::LPop(const FString& InKey, FString& OutValue)
 	return bResult;
 }
 
-bool URedisClient::LPush(const FString& InKey, const TArray<FString>& InFieldList)
+bool URedisClient::BLMove(const FString& InSource, const FString& InDestination, ERedisListEnd InFrom, float InTimeout, FString& OutValue, bool& bOutMoved)
 {
 	bool bResult = false;
+	bOutMoved = false;
 
 	if (!RedisContextPtr)
 	{
 		return bResult;
 	}
 
-	std::ostringstream redisCmd;
-	redisCmd << "LPUSH " << TCHAR_TO_ANSI(*InKey);
-	for (auto& it : InFieldList)
-	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it));
-	}
-
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("BLMOVE").Add(InSource).Add(InDestination).Add(InFrom == ERedisListEnd::Left ? "LEFT" : "RIGHT").Add("LEFT").Add((double)InTimeout));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	if (RedisReplyPtr->type == REDIS_REPLY_NIL)
 	{
 		bResult = true;
 	}
+	else
+	{
+		bResult = FRedisReplyParser::ParseString(RedisReplyPtr, OutValue);
+		bOutMoved = bResult;
+	}
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -1203,40 +2469,43 @@ bool URedisClient::LPush(const FString& InKey, const TArray<FString>& InFieldLis
 	return bResult;
 }
 
-bool URedisClient::LRange(const FString& InKey, int32 Start, int32 End, TArray<FString>& OutMemberList)
+bool URedisClient::XAdd(const FString& InKey, const TArray<FRedisStreamEntry>& InEntries, int32 InMaxLen, TArray<FString>& OutIds)
 {
-	bool bResult = false;
-
 	if (!RedisContextPtr)
 	{
-		return bResult;
+		return false;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LRANGE %s %d %d", TCHAR_TO_ANSI(*InKey), Start, End);
-	if (!RedisReplyPtr)
+	TArray<FRedisCommandArgs> Commands;
+	Commands.SetNum(InEntries.Num());
+	TArray<FRedisCommandArgs*> CommandPtrs;
+	CommandPtrs.Reserve(InEntries.Num());
+	for (int32 i = 0; i < InEntries.Num(); ++i)
 	{
-		return bResult;
+		BuildXAddCommand(Commands[i], InKey, InEntries[i], InMaxLen);
+		CommandPtrs.Add(&Commands[i]);
 	}
 
-	if (RedisReplyPtr->type == REDIS_REPLY_ARRAY)
+	bool bResult = true;
+	// One slot per entry, left empty for the ones that failed, so OutIds[i] is always InEntries[i]
+	OutIds.Reset();
+	OutIds.SetNum(InEntries.Num());
+	ExecBatch(CommandPtrs, [this, &bResult, &OutIds](int32 Index, const redisReply* Reply)
 	{
-		bResult = true;
-		for (auto i = 0; i < RedisReplyPtr->elements; i++)
+		if (FRedisReplyParser::ParseString(Reply, OutIds[Index]))
 		{
-			if (RedisReplyPtr->element[i]->str != NULL)
-			{
-				OutMemberList.Add(RedisReplyPtr->element[i]->str);
-			}
+			return;
 		}
-	}
-
-	freeReplyObject(RedisReplyPtr);
-	RedisReplyPtr = nullptr;
-
+		if (Reply && Reply->type == REDIS_REPLY_ERROR)
+		{
+			LastError = FRedisReplyParser::ToString(Reply->str, Reply->len);
+		}
+		bResult = false;
+	});
 	return bResult;
 }
 
-bool URedisClient::LRem(const FString& InKey, const FString& InValue, int32 Count /*= 0*/)
+bool URedisClient::XGroupCreate(const FString& InKey, const FString& InGroup, const FString& InStartId)
 {
 	bool bResult = false;
 
@@ -1245,16 +2514,13 @@ bool URedisClient::LRem(const FString& InKey, const FString& InValue, int32 Coun
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LREM %s %d %s", TCHAR_TO_ANSI(*InKey), Count, TCHAR_TO_ANSI(*InValue));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("XGROUP").Add("CREATE").Add(InKey).Add(InGroup).Add(InStartId).Add("MKSTREAM"));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-	}
+	bResult = RedisReplyPtr->type != REDIS_REPLY_ERROR || FCStringAnsi::Strncmp(RedisReplyPtr->str, "BUSYGROUP", 9) == 0;
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -1262,33 +2528,45 @@ bool URedisClient::LRem(const FString& InKey, const FString& InValue, int32 Coun
 	return bResult;
 }
 
-bool URedisClient::LSet(const FString& InKey, int32 InIndex, const FString& InValue)
+bool URedisClient::XReadGroup(const FString& InGroup, const FString& InConsumer, const TArray<FString>& InKeys, const TArray<FString>& InIds, int32 InCount, int32 InBlockMs, TMap<FString, TArray<FRedisStreamEntry>>& OutEntries)
 {
 	bool bResult = false;
 
-	if (!RedisContextPtr)
+	if (!RedisContextPtr || InKeys.Num() != InIds.Num())
 	{
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LSET %s %d %s", TCHAR_TO_ANSI(*InKey), InIndex, TCHAR_TO_ANSI(*InValue));
-	if (!RedisReplyPtr)
+	CommandArgs.Reset().Add("XREADGROUP").Add("GROUP").Add(InGroup).Add(InConsumer).Add("COUNT").Add(InCount);
+	if (InBlockMs >= 0)
 	{
-		return bResult;
+		CommandArgs.Add("BLOCK").Add(InBlockMs);
+	}
+	CommandArgs.Add("STREAMS");
+	for (auto& it : InKeys)
+	{
+		CommandArgs.Add(it);
+	}
+	for (auto& it : InIds)
+	{
+		CommandArgs.Add(it);
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	RedisReplyPtr = CommandArgv(CommandArgs);
+	if (!RedisReplyPtr)
 	{
-		bResult = true;
+		return bResult;
 	}
 
+	bResult = FRedisReplyParser::ParseStreamRead(RedisReplyPtr, OutEntries);
+
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
 
 	return bResult;
 }
 
-bool URedisClient::LTrim(const FString& InKey, int32 Start, int32 Stop)
+bool URedisClient::XAck(const FString& InKey, const FString& InGroup, const TArray<FString>& InIds, int32& OutAcked)
 {
 	bool bResult = false;
 
@@ -1297,16 +2575,14 @@ bool URedisClient::LTrim(const FString& InKey, int32 Start, int32 Stop)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "LTRIM %s %d %d", TCHAR_TO_ANSI(*InKey), Start, Stop);
+	BuildXAckCommand(CommandArgs, InKey, InGroup, InIds);
+	RedisReplyPtr = CommandArgv(CommandArgs);
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
 
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
-	{
-		bResult = true;
-	}
+	bResult = FRedisReplyParser::ParseInt(RedisReplyPtr, OutAcked);
 
 	freeReplyObject(RedisReplyPtr);
 	RedisReplyPtr = nullptr;
@@ -1314,7 +2590,7 @@ bool URedisClient::LTrim(const FString& InKey, int32 Start, int32 Stop)
 	return bResult;
 }
 
-bool URedisClient::RPop(const FString& InKey, FString& OutValue)
+bool URedisClient::XAutoClaim(const FString& InKey, const FString& InGroup, const FString& InConsumer, int32 InMinIdleMs, FString& InOutCursor, int32 InCount, TArray<FRedisStreamEntry>& OutEntries)
 {
 	bool bResult = false;
 
@@ -1323,15 +2599,17 @@ bool URedisClient::RPop(const FString& InKey, FString& OutValue)
 		return bResult;
 	}
 
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, "RPOP %s", TCHAR_TO_ANSI(*InKey));
+	RedisReplyPtr = CommandArgv(CommandArgs.Reset().Add("XAUTOCLAIM").Add(InKey).Add(InGroup).Add(InConsumer).Add(InMinIdleMs).Add(InOutCursor).Add("COUNT").Add(InCount));
 	if (!RedisReplyPtr)
 	{
 		return bResult;
 	}
-	if (RedisReplyPtr->type == REDIS_REPLY_STRING)
+
+	// [next-cursor, entries] and, since Redis 7, [..., deleted-ids]
+	if (RedisReplyPtr->type == REDIS_REPLY_ARRAY && RedisReplyPtr->elements >= 2 && RedisReplyPtr->element[0]->type == REDIS_REPLY_STRING)
 	{
-		OutValue = RedisReplyPtr->str;
-		bResult = true;
+		InOutCursor = FRedisReplyParser::ToString(RedisReplyPtr->element[0]->str, RedisReplyPtr->element[0]->len);
+		bResult = FRedisReplyParser::ParseStreamEntries(RedisReplyPtr->element[1], OutEntries);
 	}
 
 	freeReplyObject(RedisReplyPtr);
@@ -1340,36 +2618,32 @@ bool URedisClient::RPop(const FString& InKey, FString& OutValue)
 	return bResult;
 }
 
-bool URedisClient::RPush(const FString& InKey, const TArray<FString>& InFieldList)
+void URedisClient::BuildXAddCommand(FRedisCommandArgs& OutArgs, const FString& InKey, const FRedisStreamEntry& InEntry, int32 InMaxLen)
 {
-	bool bResult = false;
-
-	if (!RedisContextPtr)
+	OutArgs.Reset().Add("XADD").Add(InKey);
+	if (InMaxLen > 0)
 	{
-		return bResult;
+		OutArgs.Add("MAXLEN").Add("~").Add(InMaxLen);
 	}
-
-	std::ostringstream redisCmd;
-	redisCmd << "RPUSH " << TCHAR_TO_ANSI(*InKey);
-	for (auto& it : InFieldList)
+	if (InEntry.Id.IsEmpty())
 	{
-		redisCmd << " " << TCHAR_TO_ANSI(*(it));
+		OutArgs.Add("*");
 	}
-
-	RedisReplyPtr = (redisReply*)redisCommand(RedisContextPtr, redisCmd.str().c_str());
-	if (!RedisReplyPtr)
+	else
 	{
-		return bResult;
+		OutArgs.Add(InEntry.Id);
 	}
-
-	if (RedisReplyPtr->type != REDIS_REPLY_ERROR)
+	for (auto& it : InEntry.Fields)
 	{
-		bResult = true;
+		OutArgs.Add(it.Key).Add(it.Value);
 	}
-
-	freeReplyObject(RedisReplyPtr);
-	RedisReplyPtr = nullptr;
-
-	return bResult;
 }
 
+void URedisClient::BuildXAckCommand(FRedisCommandArgs& OutArgs, const FString& InKey, const FString& InGroup, const TArray<FString>& InIds)
+{
+	OutArgs.Reset().Add("XACK").Add(InKey).Add(InGroup);
+	for (auto& it : InIds)
+	{
+		OutArgs.Add(it);
+	}
+}
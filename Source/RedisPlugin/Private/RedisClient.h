@@ -3,9 +3,24 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "RedisCommandArgs.h"
 
 struct redisContext;
 struct redisReply;
+struct FRedisReply;
+struct FRedisScoredMember;
+struct FRedisStreamEntry;
+class FRedisPipeline;
+class FRedisBinaryReply;
+class URedisScript;
+class FRedisTransaction;
+class FRedisReplyDecoder;
+class FRedisStructLayout;
+class FRedisCompressionDictionary;
+struct FRedisSlotRange;
+enum class ERedisScanType : uint8;
+enum class ERedisZAddFlag : uint8;
+enum class ERedisListEnd : uint8;
 
 /**
  * 
@@ -19,16 +34,95 @@ public:
 	~URedisClient();
 
 	/* Connect */
-	bool ConnectToRedis(const FString& InHost, int32 InPort, const FString& InPassword);
+	/** InHost is a hostname/IP, or unix:///path/to/redis.sock for a local socket (InPort is then ignored). */
+	bool ConnectToRedis(const FString& InHost, int32 InPort, const FString& InPassword, float InTimeout = 1.f);
+
+	/** Extracts the socket path from a unix:// host string. */
+	static bool ParseUnixSocketHost(const FString& InHost, FString& OutPath);
+
+	/**
+	 * Opens a blocking hiredis connection to InHost the way ConnectToRedis does, for code that
+	 * drives the context itself. May come back with err set; null if it could not even start.
+	 * unix:// hosts are not supported on Windows.
+	 */
+	static redisContext* ConnectContext(const FString& InHost, int32 InPort, float InTimeout);
 
 	void DisconnectRedis();
 
+	/** Seconds a reply may take before the connection is given up, 0 for no limit. Blocking commands need more than their own timeout. */
+	bool SetReadTimeout(float InTimeout);
+
+	/** Cycles the caller waited to get this connection, counted as queue time of the next command. */
+	void SetQueueCycles(uint64 InCycles)
+	{
+		QueueCycles = InCycles;
+	}
+
 	void Quit();
 
+	/** False once the context is gone or hiredis flagged an I/O or protocol error on it. */
+	bool IsConnected() const;
+
+	bool Ping();
+
 	bool SelectIndex(int32 InIndex);
 
+	int32 GetDbIndex() const
+	{
+		return DbIndex;
+	}
+
+	const FString& GetHost() const
+	{
+		return Host;
+	}
+
+	int32 GetPort() const
+	{
+		return Port;
+	}
+
 	bool ExecCommand(const FString& InCommand);
 
+	/** Text of the last error reply seen on this connection, e.g. a MOVED redirect. */
+	const FString& GetLastError() const
+	{
+		return LastError;
+	}
+
+	void ClearLastError()
+	{
+		LastError.Reset();
+	}
+
+	/* Pipeline */
+	bool ExecPipeline(const FRedisPipeline& InPipeline, TArray<FRedisReply>& OutReplies);
+
+	/**
+	 * Writes every command in one batch and hands the raw replies to InOnReply in order.
+	 * InOnReply runs exactly once per command, with a null reply for those lost to a broken connection.
+	 */
+	bool ExecBatch(const TArray<FRedisCommandArgs*>& InCommands, TFunctionRef<void(int32, const redisReply*)> InOnReply);
+
+	/* Cluster */
+	bool ClusterSlots(TArray<FRedisSlotRange>& OutRanges);
+
+	/** Lets the next command touch a slot that is being imported into this node. */
+	bool Asking();
+
+	/* Transaction */
+	/** Runs the transaction on this connection, retrying while EXEC comes back nil. */
+	bool ExecTransaction(const FRedisTransaction& InTransaction, TArray<FRedisReply>& OutReplies);
+
+	/* Script */
+	/** SCRIPT LOAD; false if the server reports a different SHA1 than the one computed locally. */
+	bool ScriptLoad(const URedisScript& InScript);
+
+	/** EVALSHA, falling back to EVAL when the server answers NOSCRIPT. */
+	bool EvalScript(const URedisScript& InScript, const TArray<FString>& InKeys, const TArray<FString>& InArgs, FRedisReply& OutReply);
+
+	static void BuildEvalCommand(FRedisCommandArgs& OutArgs, const URedisScript& InScript, bool bBySha, const TArray<FString>& InKeys, const TArray<FString>& InArgs);
+
 	/* Pub/Sub */
 	bool Subscribe(const FString& InChannel);
 
@@ -67,11 +161,68 @@ public:
 
 	bool SetStr(const FString& InKey, const FString& InValue);
 
+	/** Decompresses values written compressed (see FRedisCompression). */
 	bool GetStr(const FString& InKey, FString& OutValue);
 
 	bool Append(const FString& InKey, const FString& InValue);
 
-	/* Sorted Set */ // todo
+	/* Binary */
+	/** Values are written byte for byte, with no FString or UTF-8 conversion in between. */
+	bool SetBytes(const FString& InKey, TArrayView<const uint8> InValue);
+
+	/** Copies into OutValue, reusing its allocation. False for a missing key. */
+	bool GetBytes(const FString& InKey, TArray<uint8>& OutValue);
+
+	/** Hands over the reply itself, so the value is never copied. */
+	bool GetBytes(const FString& InKey, FRedisBinaryReply& OutValue);
+
+	bool HSetBytes(const FString& InKey, const FString& InField, TArrayView<const uint8> InValue);
+
+	bool HGetBytes(const FString& InKey, const FString& InField, TArray<uint8>& OutValue);
+
+	bool HGetBytes(const FString& InKey, const FString& InField, FRedisBinaryReply& OutValue);
+
+	/** One value per key, missing keys included (see FRedisBinaryReply::IsValid). */
+	bool MGetBytes(const TArray<FString>& InKeyList, FRedisBinaryReply& OutValues);
+
+	/** Alternating fields and values. */
+	bool HGetAllBytes(const FString& InKey, FRedisBinaryReply& OutValues);
+
+	bool PublishBytes(const FString& InChannel, TArrayView<const uint8> InMessage);
+
+	/* Scan */
+	/** Fetches one page and advances InOutCursor; the walk is complete once it comes back as "0". */
+	bool Scan(ERedisScanType InType, const FString& InKey, FString& InOutCursor, const FString& InMatch, int32 InCount, TArray<FString>& OutElements);
+
+	static void BuildScanCommand(FRedisCommandArgs& OutArgs, ERedisScanType InType, const FString& InKey, const FString& InCursor, const FString& InMatch, int32 InCount);
+
+	/* Sorted Set */
+	bool ZAdd(const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag, int32& OutAdded);
+
+	bool ZIncrby(const FString& InKey, const FString& InMember, double Incre, double& OutScore);
+
+	/** WITHSCORES, by rank. */
+	bool ZRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList);
+
+	bool ZRevRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList);
+
+	/** WITHSCORES, Min/Max inclusive; Count <= 0 returns everything from Offset on. */
+	bool ZRangeByScore(const FString& InKey, double Min, double Max, int32 Offset, int32 Count, TArray<FRedisScoredMember>& OutMemberList);
+
+	/** False when the member does not exist. */
+	bool ZRank(const FString& InKey, const FString& InMember, int32& OutRank);
+
+	/** False when the member does not exist. */
+	bool ZScore(const FString& InKey, const FString& InMember, double& OutScore);
+
+	/** Members without a score are left out of OutMemberList. Needs Redis 6.2 or later. */
+	bool ZMScore(const FString& InKey, const TArray<FString>& InMemberList, TArray<FRedisScoredMember>& OutMemberList);
+
+	bool ZRem(const FString& InKey, const TArray<FString>& InMemberList);
+
+	static void BuildZAddCommand(FRedisCommandArgs& OutArgs, const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag);
+
+	static void BuildZRangeByScoreCommand(FRedisCommandArgs& OutArgs, const FString& InKey, double Min, double Max, int32 Offset, int32 Count);
 
 	/* Set */
 	bool SAdd(const FString& InKey, const TArray<FString>& InMemberList);
@@ -89,7 +240,8 @@ public:
 
 	bool HIncrby(const FString& InKey, const FString& Field, int32 Incre);
 
-	bool HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap);
+	/** Values of at least InThreshold characters are compressed against InDictionary, when given. */
+	bool HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap, const FRedisCompressionDictionary* InDictionary = nullptr, int32 InThreshold = 0);
 
 	bool HDel(const FString& InKey, const TArray<FString>& InFieldList);
 
@@ -97,7 +249,14 @@ public:
 
 	bool HMGet(const FString& InKey, const TSet<FString>& InFieldList, TMap<FString, FString>& OutMemberMap);
 
+	/** Like HMGet and HGet, decompresses values written compressed (see FRedisCompression). */
 	bool HGetAll(const FString& InKey, TMap<FString, FString>& OutMemberMap);
+
+	/** HSET of InData's fields (only the dirty ones with a baseline); true with no round trip when none are. */
+	bool HSetStruct(const FString& InKey, const FRedisStructLayout& InLayout, const void* InData, const void* InBaseline);
+
+	/** HMGET decoded straight into OutData; fields missing from the hash keep their value. */
+	bool HGetStruct(const FString& InKey, const FRedisStructLayout& InLayout, void* OutData);
 	
 	/* List */
 	bool LIndex(const FString& InKey, int32 InIndex, FString& OutValue);
@@ -124,11 +283,90 @@ public:
 
 	bool RPush(const FString& InKey, const TArray<FString>& InFieldList);
 
+	/** BLPOP/BRPOP over InKeys. Nothing to pop within InTimeout is success with bOutPopped false. */
+	bool BPop(ERedisListEnd InFrom, const TArray<FString>& InKeys, float InTimeout, FString& OutKey, FString& OutValue, bool& bOutPopped);
+
+	/** BLMOVE into the head of InDestination. Nothing to move within InTimeout is success with bOutMoved false. Needs Redis 6.2. */
+	bool BLMove(const FString& InSource, const FString& InDestination, ERedisListEnd InFrom, float InTimeout, FString& OutValue, bool& bOutMoved);
+
+	/* Stream */
+	/** One XADD per entry, written as a single batch. OutIds[i] is the id of InEntries[i], empty if that one failed. */
+	bool XAdd(const FString& InKey, const TArray<FRedisStreamEntry>& InEntries, int32 InMaxLen, TArray<FString>& OutIds);
+
+	/** XGROUP CREATE ... MKSTREAM; a group that already exists counts as created. */
+	bool XGroupCreate(const FString& InKey, const FString& InGroup, const FString& InStartId);
+
+	/**
+	 * XREADGROUP with one id per key: ">" for entries never delivered to the group, or an id
+	 * to re-read this consumer's pending entries after it. Nothing arriving within InBlockMs is success.
+	 */
+	bool XReadGroup(const FString& InGroup, const FString& InConsumer, const TArray<FString>& InKeys, const TArray<FString>& InIds, int32 InCount, int32 InBlockMs, TMap<FString, TArray<FRedisStreamEntry>>& OutEntries);
+
+	/** Acknowledges every id in one XACK. */
+	bool XAck(const FString& InKey, const FString& InGroup, const TArray<FString>& InIds, int32& OutAcked);
+
+	/**
+	 * Moves up to InCount entries pending for longer than InMinIdleMs to InConsumer. Start with
+	 * InOutCursor "0-0"; it comes back "0-0" once the whole pending list was walked. Needs Redis 6.2 or later.
+	 */
+	bool XAutoClaim(const FString& InKey, const FString& InGroup, const FString& InConsumer, int32 InMinIdleMs, FString& InOutCursor, int32 InCount, TArray<FRedisStreamEntry>& OutEntries);
+
+	/** InMaxLen > 0 trims with MAXLEN ~, letting the server cut whole nodes only. */
+	static void BuildXAddCommand(FRedisCommandArgs& OutArgs, const FString& InKey, const FRedisStreamEntry& InEntry, int32 InMaxLen);
+
+	static void BuildXAckCommand(FRedisCommandArgs& OutArgs, const FString& InKey, const FString& InGroup, const TArray<FString>& InIds);
+
+private:
+	/** Send one command and block for its reply. */
+	redisReply* CommandArgv(FRedisCommandArgs& InArgs);
+
+	/** Queue one command in the output buffer without waiting for a reply. */
+	bool AppendCommandArgv(FRedisCommandArgs& InArgs);
+
+	bool AppendPipeline(const FRedisPipeline& InPipeline);
+
+	/** Reads the next pending reply into OutReply (if given). False once the connection is broken. */
+	bool ReadReply(FRedisReply* OutReply);
+
+	/** Runs InArgs and moves the reply into OutReply; false on a broken connection or an error reply. */
+	bool CommandBinary(FRedisCommandArgs& InArgs, FRedisBinaryReply& OutReply);
+
+	static bool CopyBytes(const FRedisBinaryReply& InReply, TArray<uint8>& OutValue);
+
+	/** InDecoder.Read, keeping the error text for GetLastError. */
+	bool ReadDecoded(FRedisReplyDecoder& InDecoder);
+
+	/** redisGetReply into RedisReplyPtr; false once the connection is broken. */
+	bool GetReply();
+
+	/** Records the latency of the oldest appended command, now answered; returns its FRedisStats id. */
+	uint64 PopPendingTiming();
+
+	/** The connection broke: every appended command ends without a reply. */
+	void FailPendingTimings();
+
 private:
 	redisContext*	RedisContextPtr;
 	redisReply*		RedisReplyPtr;
 	FString			Password;
 	FString			Host;
 	uint16			Port;
+	int32			DbIndex;
 	bool			bSubscribed;
+	FString			LastError;
+
+	/** Reused by every command on this connection. */
+	FRedisCommandArgs CommandArgs;
+
+	struct FPendingTiming
+	{
+		int32	Command;
+		uint64	Cycles;
+		uint64	TraceId;
+	};
+
+	/** Commands appended and not answered yet, oldest at PendingTimingHead; replies come back in order. */
+	TArray<FPendingTiming>	PendingTimings;
+	int32					PendingTimingHead;
+	uint64					QueueCycles;
 };
@@ -0,0 +1,969 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisCluster.h"
+#include "RedisClient.h"
+#include "RedisConnectionPool.h"
+#include "RedisAsyncEngine.h"
+#include "RedisReplyParser.h"
+#include "RedisCompression.h"
+#include "RedisPipeline.h"
+#include "AsyncRedisDefines.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+/** Minimum seconds between two CLUSTER SLOTS refreshes triggered by MOVED. */
+static const double RedisClusterRefreshInterval = 1.0;
+
+/** Murmur3 finalizer: spreads CRC32s of near-identical ring point names over the whole ring. */
+static uint32 RedisMix32(uint32 InHash)
+{
+	InHash ^= InHash >> 16;
+	InHash *= 0x85ebca6b;
+	InHash ^= InHash >> 13;
+	InHash *= 0xc2b2ae35;
+	InHash ^= InHash >> 16;
+	return InHash;
+}
+
+/** CRC16-CCITT (XMODEM), the variant Redis Cluster hashes keys with. */
+static uint16 RedisCrc16(const ANSICHAR* InData, int32 InLen)
+{
+	struct FCrc16Table
+	{
+		uint16 Entries[256];
+
+		FCrc16Table()
+		{
+			for (int32 i = 0; i < 256; ++i)
+			{
+				uint16 Crc = (uint16)(i << 8);
+				for (int32 Bit = 0; Bit < 8; ++Bit)
+				{
+					Crc = (Crc & 0x8000) ? (uint16)((Crc << 1) ^ 0x1021) : (uint16)(Crc << 1);
+				}
+				Entries[i] = Crc;
+			}
+		}
+	};
+	static const FCrc16Table Table;
+
+	uint16 Crc = 0;
+	for (int32 i = 0; i < InLen; ++i)
+	{
+		Crc = (uint16)((Crc << 8) ^ Table.Entries[((Crc >> 8) ^ (uint8)InData[i]) & 0xFF]);
+	}
+	return Crc;
+}
+
+FRedisCluster::FRedisCluster() :
+	MinPoolSize(2),
+	MaxPoolSize(16),
+	PoolIdleTimeout(60.f),
+	PoolValidateAfter(10.f),
+	AsyncConnectionNum(2),
+	SeedPort(0),
+	bShutdown(false),
+	NextRefreshTime(0.0)
+{
+	SlotNodes.Init(INDEX_NONE, SlotCount);
+}
+
+FRedisCluster::~FRedisCluster()
+{
+	Shutdown();
+}
+
+uint16 FRedisCluster::KeySlot(const FString& InKey)
+{
+	FTCHARToUTF8 KeyUtf8(*InKey, InKey.Len());
+	return KeySlot((const ANSICHAR*)KeyUtf8.Get(), KeyUtf8.Length());
+}
+
+uint16 FRedisCluster::KeySlot(const ANSICHAR* InKey, int32 InLen)
+{
+	// Only the part between the first '{' and the next '}' is hashed, if it is not empty
+	int32 Open = 0;
+	while (Open < InLen && InKey[Open] != '{')
+	{
+		++Open;
+	}
+	if (Open < InLen)
+	{
+		int32 Close = Open + 1;
+		while (Close < InLen && InKey[Close] != '}')
+		{
+			++Close;
+		}
+		if (Close < InLen && Close > Open + 1)
+		{
+			return RedisCrc16(InKey + Open + 1, Close - Open - 1) & (SlotCount - 1);
+		}
+	}
+	return RedisCrc16(InKey, InLen) & (SlotCount - 1);
+}
+
+bool FRedisCluster::ParseRedirect(const FString& InError, FRedisRedirect& OutRedirect)
+{
+	TArray<FString> Tokens;
+	InError.ParseIntoArrayWS(Tokens);
+	if (Tokens.Num() != 3)
+	{
+		return false;
+	}
+
+	if (Tokens[0] == TEXT("MOVED"))
+	{
+		OutRedirect.bAsk = false;
+	}
+	else if (Tokens[0] == TEXT("ASK"))
+	{
+		OutRedirect.bAsk = true;
+	}
+	else
+	{
+		return false;
+	}
+
+	// IPv6 addresses contain colons too, the port is after the last one
+	int32 Colon = INDEX_NONE;
+	if (!Tokens[2].FindLastChar(TEXT(':'), Colon))
+	{
+		return false;
+	}
+
+	OutRedirect.Slot = FCString::Atoi(*Tokens[1]);
+	OutRedirect.Host = Tokens[2].Left(Colon);
+	OutRedirect.Port = FCString::Atoi(*Tokens[2] + Colon + 1);
+	return OutRedirect.Slot >= 0 && OutRedirect.Slot < SlotCount && OutRedirect.Port > 0;
+}
+
+bool FRedisCluster::ParseRedirect(const redisReply* InReply, FRedisRedirect& OutRedirect)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ERROR || InReply->len < 4)
+	{
+		return false;
+	}
+	if (FCStringAnsi::Strncmp(InReply->str, "MOVED ", 6) != 0 && FCStringAnsi::Strncmp(InReply->str, "ASK ", 4) != 0)
+	{
+		return false;
+	}
+	return ParseRedirect(FRedisReplyParser::ToString(InReply->str, InReply->len), OutRedirect);
+}
+
+FString FRedisCluster::GetCommandKey(const FString* InArgs, int32 InArgCount)
+{
+	if (InArgCount < 2)
+	{
+		return FString();
+	}
+
+	// EVAL script|sha numkeys key...
+	if (InArgs[0].Equals(TEXT("EVALSHA"), ESearchCase::IgnoreCase) || InArgs[0].Equals(TEXT("EVAL"), ESearchCase::IgnoreCase))
+	{
+		return InArgCount > 3 && FCString::Atoi(*InArgs[2]) > 0 ? InArgs[3] : FString();
+	}
+	return InArgs[1];
+}
+
+void FRedisCluster::GroupBySlot(const TArray<FString>& InKeyList, TMap<uint16, TArray<int32>>& OutGroups)
+{
+	for (int32 i = 0; i < InKeyList.Num(); ++i)
+	{
+		OutGroups.FindOrAdd(KeySlot(InKeyList[i])).Add(i);
+	}
+}
+
+bool FRedisCluster::Init(const FString& InHost, int32 InPort, const FString& InPassword)
+{
+	SeedHost = InHost;
+	SeedPort = InPort;
+	Password = InPassword;
+
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_Write);
+		bShutdown = false;
+	}
+
+	if (!RefreshSlots())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis cluster topology could not be read from %s:%d"), *SeedHost, SeedPort);
+		return false;
+	}
+	return true;
+}
+
+bool FRedisCluster::InitSharded(const TArray<FString>& InShards, const FString& InPassword, int32 InVirtualNodes)
+{
+	Password = InPassword;
+	if (InShards.Num() == 0)
+	{
+		return false;
+	}
+
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_Write);
+		bShutdown = false;
+	}
+
+	TArray<FString> ShardHosts;
+	TArray<int32> ShardPorts;
+	for (const FString& it : InShards)
+	{
+		FString& ShardHost = ShardHosts.AddDefaulted_GetRef();
+		FString PortStr;
+		if (!it.Split(TEXT(":"), &ShardHost, &PortStr, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+		{
+			ShardHost = it;
+		}
+		ShardPorts.Add(PortStr.IsEmpty() ? 6379 : FCString::Atoi(*PortStr));
+	}
+	SeedHost = ShardHosts[0];
+	SeedPort = ShardPorts[0];
+
+	// Shards pre-warm their pools concurrently
+	TArray<FNodePtr> ShardNodes;
+	ShardNodes.SetNum(InShards.Num());
+	ParallelFor(InShards.Num(), [this, &ShardHosts, &ShardPorts, &ShardNodes](int32 Index)
+	{
+		ShardNodes[Index] = FindOrAddNode(ShardHosts[Index], ShardPorts[Index], true);
+	});
+
+	// Points depend only on the shard address, never on its position in the list
+	TArray<TPair<uint32, int16>> Ring;
+	const int32 PointNum = FMath::Max(InVirtualNodes, 1);
+	Ring.Reserve(InShards.Num() * PointNum);
+	for (int32 ShardIndex = 0; ShardIndex < InShards.Num(); ++ShardIndex)
+	{
+		int32 NodeIndex = INDEX_NONE;
+		{
+			FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+			NodeIndex = Nodes.Find(ShardNodes[ShardIndex]);
+		}
+		if (NodeIndex == INDEX_NONE)
+		{
+			continue;
+		}
+		for (int32 Point = 0; Point < PointNum; ++Point)
+		{
+			const FTCHARToUTF8 PointName(*FString::Printf(TEXT("%s:%d-%d"), *ShardHosts[ShardIndex], ShardPorts[ShardIndex], Point));
+			Ring.Emplace(RedisMix32(FCrc::MemCrc32(PointName.Get(), PointName.Length())), (int16)NodeIndex);
+		}
+	}
+	if (Ring.Num() == 0)
+	{
+		return false;
+	}
+	Ring.Sort([](const TPair<uint32, int16>& A, const TPair<uint32, int16>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	// Slots sit evenly spaced on the ring; each one belongs to the next point clockwise
+	TArray<int16> NewSlotNodes;
+	NewSlotNodes.SetNumUninitialized(SlotCount);
+	int32 RingIndex = 0;
+	for (int32 Slot = 0; Slot < SlotCount; ++Slot)
+	{
+		const uint32 Position = (uint32)Slot << 18;
+		while (RingIndex < Ring.Num() && Ring[RingIndex].Key < Position)
+		{
+			++RingIndex;
+		}
+		NewSlotNodes[Slot] = Ring[RingIndex < Ring.Num() ? RingIndex : 0].Value;
+	}
+
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_Write);
+		SlotNodes = MoveTemp(NewSlotNodes);
+	}
+	return true;
+}
+
+void FRedisCluster::Shutdown()
+{
+	TArray<FNodePtr> Closing;
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_Write);
+		bShutdown = true;
+		Closing = MoveTemp(Nodes);
+		Nodes.Reset();
+		SlotNodes.Init(INDEX_NONE, SlotCount);
+	}
+
+	while (bRefreshing)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	for (auto& Node : Closing)
+	{
+		if (Node->Engine.IsValid())
+		{
+			Node->Engine->Shutdown();
+		}
+		Node->Pool->Shutdown();
+	}
+}
+
+void FRedisCluster::Tick()
+{
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+		for (auto& Node : Nodes)
+		{
+			Node->Pool->ReapIdle();
+		}
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (bRefreshPending && !bRefreshing && Now >= NextRefreshTime)
+	{
+		bRefreshPending = false;
+		bRefreshing = true;
+		NextRefreshTime = Now + RedisClusterRefreshInterval;
+
+		TSharedRef<FRedisCluster, ESPMode::ThreadSafe> Self = AsShared();
+		Async(EAsyncExecution::ThreadPool, [Self]()
+		{
+			Self->RefreshSlots();
+			Self->bRefreshing = false;
+		});
+	}
+}
+
+bool FRedisCluster::Exec(const FString& InKey, TFunctionRef<bool(URedisClient&)> InCommand)
+{
+	FNodePtr Node = GetSlotNode(KeySlot(InKey));
+	bool bAsking = false;
+
+	for (int32 Redirects = 0; Node.IsValid() && Redirects <= MaxRedirects; ++Redirects)
+	{
+		FRedisPooledClient RedisClient(Node->Pool.Get());
+		if (!RedisClient)
+		{
+			// A failed-over primary never answers MOVED, only a refresh moves its slots away
+			bRefreshPending = true;
+			return false;
+		}
+		if (bAsking && !RedisClient->Asking())
+		{
+			return false;
+		}
+
+		RedisClient->ClearLastError();
+		if (InCommand(*RedisClient))
+		{
+			return true;
+		}
+
+		FRedisRedirect Redirect;
+		if (!ParseRedirect(RedisClient->GetLastError(), Redirect))
+		{
+			if (!RedisClient->IsConnected())
+			{
+				bRefreshPending = true;
+			}
+			return false;
+		}
+		Node = FollowRedirect(Redirect);
+		bAsking = Redirect.bAsk;
+	}
+	if (!Node.IsValid())
+	{
+		bRefreshPending = true;
+	}
+	return false;
+}
+
+void FRedisCluster::Submit(const FString& InKey, FRedisAsyncRequest* InRequest)
+{
+	Dispatch(GetSlotNode(KeySlot(InKey)), InRequest, false, 0);
+}
+
+void FRedisCluster::Dispatch(const FNodePtr& InNode, FRedisAsyncRequest* InRequest, bool bAsking, int32 InRedirects)
+{
+	if (!InNode.IsValid() || !InNode->Engine.IsValid())
+	{
+		bRefreshPending = true;
+		if (InRequest->OnReply)
+		{
+			InRequest->OnReply(nullptr);
+		}
+		delete InRequest;
+		return;
+	}
+
+	// The request is still alive while its own OnReply runs, so a redirect can take its arguments over
+	TWeakPtr<FRedisCluster, ESPMode::ThreadSafe> WeakCluster = AsShared();
+	InRequest->OnReply = [WeakCluster, InRequest, InRedirects, OnReply = MoveTemp(InRequest->OnReply)](redisReply* Reply) mutable
+	{
+		FRedisRedirect Redirect;
+		TSharedPtr<FRedisCluster, ESPMode::ThreadSafe> Cluster = WeakCluster.Pin();
+		if (Cluster.IsValid() && InRedirects < MaxRedirects && ParseRedirect(Reply, Redirect))
+		{
+			FRedisAsyncRequest* Retry = new FRedisAsyncRequest();
+			Retry->Args = MoveTemp(InRequest->Args);
+			Retry->OnReply = MoveTemp(OnReply);
+			Cluster->Dispatch(Cluster->FollowRedirect(Redirect), Retry, Redirect.bAsk, InRedirects + 1);
+			return;
+		}
+		if (Cluster.IsValid() && !Reply)
+		{
+			// Lost the connection: the node may have failed over, which no MOVED will report
+			Cluster->bRefreshPending = true;
+		}
+		if (OnReply)
+		{
+			OnReply(Reply);
+		}
+	};
+
+	if (bAsking)
+	{
+		// Written back to back on one connection, ASKING only covers the command right after it
+		FRedisAsyncRequest* AskingRequest = new FRedisAsyncRequest();
+		AskingRequest->Args.Add("ASKING");
+		AskingRequest->NextInBatch = InRequest;
+		InNode->Engine->Submit(AskingRequest);
+		return;
+	}
+	InNode->Engine->Submit(InRequest);
+}
+
+bool FRedisCluster::FanOut(TArray<FRedisClusterCommand>& InCommands, TFunctionRef<void(int32, const redisReply*)> InOnReply)
+{
+	struct FPending
+	{
+		FRedisClusterCommand*	Command;
+		FNodePtr				Node;
+		bool					bAsking;
+	};
+
+	TArray<FPending> Pending;
+	Pending.Reserve(InCommands.Num());
+	for (auto& it : InCommands)
+	{
+		Pending.Add({ &it, GetSlotNode(it.Slot), false });
+	}
+
+	FThreadSafeBool bFailed;
+	for (int32 Round = 0; Pending.Num() > 0 && Round <= MaxRedirects; ++Round)
+	{
+		TArray<FNodePtr> BatchNodes;
+		TArray<TArray<FPending*>> Batches;
+		for (auto& it : Pending)
+		{
+			if (!it.Node.IsValid())
+			{
+				InOnReply(it.Command->Index, nullptr);
+				bFailed = true;
+				bRefreshPending = true;
+				continue;
+			}
+			int32 BatchIndex = BatchNodes.Find(it.Node);
+			if (BatchIndex == INDEX_NONE)
+			{
+				BatchIndex = BatchNodes.Add(it.Node);
+				Batches.AddDefaulted();
+			}
+			Batches[BatchIndex].Add(&it);
+		}
+
+		TArray<FPending> Redirected;
+		FCriticalSection RedirectedLock;
+
+		// One pipelined round trip per node, all nodes at once
+		ParallelFor(Batches.Num(), [&](int32 BatchIndex)
+		{
+			const TArray<FPending*>& Batch = Batches[BatchIndex];
+
+			FRedisCommandArgs AskingArgs;
+			AskingArgs.Add("ASKING");
+
+			TArray<FRedisCommandArgs*> BatchArgs;
+			TArray<int32> ReplyOwners;
+			BatchArgs.Reserve(Batch.Num());
+			ReplyOwners.Reserve(Batch.Num());
+			for (int32 i = 0; i < Batch.Num(); ++i)
+			{
+				if (Batch[i]->bAsking)
+				{
+					BatchArgs.Add(&AskingArgs);
+					ReplyOwners.Add(INDEX_NONE);
+				}
+				BatchArgs.Add(&Batch[i]->Command->Args);
+				ReplyOwners.Add(i);
+			}
+
+			auto OnBatchReply = [&](int32 ReplyIndex, const redisReply* Reply)
+			{
+				const int32 Owner = ReplyOwners[ReplyIndex];
+				if (Owner == INDEX_NONE)
+				{
+					return;
+				}
+
+				FPending* Entry = Batch[Owner];
+				FRedisRedirect Redirect;
+				if (ParseRedirect(Reply, Redirect))
+				{
+					FNodePtr Target = FollowRedirect(Redirect);
+					FScopeLock ScopeLock(&RedirectedLock);
+					Redirected.Add({ Entry->Command, Target, Redirect.bAsk });
+					return;
+				}
+
+				if (!Reply)
+				{
+					bFailed = true;
+					bRefreshPending = true;
+				}
+				InOnReply(Entry->Command->Index, Reply);
+			};
+
+			FRedisPooledClient RedisClient(BatchNodes[BatchIndex]->Pool.Get());
+			if (RedisClient)
+			{
+				RedisClient->ExecBatch(BatchArgs, OnBatchReply);
+			}
+			else
+			{
+				for (int32 i = 0; i < BatchArgs.Num(); ++i)
+				{
+					OnBatchReply(i, nullptr);
+				}
+			}
+		});
+
+		Pending = MoveTemp(Redirected);
+	}
+
+	for (auto& it : Pending)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis cluster gave up on slot %d after %d redirects"), it.Command->Slot, MaxRedirects);
+		InOnReply(it.Command->Index, nullptr);
+		bFailed = true;
+	}
+
+	return !bFailed;
+}
+
+bool FRedisCluster::MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList)
+{
+	TMap<uint16, TArray<int32>> Groups;
+	GroupBySlot(InKeyList, Groups);
+
+	TArray<FRedisClusterCommand> Commands;
+	TArray<const TArray<int32>*> GroupKeys;
+	Commands.Reserve(Groups.Num());
+	GroupKeys.Reserve(Groups.Num());
+	for (auto& it : Groups)
+	{
+		FRedisClusterCommand& Command = Commands.AddDefaulted_GetRef();
+		Command.Index = GroupKeys.Add(&it.Value);
+		Command.Slot = it.Key;
+		Command.Args.Add("MGET");
+		for (int32 KeyIndex : it.Value)
+		{
+			Command.Args.Add(InKeyList[KeyIndex]);
+		}
+	}
+
+	// Every key belongs to exactly one group, so groups write disjoint positions
+	TArray<FString> Values;
+	TArray<uint8> Found;
+	Values.SetNum(InKeyList.Num());
+	Found.SetNumZeroed(InKeyList.Num());
+
+	FThreadSafeBool bError;
+	const bool bSent = FanOut(Commands, [&](int32 Index, const redisReply* Reply)
+	{
+		if (!Reply || Reply->type != REDIS_REPLY_ARRAY)
+		{
+			bError = true;
+			return;
+		}
+
+		const TArray<int32>& KeyIndices = *GroupKeys[Index];
+		for (int32 i = 0; i < (int32)Reply->elements && i < KeyIndices.Num(); ++i)
+		{
+			const redisReply* Element = Reply->element[i];
+			if (Element->type == REDIS_REPLY_STRING)
+			{
+				if (!FRedisCompression::ToString(Element->str, Element->len, Values[KeyIndices[i]]))
+				{
+					bError = true;
+				}
+				Found[KeyIndices[i]] = 1;
+			}
+		}
+	});
+
+	// Same shape as a single-node MGET: key order, missing keys left out
+	OutMemberList.Reserve(OutMemberList.Num() + InKeyList.Num());
+	for (int32 i = 0; i < Values.Num(); ++i)
+	{
+		if (Found[i])
+		{
+			OutMemberList.Add(MoveTemp(Values[i]));
+		}
+	}
+	return bSent && !bError;
+}
+
+void FRedisCluster::SubmitMGet(const TArray<FString>& InKeyList, TFunction<void(bool, TArray<FString>&&)>&& InOnFinished)
+{
+	struct FState
+	{
+		TArray<FString>		Values;
+		TArray<uint8>		Found;
+		FThreadSafeCounter	Remaining;
+		FThreadSafeBool		bError;
+		TFunction<void(bool, TArray<FString>&&)>	OnFinished;
+	};
+
+	TMap<uint16, TArray<int32>> Groups;
+	GroupBySlot(InKeyList, Groups);
+	if (Groups.Num() == 0)
+	{
+		InOnFinished(true, TArray<FString>());
+		return;
+	}
+
+	TSharedRef<FState, ESPMode::ThreadSafe> State = MakeShared<FState, ESPMode::ThreadSafe>();
+	State->Values.SetNum(InKeyList.Num());
+	State->Found.SetNumZeroed(InKeyList.Num());
+	State->Remaining.Set(Groups.Num());
+	State->OnFinished = MoveTemp(InOnFinished);
+
+	for (auto& it : Groups)
+	{
+		FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+		Request->Args.Add("MGET");
+		for (int32 KeyIndex : it.Value)
+		{
+			Request->Args.Add(InKeyList[KeyIndex]);
+		}
+		// Replies of different slots arrive on different I/O threads; the last one compacts
+		Request->OnReply = [State, KeyIndices = MoveTemp(it.Value)](redisReply* Reply)
+		{
+			if (!Reply || Reply->type != REDIS_REPLY_ARRAY)
+			{
+				State->bError = true;
+			}
+			else
+			{
+				for (int32 i = 0; i < (int32)Reply->elements && i < KeyIndices.Num(); ++i)
+				{
+					const redisReply* Element = Reply->element[i];
+					if (Element->type == REDIS_REPLY_STRING)
+					{
+						if (!FRedisCompression::ToString(Element->str, Element->len, State->Values[KeyIndices[i]]))
+						{
+							State->bError = true;
+						}
+						State->Found[KeyIndices[i]] = 1;
+					}
+				}
+			}
+
+			if (State->Remaining.Decrement() == 0)
+			{
+				TArray<FString> MemberList;
+				for (int32 i = 0; i < State->Values.Num(); ++i)
+				{
+					if (State->Found[i])
+					{
+						MemberList.Add(MoveTemp(State->Values[i]));
+					}
+				}
+				State->OnFinished(!State->bError, MoveTemp(MemberList));
+			}
+		};
+		Dispatch(GetSlotNode(it.Key), Request, false, 0);
+	}
+}
+
+bool FRedisCluster::MSet(const TMap<FString, FString>& InMemberMap)
+{
+	TMap<uint16, int32> SlotCommands;
+	TArray<FRedisClusterCommand> Commands;
+	for (auto& it : InMemberMap)
+	{
+		const uint16 Slot = KeySlot(it.Key);
+		int32* CommandIndex = SlotCommands.Find(Slot);
+		if (!CommandIndex)
+		{
+			FRedisClusterCommand& Command = Commands.AddDefaulted_GetRef();
+			Command.Index = Commands.Num() - 1;
+			Command.Slot = Slot;
+			Command.Args.Add("MSET");
+			CommandIndex = &SlotCommands.Add(Slot, Command.Index);
+		}
+		Commands[*CommandIndex].Args.Add(it.Key).Add(it.Value);
+	}
+
+	FThreadSafeBool bError;
+	const bool bSent = FanOut(Commands, [&](int32 Index, const redisReply* Reply)
+	{
+		if (!FRedisReplyParser::ParseStatus(Reply))
+		{
+			bError = true;
+		}
+	});
+	return bSent && !bError;
+}
+
+bool FRedisCluster::ExecPipeline(const FRedisPipeline& InPipeline, TArray<FRedisReply>& OutReplies)
+{
+	OutReplies.Reset(InPipeline.Num());
+	OutReplies.SetNum(InPipeline.Num());
+
+	TArray<FRedisClusterCommand> Commands;
+	Commands.Reserve(InPipeline.Num());
+	InPipeline.ForEachCommand([&Commands](const FString* Args, int32 ArgCount)
+	{
+		FRedisClusterCommand& Command = Commands.AddDefaulted_GetRef();
+		Command.Index = Commands.Num() - 1;
+		Command.Slot = KeySlot(GetCommandKey(Args, ArgCount));
+		for (int32 i = 0; i < ArgCount; ++i)
+		{
+			Command.Args.Add(Args[i]);
+		}
+	});
+
+	auto OnReply = [&OutReplies](int32 Index, const redisReply* Reply)
+	{
+		FRedisReply& OutReply = OutReplies[Index];
+		OutReply = FRedisReply();
+		FRedisReplyParser::ToReply(Reply, OutReply);
+	};
+	bool bResult = FanOut(Commands, OnReply);
+
+	// Scripts the node had not cached: rerun as EVAL, which caches them there
+	if (InPipeline.HasScripts())
+	{
+		TArray<FRedisClusterCommand> Retries;
+		int32 CommandIndex = 0;
+		InPipeline.ForEachCommand([&](const FString* Args, int32 ArgCount)
+		{
+			const int32 Index = CommandIndex++;
+			TSharedPtr<URedisScript, ESPMode::ThreadSafe> Script = InPipeline.FindScript(Index);
+			if (!Script.IsValid() || !OutReplies[Index].IsError() || !URedisScript::IsNoScriptError(OutReplies[Index].Str))
+			{
+				return;
+			}
+
+			FRedisClusterCommand& Retry = Retries.AddDefaulted_GetRef();
+			Retry.Index = Index;
+			Retry.Slot = Commands[Index].Slot;
+			Retry.Args.Add("EVAL").Add(Script->GetSource());
+			for (int32 i = 2; i < ArgCount; ++i)
+			{
+				Retry.Args.Add(Args[i]);
+			}
+		});
+		if (Retries.Num())
+		{
+			bResult &= FanOut(Retries, OnReply);
+		}
+	}
+
+	return bResult;
+}
+
+bool FRedisCluster::GetNodeAddress(const FString& InKey, FString& OutHost, int32& OutPort) const
+{
+	FNodePtr Node = GetSlotNode(KeySlot(InKey));
+	if (!Node.IsValid())
+	{
+		return false;
+	}
+	OutHost = Node->Host;
+	OutPort = Node->Port;
+	return true;
+}
+
+void FRedisCluster::ForEachNode(TFunctionRef<void(URedisClient&)> InFunc)
+{
+	TArray<FNodePtr> KnownNodes;
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+		KnownNodes = Nodes;
+	}
+
+	for (auto& Node : KnownNodes)
+	{
+		FRedisPooledClient RedisClient(Node->Pool.Get());
+		if (RedisClient)
+		{
+			InFunc(*RedisClient);
+		}
+	}
+}
+
+FRedisCluster::FNodePtr FRedisCluster::GetSlotNode(uint16 InSlot) const
+{
+	FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+	const int32 NodeIndex = SlotNodes[InSlot];
+	if (Nodes.IsValidIndex(NodeIndex))
+	{
+		return Nodes[NodeIndex];
+	}
+	// Slot not covered (yet): any node will answer with a redirect
+	return Nodes.Num() ? Nodes[0] : nullptr;
+}
+
+FRedisCluster::FNodePtr FRedisCluster::FindOrAddNode(const FString& InHost, int32 InPort, bool bPrewarm)
+{
+	// An empty host in a redirect or in CLUSTER SLOTS means "the endpoint you already used"
+	const FString& NodeHost = InHost.IsEmpty() ? SeedHost : InHost;
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+		if (bShutdown)
+		{
+			return nullptr;
+		}
+		for (auto& Node : Nodes)
+		{
+			if (Node->Port == InPort && Node->Host == NodeHost)
+			{
+				return Node;
+			}
+		}
+	}
+
+	// Connect outside the lock; a redirect on the I/O thread opens no connection up front
+	FNodePtr NewNode = MakeShared<FNode, ESPMode::ThreadSafe>();
+	NewNode->Host = NodeHost;
+	NewNode->Port = InPort;
+	NewNode->Pool = MakeShareable(new FRedisConnectionPool());
+	NewNode->Pool->IdleTimeout = PoolIdleTimeout;
+	NewNode->Pool->ValidateAfter = PoolValidateAfter;
+	NewNode->Pool->OnConnected = OnConnected;
+	NewNode->Pool->Init(NodeHost, InPort, Password, bPrewarm ? MinPoolSize : 0, MaxPoolSize);
+	NewNode->Engine = MakeShareable(new FRedisAsyncEngine());
+	if (!NewNode->Engine->Start(NodeHost, InPort, Password, AsyncConnectionNum))
+	{
+		NewNode->Engine.Reset();
+	}
+
+	FNodePtr Existing;
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_Write);
+		for (auto& Node : Nodes)
+		{
+			if (Node->Port == InPort && Node->Host == NodeHost)
+			{
+				Existing = Node;
+				break;
+			}
+		}
+		if (!Existing.IsValid() && !bShutdown)
+		{
+			Nodes.Add(NewNode);
+			return NewNode;
+		}
+	}
+
+	// Lost the race to another thread, or shut down in the meantime
+	if (NewNode->Engine.IsValid())
+	{
+		NewNode->Engine->Shutdown();
+	}
+	NewNode->Pool->Shutdown();
+	return Existing;
+}
+
+FRedisCluster::FNodePtr FRedisCluster::FollowRedirect(const FRedisRedirect& InRedirect)
+{
+	FNodePtr Node = FindOrAddNode(InRedirect.Host, InRedirect.Port, false);
+	if (Node.IsValid() && !InRedirect.bAsk)
+	{
+		// The slot moved for good: patch it now, reread the whole table soon
+		{
+			FRWScopeLock ScopeLock(Lock, SLT_Write);
+			const int32 NodeIndex = Nodes.Find(Node);
+			if (NodeIndex != INDEX_NONE)
+			{
+				SlotNodes[InRedirect.Slot] = (int16)NodeIndex;
+			}
+		}
+		bRefreshPending = true;
+	}
+	return Node;
+}
+
+bool FRedisCluster::RefreshSlots()
+{
+	TArray<FRedisSlotRange> Ranges;
+	bool bFetched = false;
+
+	TArray<FNodePtr> KnownNodes;
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+		KnownNodes = Nodes;
+	}
+	for (auto& Node : KnownNodes)
+	{
+		FRedisPooledClient RedisClient(Node->Pool.Get());
+		if (RedisClient && RedisClient->ClusterSlots(Ranges))
+		{
+			bFetched = true;
+			break;
+		}
+	}
+	if (!bFetched)
+	{
+		// First read, or every known node is gone: start over from the seed
+		URedisClient SeedClient;
+		bFetched = SeedClient.ConnectToRedis(SeedHost, SeedPort, Password) && SeedClient.ClusterSlots(Ranges);
+	}
+	if (!bFetched || Ranges.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<int16> NewSlotNodes;
+	NewSlotNodes.Init(INDEX_NONE, SlotCount);
+	for (auto& Range : Ranges)
+	{
+		FNodePtr Node = FindOrAddNode(Range.Host, Range.Port, true);
+		if (!Node.IsValid())
+		{
+			continue;
+		}
+
+		int32 NodeIndex = INDEX_NONE;
+		{
+			FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+			NodeIndex = Nodes.Find(Node);
+		}
+		for (int32 Slot = FMath::Max(Range.Start, 0); Slot <= FMath::Min(Range.End, SlotCount - 1); ++Slot)
+		{
+			NewSlotNodes[Slot] = (int16)NodeIndex;
+		}
+	}
+
+	{
+		FRWScopeLock ScopeLock(Lock, SLT_Write);
+		if (!bShutdown)
+		{
+			SlotNodes = MoveTemp(NewSlotNodes);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,190 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/ScopeRWLock.h"
+#include "RedisCommandArgs.h"
+
+struct redisReply;
+struct FRedisReply;
+struct FRedisAsyncRequest;
+class URedisClient;
+class FRedisPipeline;
+class FRedisConnectionPool;
+class FRedisAsyncEngine;
+
+/** Target of a MOVED or ASK error reply. */
+struct FRedisRedirect
+{
+	FRedisRedirect() :
+		bAsk(false), Slot(0), Port(0)
+	{	}
+
+	bool	bAsk;
+	int32	Slot;
+	FString	Host;
+	int32	Port;
+};
+
+/** One entry of CLUSTER SLOTS: an inclusive slot range and the primary serving it. */
+struct FRedisSlotRange
+{
+	FRedisSlotRange() :
+		Start(0), End(0), Port(0)
+	{	}
+
+	int32	Start;
+	int32	End;
+	FString	Host;
+	int32	Port;
+};
+
+/** One command of a fan-out, routed by Slot. Replies are reported under Index. */
+struct FRedisClusterCommand
+{
+	FRedisClusterCommand() :
+		Index(0), Slot(0)
+	{	}
+
+	int32				Index;
+	uint16				Slot;
+	FRedisCommandArgs	Args;
+};
+
+/**
+ * Client side of Redis Cluster.
+ * Keeps a cached copy of the CLUSTER SLOTS topology and a connection pool plus an async
+ * engine per primary, and sends every command straight to the node that owns its key's slot.
+ * MOVED patches the cached slot and schedules a full topology refresh in the background;
+ * ASK resends the command once to the importing node, prefixed with ASKING.
+ * Multi-key commands must keep their keys in one slot ({hashtag}) unless they go through
+ * MGet/MSet/FanOut, which split them by slot and reassemble the replies.
+ *
+ * InitSharded reuses the same routing for independent standalone servers: the slots are
+ * spread over the shards by a consistent-hash ring with virtual nodes, so adding or
+ * removing a shard only moves the slots next to its points on the ring.
+ */
+class FRedisCluster : public TSharedFromThis<FRedisCluster, ESPMode::ThreadSafe>
+{
+public:
+
+	static const int32 SlotCount = 16384;
+
+	/** Redirects followed for one command before giving up. */
+	static const int32 MaxRedirects = 5;
+
+	FRedisCluster();
+	~FRedisCluster();
+
+	/** CRC16 of the key (or of its {hashtag}) modulo 16384, over the UTF-8 bytes. */
+	static uint16 KeySlot(const FString& InKey);
+
+	static uint16 KeySlot(const ANSICHAR* InKey, int32 InLen);
+
+	/** Parses "MOVED 3999 127.0.0.1:6381" / "ASK 3999 127.0.0.1:6381". */
+	static bool ParseRedirect(const FString& InError, FRedisRedirect& OutRedirect);
+
+	static bool ParseRedirect(const redisReply* InReply, FRedisRedirect& OutRedirect);
+
+	/** Key a queued command is routed by: the first key of EVAL/EVALSHA, otherwise the first argument. */
+	static FString GetCommandKey(const FString* InArgs, int32 InArgCount);
+
+	/** Reads the topology through InHost:InPort and opens a pool and an engine per primary. */
+	bool Init(const FString& InHost, int32 InPort, const FString& InPassword);
+
+	/** Client-side sharding over standalone "host:port" servers, InVirtualNodes ring points each. */
+	bool InitSharded(const TArray<FString>& InShards, const FString& InPassword, int32 InVirtualNodes);
+
+	/** Stops every engine and closes every pool; waits for a refresh still running. */
+	void Shutdown();
+
+	/** Reaps idle connections on every node and starts a pending topology refresh. Game thread. */
+	void Tick();
+
+	/** Runs InCommand on a connection to the node owning InKey, following MOVED/ASK. */
+	bool Exec(const FString& InKey, TFunctionRef<bool(URedisClient&)> InCommand);
+
+	/** Hands InRequest to the engine of the node owning InKey; redirect replies are followed before OnReply sees them. */
+	void Submit(const FString& InKey, FRedisAsyncRequest* InRequest);
+
+	/**
+	 * Sends every command to its node, one pipelined batch per node, all nodes in parallel.
+	 * InOnReply runs on a worker thread per node, once per command; redirects are followed first.
+	 */
+	bool FanOut(TArray<FRedisClusterCommand>& InCommands, TFunctionRef<void(int32, const redisReply*)> InOnReply);
+
+	/** MGET split into one MGET per slot; OutMemberList is in key order, without the missing keys. */
+	bool MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList);
+
+	/** Async MGet: one MGET per slot through the node engines; InOnFinished runs on the I/O thread of the last reply. */
+	void SubmitMGet(const TArray<FString>& InKeyList, TFunction<void(bool, TArray<FString>&&)>&& InOnFinished);
+
+	bool MSet(const TMap<FString, FString>& InMemberMap);
+
+	/** Every command is routed by its own key; NOSCRIPT replies are retried as EVAL. */
+	bool ExecPipeline(const FRedisPipeline& InPipeline, TArray<FRedisReply>& OutReplies);
+
+	/** Address of the node currently owning InKey's slot. */
+	bool GetNodeAddress(const FString& InKey, FString& OutHost, int32& OutPort) const;
+
+	/** Runs InFunc on a connection to every known primary. */
+	void ForEachNode(TFunctionRef<void(URedisClient&)> InFunc);
+
+	/** Key index lists per slot, in first-seen order. */
+	static void GroupBySlot(const TArray<FString>& InKeyList, TMap<uint16, TArray<int32>>& OutGroups);
+
+public:
+	/** Applied to the pool of every node. */
+	int32	MinPoolSize;
+	int32	MaxPoolSize;
+	float	PoolIdleTimeout;
+	float	PoolValidateAfter;
+
+	/** Connections per node engine. */
+	int32	AsyncConnectionNum;
+
+	/** Runs on every new pooled connection, on any node. */
+	TFunction<void(URedisClient&)>	OnConnected;
+
+private:
+	struct FNode
+	{
+		FString		Host;
+		int32		Port;
+		TSharedPtr<FRedisConnectionPool>	Pool;
+		TSharedPtr<FRedisAsyncEngine>		Engine;
+	};
+
+	typedef TSharedPtr<FNode, ESPMode::ThreadSafe> FNodePtr;
+
+	FNodePtr GetSlotNode(uint16 InSlot) const;
+
+	/** Opens a pool and an engine for a node seen for the first time; only discovery pre-warms the pool. */
+	FNodePtr FindOrAddNode(const FString& InHost, int32 InPort, bool bPrewarm);
+
+	/** MOVED also repoints the slot and asks for a refresh. */
+	FNodePtr FollowRedirect(const FRedisRedirect& InRedirect);
+
+	/** Blocking: CLUSTER SLOTS through any reachable node, then swaps in the new table. */
+	bool RefreshSlots();
+
+	void Dispatch(const FNodePtr& InNode, FRedisAsyncRequest* InRequest, bool bAsking, int32 InRedirects);
+
+private:
+	FString		SeedHost;
+	int32		SeedPort;
+	FString		Password;
+
+	mutable FRWLock			Lock;
+	TArray<FNodePtr>		Nodes;
+	/** Index into Nodes per slot, INDEX_NONE until the topology is known. */
+	TArray<int16>			SlotNodes;
+	bool					bShutdown;
+
+	/** Set on MOVED and on any failure to reach a node; Tick refreshes at most every RedisClusterRefreshInterval. */
+	FThreadSafeBool		bRefreshPending;
+	FThreadSafeBool		bRefreshing;
+	double				NextRefreshTime;
+};
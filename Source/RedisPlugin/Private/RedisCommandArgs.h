@@ -0,0 +1,123 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+/**
+ * Argument list for redisCommandArgv / redisAppendCommandArgv.
+ * Every argument is stored as UTF-8 with an explicit length in one shared buffer,
+ * so values may contain spaces, '%', NUL bytes or non-ASCII text.
+ * Meant to be kept per connection and reused: Reset() keeps the allocations.
+ */
+class FRedisCommandArgs
+{
+public:
+
+	FRedisCommandArgs& Reset()
+	{
+		Buffer.Reset();
+		Offsets.Reset();
+		Lengths.Reset();
+		return *this;
+	}
+
+	/** Command names and other ASCII literals. */
+	FRedisCommandArgs& Add(const ANSICHAR* InArg)
+	{
+		return AddRaw(InArg, FCStringAnsi::Strlen(InArg));
+	}
+
+	FRedisCommandArgs& Add(const FString& InArg)
+	{
+		const int32 SrcLen = InArg.Len();
+		const int32 DestLen = FPlatformString::ConvertedLength<UTF8CHAR>(*InArg, SrcLen);
+		const int32 Offset = Buffer.AddUninitialized(DestLen);
+		FPlatformString::Convert((UTF8CHAR*)(Buffer.GetData() + Offset), DestLen, *InArg, SrcLen);
+		Offsets.Add(Offset);
+		Lengths.Add(DestLen);
+		return *this;
+	}
+
+	FRedisCommandArgs& Add(int64 InValue)
+	{
+		ANSICHAR Digits[24];
+		const int32 Len = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%lld", (long long)InValue);
+		return AddRaw(Digits, Len);
+	}
+
+	FRedisCommandArgs& Add(int32 InValue)
+	{
+		return Add((int64)InValue);
+	}
+
+	/** Scores and other floating point arguments; infinities become -inf/+inf. */
+	FRedisCommandArgs& Add(double InValue)
+	{
+		if (!FMath::IsFinite(InValue))
+		{
+			return Add(InValue > 0.0 ? "+inf" : "-inf");
+		}
+		ANSICHAR Digits[32];
+		const int32 Len = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%.17g", InValue);
+		return AddRaw(Digits, Len);
+	}
+
+	FRedisCommandArgs& AddRaw(const void* InData, int32 InLen)
+	{
+		const int32 Offset = Buffer.AddUninitialized(InLen);
+		if (InLen > 0)
+		{
+			FMemory::Memcpy(Buffer.GetData() + Offset, InData, InLen);
+		}
+		Offsets.Add(Offset);
+		Lengths.Add(InLen);
+		return *this;
+	}
+
+	int32 Num() const
+	{
+		return Offsets.Num();
+	}
+
+	/** Empty past the last argument. */
+	FAnsiStringView GetArg(int32 InIndex) const
+	{
+		return Offsets.IsValidIndex(InIndex) ? FAnsiStringView(Buffer.GetData() + Offsets[InIndex], (int32)Lengths[InIndex]) : FAnsiStringView();
+	}
+
+	/** The first argument, i.e. the command name. */
+	FAnsiStringView GetName() const
+	{
+		return GetArg(0);
+	}
+
+	/** Bytes of every argument together. */
+	int32 GetSize() const
+	{
+		return Buffer.Num();
+	}
+
+	/** Argument pointers, valid until the next Add or Reset. */
+	const char** GetArgv()
+	{
+		Argv.Reset();
+		for (int32 Offset : Offsets)
+		{
+			Argv.Add(Buffer.GetData() + Offset);
+		}
+		return Argv.GetData();
+	}
+
+	const size_t* GetArgvLen() const
+	{
+		return Lengths.GetData();
+	}
+
+private:
+	TArray<ANSICHAR, TInlineAllocator<256>>		Buffer;
+	TArray<int32, TInlineAllocator<16>>			Offsets;
+	TArray<size_t, TInlineAllocator<16>>		Lengths;
+	TArray<const char*, TInlineAllocator<16>>	Argv;
+};
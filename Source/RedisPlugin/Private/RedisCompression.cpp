@@ -0,0 +1,261 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisCompression.h"
+#include "RedisCompressionDictionary.h"
+#include "RedisCommandArgs.h"
+#include "RedisReplyParser.h"
+#include "AsyncRedisDefines.h"
+#include "Misc/Compression.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+static const uint8 RedisCompressionMagic[] = { 0x00, 'R', 'Z' };
+
+/** Largest value Redis stores, so a corrupt header cannot ask for more. */
+static const uint32 RedisMaxValueSize = 512 * 1024 * 1024;
+
+static FName GetCompressionFormat(ERedisCompression InCodec)
+{
+	switch (InCodec)
+	{
+		case ERedisCompression::LZ4:
+			return NAME_LZ4;
+		case ERedisCompression::Zlib:
+			return NAME_Zlib;
+		case ERedisCompression::Gzip:
+			return NAME_Gzip;
+		case ERedisCompression::Oodle:
+			return NAME_Oodle;
+		default:
+			return NAME_None;
+	}
+}
+
+static void WriteHeader(uint8* OutHeader, ERedisCompression InCodec, uint32 InRawSize)
+{
+	FMemory::Memcpy(OutHeader, RedisCompressionMagic, sizeof(RedisCompressionMagic));
+	OutHeader[3] = (uint8)InCodec;
+	OutHeader[4] = (uint8)(InRawSize);
+	OutHeader[5] = (uint8)(InRawSize >> 8);
+	OutHeader[6] = (uint8)(InRawSize >> 16);
+	OutHeader[7] = (uint8)(InRawSize >> 24);
+}
+
+static uint32 ReadUInt32(const uint8* InData)
+{
+	return InData[0] | (InData[1] << 8) | (InData[2] << 16) | ((uint32)InData[3] << 24);
+}
+
+bool FRedisCompression::Compress(ERedisCompression InCodec, int32 InThreshold, const FString& InValue, TArray<uint8>& OutValue)
+{
+	OutValue.Reset();
+	if (InCodec == ERedisCompression::None || InValue.Len() < InThreshold)
+	{
+		return false;
+	}
+
+	const FName Format = GetCompressionFormat(InCodec);
+	if (Format.IsNone() || !FCompression::IsFormatValid(Format))
+	{
+		return false;
+	}
+
+	FTCHARToUTF8 Utf8(*InValue);
+	const int32 RawSize = Utf8.Length();
+	int32 CompressedSize = FCompression::CompressMemoryBound(Format, RawSize);
+	OutValue.SetNumUninitialized(HeaderSize + CompressedSize);
+	if (!FCompression::CompressMemory(Format, OutValue.GetData() + HeaderSize, CompressedSize, Utf8.Get(), RawSize)
+		// Not worth a decompression on every read
+		|| HeaderSize + CompressedSize >= RawSize)
+	{
+		OutValue.Reset();
+		return false;
+	}
+
+	WriteHeader(OutValue.GetData(), InCodec, RawSize);
+	OutValue.SetNum(HeaderSize + CompressedSize, false);
+	return true;
+}
+
+bool FRedisCompression::Compress(const FRedisCompressionDictionary& InDictionary, int32 InThreshold, const FString& InValue, TArray<uint8>& OutValue)
+{
+	OutValue.Reset();
+	if (InValue.Len() < InThreshold)
+	{
+		return false;
+	}
+
+	FTCHARToUTF8 Utf8(*InValue);
+	const int32 RawSize = Utf8.Length();
+	OutValue.AddUninitialized(DictionaryHeaderSize);
+	if (!InDictionary.Compress((const uint8*)Utf8.Get(), RawSize, OutValue) || OutValue.Num() >= RawSize)
+	{
+		OutValue.Reset();
+		return false;
+	}
+
+	const uint32 DictionaryId = InDictionary.GetId();
+	WriteHeader(OutValue.GetData(), ERedisCompression::ZlibDictionary, RawSize);
+	OutValue[8] = (uint8)(DictionaryId);
+	OutValue[9] = (uint8)(DictionaryId >> 8);
+	OutValue[10] = (uint8)(DictionaryId >> 16);
+	OutValue[11] = (uint8)(DictionaryId >> 24);
+	return true;
+}
+
+void FRedisCompression::AddValue(FRedisCommandArgs& OutArgs, const FString& InValue, const FRedisCompressionDictionary* InDictionary, int32 InThreshold)
+{
+	TArray<uint8> Compressed;
+	if (InDictionary && Compress(*InDictionary, InThreshold, InValue, Compressed))
+	{
+		OutArgs.AddRaw(Compressed.GetData(), Compressed.Num());
+	}
+	else
+	{
+		OutArgs.Add(InValue);
+	}
+}
+
+bool FRedisCompression::IsCompressed(const char* InStr, size_t InLen)
+{
+	return InLen >= (size_t)HeaderSize && FMemory::Memcmp(InStr, RedisCompressionMagic, sizeof(RedisCompressionMagic)) == 0;
+}
+
+static bool DictionaryToString(const char* InStr, size_t InLen, uint32 InRawSize, FString& OutValue)
+{
+	const uint32 DictionaryId = InLen >= (size_t)FRedisCompression::DictionaryHeaderSize ? ReadUInt32((const uint8*)InStr + 8) : 0;
+	TSharedPtr<const FRedisCompressionDictionary, ESPMode::ThreadSafe> Dictionary = FRedisCompressionDictionary::Find(DictionaryId);
+	if (!Dictionary.IsValid() || InRawSize > RedisMaxValueSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis value compressed with unknown dictionary %08x; was a new one trained without LoadCompressionDictionaries?"), DictionaryId);
+		return false;
+	}
+
+	TArray<ANSICHAR> Raw;
+	Raw.SetNumUninitialized(InRawSize);
+	if (!Dictionary->Decompress((const uint8*)InStr + FRedisCompression::DictionaryHeaderSize, InLen - FRedisCompression::DictionaryHeaderSize, (uint8*)Raw.GetData(), InRawSize))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis value failed to decompress with dictionary %08x"), DictionaryId);
+		return false;
+	}
+
+	OutValue = FRedisReplyParser::ToString(Raw.GetData(), InRawSize);
+	return true;
+}
+
+bool FRedisCompression::ToString(const char* InStr, size_t InLen, FString& OutValue)
+{
+	if (!IsCompressed(InStr, InLen))
+	{
+		OutValue = FRedisReplyParser::ToString(InStr, InLen);
+		return true;
+	}
+
+	const uint8* Header = (const uint8*)InStr;
+	const ERedisCompression Codec = (ERedisCompression)Header[3];
+	const uint32 RawSize = ReadUInt32(Header + 4);
+	if (Codec == ERedisCompression::ZlibDictionary)
+	{
+		return DictionaryToString(InStr, InLen, RawSize, OutValue);
+	}
+
+	const FName Format = GetCompressionFormat(Codec);
+	if (Format.IsNone() || !FCompression::IsFormatValid(Format) || RawSize > RedisMaxValueSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis compressed value with unsupported codec %d or size %u"), (int32)Codec, RawSize);
+		return false;
+	}
+
+	TArray<ANSICHAR> Raw;
+	Raw.SetNumUninitialized(RawSize);
+	if (!FCompression::UncompressMemory(Format, Raw.GetData(), RawSize, InStr + HeaderSize, InLen - HeaderSize))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis %s value failed to decompress"), *Format.ToString());
+		return false;
+	}
+
+	OutValue = FRedisReplyParser::ToString(Raw.GetData(), RawSize);
+	return true;
+}
+
+bool FRedisCompression::ParseString(const redisReply* InReply, FString& OutValue)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_STRING)
+	{
+		return false;
+	}
+	return ToString(InReply->str, InReply->len, OutValue);
+}
+
+bool FRedisCompression::ParseArray(const redisReply* InReply, TArray<FString>& OutMemberList)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	bool bResult = true;
+	OutMemberList.Reserve(OutMemberList.Num() + InReply->elements);
+	for (size_t i = 0; i < InReply->elements; i++)
+	{
+		if (InReply->element[i]->str != NULL)
+		{
+			bResult &= ToString(InReply->element[i]->str, InReply->element[i]->len, OutMemberList.AddDefaulted_GetRef());
+		}
+	}
+	return bResult;
+}
+
+bool FRedisCompression::ParseMap(const redisReply* InReply, TMap<FString, FString>& OutMemberMap)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	bool bResult = true;
+	OutMemberMap.Reserve(OutMemberMap.Num() + InReply->elements / 2);
+	for (size_t i = 0; i + 1 < InReply->elements; i += 2)
+	{
+		if (InReply->element[i]->str != NULL && InReply->element[i + 1]->str != NULL)
+		{
+			bResult &= ToString(InReply->element[i + 1]->str, InReply->element[i + 1]->len, OutMemberMap.Add(FRedisReplyParser::ToString(InReply->element[i]->str, InReply->element[i]->len)));
+		}
+	}
+	return bResult;
+}
+
+bool FRedisCompression::ParseFieldValues(const redisReply* InReply, TMap<FString, FString>& InOutMemberMap)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	bool bResult = true;
+	size_t i = 0;
+	for (auto& it : InOutMemberMap)
+	{
+		if (i >= InReply->elements)
+		{
+			break;
+		}
+
+		if (InReply->element[i]->str != NULL)
+		{
+			bResult &= ToString(InReply->element[i]->str, InReply->element[i]->len, it.Value);
+		}
+
+		++i;
+	}
+	return bResult;
+}
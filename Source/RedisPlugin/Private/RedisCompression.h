@@ -0,0 +1,54 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct redisReply;
+class FRedisCommandArgs;
+class FRedisCompressionDictionary;
+enum class ERedisCompression : uint8;
+
+/**
+ * Transparent compression of string values through FCompression. A compressed value starts
+ * with a header no text value can start with (a NUL byte, "RZ", the codec and the
+ * uncompressed size), so reads tell compressed and plain values apart on their own and
+ * the codec can be changed, or compression turned off, without rewriting what is stored.
+ */
+struct FRedisCompression
+{
+	static const int32 HeaderSize = 8;
+
+	/** HeaderSize plus the id of the dictionary. */
+	static const int32 DictionaryHeaderSize = 12;
+
+	/**
+	 * InValue as UTF-8 with a header, compressed with InCodec. False, with OutValue empty, when
+	 * it should be stored as it is: no codec, fewer than InThreshold characters, a codec this
+	 * build lacks, or no gain.
+	 */
+	static bool Compress(ERedisCompression InCodec, int32 InThreshold, const FString& InValue, TArray<uint8>& OutValue);
+
+	/** As above, against a trained dictionary (ERedisCompression::ZlibDictionary). */
+	static bool Compress(const FRedisCompressionDictionary& InDictionary, int32 InThreshold, const FString& InValue, TArray<uint8>& OutValue);
+
+	/** Adds InValue to OutArgs, compressed against InDictionary if there is one and it pays off. */
+	static void AddValue(FRedisCommandArgs& OutArgs, const FString& InValue, const FRedisCompressionDictionary* InDictionary, int32 InThreshold);
+
+	static bool IsCompressed(const char* InStr, size_t InLen);
+
+	/** Text of a stored value, compressed or not. False only for a compressed value that cannot be decoded. */
+	static bool ToString(const char* InStr, size_t InLen, FString& OutValue);
+
+	/** FRedisReplyParser::ParseString for values that may be compressed. */
+	static bool ParseString(const redisReply* InReply, FString& OutValue);
+
+	/** FRedisReplyParser::ParseArray for values that may be compressed, e.g. of MGET. */
+	static bool ParseArray(const redisReply* InReply, TArray<FString>& OutMemberList);
+
+	/** FRedisReplyParser::ParseMap for values that may be compressed. */
+	static bool ParseMap(const redisReply* InReply, TMap<FString, FString>& OutMemberMap);
+
+	/** FRedisReplyParser::ParseFieldValues for values that may be compressed. */
+	static bool ParseFieldValues(const redisReply* InReply, TMap<FString, FString>& InOutMemberMap);
+};
@@ -0,0 +1,240 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisCompressionDictionary.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeRWLock.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+/** Bytes matched as one unit when looking for what samples have in common. */
+static const int32 RedisDictionaryDmerSize = 8;
+
+/** Bytes taken into the dictionary at a time, and the stride candidates are taken at. */
+static const int32 RedisDictionarySegmentSize = 64;
+static const int32 RedisDictionarySegmentStep = 16;
+
+const TCHAR* const FRedisCompressionDictionary::CurrentField = TEXT("current");
+
+static FRWLock& GetDictionaryLock()
+{
+	static FRWLock Lock;
+	return Lock;
+}
+
+static TMap<uint32, TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe>>& GetDictionaries()
+{
+	static TMap<uint32, TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe>> Dictionaries;
+	return Dictionaries;
+}
+
+static uint64 ReadDmer(const uint8* InData)
+{
+	uint64 Dmer;
+	FMemory::Memcpy(&Dmer, InData, sizeof(Dmer));
+	return Dmer;
+}
+
+FRedisCompressionDictionary::FRedisCompressionDictionary(TArray<uint8>&& InData, uint32 InId) :
+	Data(MoveTemp(InData)),
+	Id(InId)
+{
+}
+
+TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe> FRedisCompressionDictionary::Register(TArray<uint8>&& InData)
+{
+	const uint32 DictionaryId = FCrc::MemCrc32(InData.GetData(), InData.Num());
+
+	FRWScopeLock ScopeLock(GetDictionaryLock(), SLT_Write);
+	const TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe>* Found = GetDictionaries().Find(DictionaryId);
+	if (Found)
+	{
+		return *Found;
+	}
+	TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe> Dictionary = MakeShareable(new FRedisCompressionDictionary(MoveTemp(InData), DictionaryId));
+	GetDictionaries().Add(DictionaryId, Dictionary);
+	return Dictionary;
+}
+
+TSharedPtr<const FRedisCompressionDictionary, ESPMode::ThreadSafe> FRedisCompressionDictionary::Find(uint32 InId)
+{
+	FRWScopeLock ScopeLock(GetDictionaryLock(), SLT_ReadOnly);
+	const TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe>* Found = GetDictionaries().Find(InId);
+	return Found ? TSharedPtr<const FRedisCompressionDictionary, ESPMode::ThreadSafe>(*Found) : nullptr;
+}
+
+TArray<uint8> FRedisCompressionDictionary::Train(const TArray<TArray<uint8>>& InSamples, int32 InMaxSize)
+{
+	InMaxSize = FMath::Clamp(InMaxSize, 0, MaxSize);
+
+	// In how many samples each d-mer appears: what many values share is what a dictionary saves
+	TMap<uint64, int32> Frequencies;
+	TSet<uint64> SampleDmers;
+	for (const TArray<uint8>& Sample : InSamples)
+	{
+		SampleDmers.Reset();
+		for (int32 i = 0; i + RedisDictionaryDmerSize <= Sample.Num(); ++i)
+		{
+			bool bAlreadyInSample = false;
+			const uint64 Dmer = ReadDmer(Sample.GetData() + i);
+			SampleDmers.Add(Dmer, &bAlreadyInSample);
+			if (!bAlreadyInSample)
+			{
+				++Frequencies.FindOrAdd(Dmer);
+			}
+		}
+	}
+
+	struct FSegment
+	{
+		int32 Sample;
+		int32 Offset;
+		int32 Length;
+		int32 Score;
+	};
+
+	// Sum of the frequencies of the distinct d-mers in a segment, counting only those shared by several samples
+	TSet<uint64> SegmentDmers;
+	auto ScoreSegment = [&](const FSegment& InSegment)
+	{
+		int32 Score = 0;
+		SegmentDmers.Reset();
+		const uint8* SegmentData = InSamples[InSegment.Sample].GetData() + InSegment.Offset;
+		for (int32 i = 0; i + RedisDictionaryDmerSize <= InSegment.Length; ++i)
+		{
+			bool bAlreadyInSegment = false;
+			const uint64 Dmer = ReadDmer(SegmentData + i);
+			SegmentDmers.Add(Dmer, &bAlreadyInSegment);
+			const int32 Frequency = bAlreadyInSegment ? 0 : Frequencies.FindRef(Dmer);
+			if (Frequency > 1)
+			{
+				Score += Frequency;
+			}
+		}
+		return Score;
+	};
+
+	auto ByScore = [](const FSegment& A, const FSegment& B)
+	{
+		return A.Score > B.Score;
+	};
+
+	TArray<FSegment> Candidates;
+	for (int32 SampleIndex = 0; SampleIndex < InSamples.Num(); ++SampleIndex)
+	{
+		const int32 SampleSize = InSamples[SampleIndex].Num();
+		for (int32 Offset = 0; Offset + RedisDictionaryDmerSize <= SampleSize; Offset += RedisDictionarySegmentStep)
+		{
+			FSegment Segment;
+			Segment.Sample = SampleIndex;
+			Segment.Offset = Offset;
+			Segment.Length = FMath::Min(RedisDictionarySegmentSize, SampleSize - Offset);
+			Segment.Score = ScoreSegment(Segment);
+			if (Segment.Score > 0)
+			{
+				Candidates.Add(Segment);
+			}
+		}
+	}
+	Candidates.Heapify(ByScore);
+
+	// Greedy: take the best segment, then stop counting what it covers so overlapping and
+	// repeated segments fall behind. Scores only ever go down, so stale ones are re-scored lazily.
+	TArray<FSegment> Chosen;
+	int32 ChosenSize = 0;
+	while (Candidates.Num() && ChosenSize < InMaxSize)
+	{
+		FSegment Best;
+		Candidates.HeapPop(Best, ByScore, false);
+
+		const int32 Score = ScoreSegment(Best);
+		if (Score < Best.Score)
+		{
+			if (Score > 0)
+			{
+				Best.Score = Score;
+				Candidates.HeapPush(Best, ByScore);
+			}
+			continue;
+		}
+
+		Chosen.Add(Best);
+		ChosenSize += Best.Length;
+		const uint8* SegmentData = InSamples[Best.Sample].GetData() + Best.Offset;
+		for (int32 i = 0; i + RedisDictionaryDmerSize <= Best.Length; ++i)
+		{
+			if (int32* Frequency = Frequencies.Find(ReadDmer(SegmentData + i)))
+			{
+				*Frequency = 0;
+			}
+		}
+	}
+
+	// Deflate reaches the end of the dictionary with the shortest distances, so the best goes last
+	TArray<uint8> Dictionary;
+	Dictionary.Reserve(FMath::Min(ChosenSize, InMaxSize));
+	for (int32 i = Chosen.Num() - 1; i >= 0; --i)
+	{
+		const FSegment& Segment = Chosen[i];
+		const int32 Length = FMath::Min(Segment.Length, InMaxSize - Dictionary.Num());
+		// Keep the tail of a segment that does not fit whole
+		Dictionary.Append(InSamples[Segment.Sample].GetData() + Segment.Offset + Segment.Length - Length, Length);
+		if (Dictionary.Num() >= InMaxSize)
+		{
+			break;
+		}
+	}
+	return Dictionary;
+}
+
+bool FRedisCompressionDictionary::Compress(const uint8* InData, int32 InSize, TArray<uint8>& OutData) const
+{
+	z_stream Stream;
+	FMemory::Memzero(Stream);
+	// Raw deflate: no zlib header or checksum, which would be a noticeable share of a small value
+	if (deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return false;
+	}
+
+	const int32 Offset = OutData.Num();
+	const int32 Bound = (int32)deflateBound(&Stream, InSize);
+	OutData.AddUninitialized(Bound);
+
+	Stream.next_in = (Bytef*)InData;
+	Stream.avail_in = InSize;
+	Stream.next_out = OutData.GetData() + Offset;
+	Stream.avail_out = Bound;
+
+	const bool bResult = deflateSetDictionary(&Stream, Data.GetData(), Data.Num()) == Z_OK
+		&& deflate(&Stream, Z_FINISH) == Z_STREAM_END;
+	const int32 Written = Bound - (int32)Stream.avail_out;
+	deflateEnd(&Stream);
+
+	OutData.SetNum(bResult ? Offset + Written : Offset, false);
+	return bResult;
+}
+
+bool FRedisCompressionDictionary::Decompress(const uint8* InData, int32 InSize, uint8* OutData, int32 OutSize) const
+{
+	z_stream Stream;
+	FMemory::Memzero(Stream);
+	if (inflateInit2(&Stream, -MAX_WBITS) != Z_OK)
+	{
+		return false;
+	}
+
+	Stream.next_in = (Bytef*)InData;
+	Stream.avail_in = InSize;
+	Stream.next_out = OutData;
+	Stream.avail_out = OutSize;
+
+	// A raw stream has no header to announce the dictionary, so it is set up front
+	const bool bResult = inflateSetDictionary(&Stream, Data.GetData(), Data.Num()) == Z_OK
+		&& inflate(&Stream, Z_FINISH) == Z_STREAM_END
+		&& Stream.avail_out == 0;
+	inflateEnd(&Stream);
+
+	return bResult;
+}
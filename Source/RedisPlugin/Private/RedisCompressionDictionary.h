@@ -0,0 +1,58 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A preset dictionary for raw deflate, trained on sample values (see URedisDictionaryCommandlet).
+ * Values of a few hundred bytes share little with themselves but a lot with each other, which
+ * a stream compressor cannot use and a dictionary can. A dictionary is identified by the CRC32
+ * of its bytes; compressed values carry it, so any process that registered the same bytes
+ * can read them back.
+ */
+class FRedisCompressionDictionary
+{
+public:
+
+	/**
+	 * Field of the dictionary hash in Redis that holds the id of the dictionary new values are
+	 * written with. Every other field is a dictionary, named by its id.
+	 */
+	static const TCHAR* const CurrentField;
+
+	/** Deflate only looks back over a 32 KB window, minus its lookahead. */
+	static const int32 MaxSize = 32768 - 262;
+
+	/** Makes InData available for decompression in this process; the same bytes always give the same dictionary. */
+	static TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe> Register(TArray<uint8>&& InData);
+
+	/** Safe from any thread. */
+	static TSharedPtr<const FRedisCompressionDictionary, ESPMode::ThreadSafe> Find(uint32 InId);
+
+	/** At most InMaxSize bytes of the substrings the most samples have in common. */
+	static TArray<uint8> Train(const TArray<TArray<uint8>>& InSamples, int32 InMaxSize);
+
+	uint32 GetId() const
+	{
+		return Id;
+	}
+
+	const TArray<uint8>& GetData() const
+	{
+		return Data;
+	}
+
+	/** Raw deflate of InData against this dictionary, appended to OutData. */
+	bool Compress(const uint8* InData, int32 InSize, TArray<uint8>& OutData) const;
+
+	/** False unless InData inflates to exactly OutSize bytes. */
+	bool Decompress(const uint8* InData, int32 InSize, uint8* OutData, int32 OutSize) const;
+
+private:
+	FRedisCompressionDictionary(TArray<uint8>&& InData, uint32 InId);
+
+private:
+	TArray<uint8>	Data;
+	uint32			Id;
+};
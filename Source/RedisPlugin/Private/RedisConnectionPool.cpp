@@ -0,0 +1,281 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisConnectionPool.h"
+#include "RedisStats.h"
+#include "Async/ParallelFor.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+
+FRedisConnectionPool::FRedisConnectionPool() :
+	IdleTimeout(60.f),
+	ValidateAfter(10.f),
+	AcquireTimeout(2.f),
+	ConnectTimeout(1.f),
+	Port(0),
+	MinSize(0),
+	MaxSize(0),
+	NumTotal(0),
+	bShutdown(false),
+	NextReapTime(0.0)
+{
+	ReleaseEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FRedisConnectionPool::~FRedisConnectionPool()
+{
+	Shutdown();
+	FPlatformProcess::ReturnSynchEventToPool(ReleaseEvent);
+	ReleaseEvent = nullptr;
+}
+
+bool FRedisConnectionPool::Init(const FString& InHost, int32 InPort, const FString& InPassword, int32 InMinSize, int32 InMaxSize)
+{
+	Host = InHost;
+	Port = InPort;
+	Password = InPassword;
+	MaxSize = FMath::Max(InMaxSize, 1);
+	MinSize = FMath::Clamp(InMinSize, 0, MaxSize);
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		bShutdown = false;
+		NumTotal += MinSize;
+	}
+
+	// Pre-warm: connect + AUTH round trips overlap instead of adding up
+	TArray<TSharedPtr<URedisClient>> WarmClients;
+	WarmClients.SetNum(MinSize);
+	ParallelFor(MinSize, [this, &WarmClients](int32 Index)
+	{
+		WarmClients[Index] = NewClient();
+	});
+
+	const double Now = FPlatformTime::Seconds();
+	int32 WarmNum = 0;
+	{
+		FScopeLock ScopeLock(&Lock);
+		for (auto& it : WarmClients)
+		{
+			if (it.IsValid())
+			{
+				IdleClients.Add({ it, Now });
+				++WarmNum;
+			}
+			else
+			{
+				--NumTotal;
+			}
+		}
+	}
+
+	if (WarmNum < MinSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis pool pre-warmed %d of %d connections"), WarmNum, MinSize);
+	}
+	return MinSize == 0 || WarmNum > 0;
+}
+
+void FRedisConnectionPool::Shutdown()
+{
+	TArray<FIdleClient> Closing;
+	{
+		FScopeLock ScopeLock(&Lock);
+		bShutdown = true;
+		Closing = MoveTemp(IdleClients);
+		IdleClients.Reset();
+		NumTotal -= Closing.Num();
+	}
+	// Wake anyone blocked in Acquire so they see bShutdown
+	ReleaseEvent->Trigger();
+}
+
+TSharedPtr<URedisClient> FRedisConnectionPool::Acquire()
+{
+	const double Deadline = FPlatformTime::Seconds() + AcquireTimeout;
+
+	for (;;)
+	{
+		FIdleClient Idle;
+		bool bMayCreate = false;
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (bShutdown)
+			{
+				return nullptr;
+			}
+			if (IdleClients.Num())
+			{
+				Idle = IdleClients.Pop(false);
+			}
+			else if (NumTotal < MaxSize)
+			{
+				// Reserve the slot now so concurrent callers can't overshoot MaxSize
+				++NumTotal;
+				bMayCreate = true;
+			}
+		}
+
+		if (Idle.Client.IsValid())
+		{
+			const bool bFresh = FPlatformTime::Seconds() - Idle.ReleaseTime < ValidateAfter;
+			if ((bFresh && Idle.Client->IsConnected()) || Idle.Client->Ping())
+			{
+				const int32 WantedIndex = DbIndex.GetValue();
+				if (Idle.Client->GetDbIndex() == WantedIndex || Idle.Client->SelectIndex(WantedIndex))
+				{
+					return Idle.Client;
+				}
+			}
+			Discard();
+			continue;
+		}
+
+		if (bMayCreate)
+		{
+			TSharedPtr<URedisClient> Client = NewClient();
+			if (!Client.IsValid())
+			{
+				Discard();
+			}
+			return Client;
+		}
+
+		const double Remaining = Deadline - FPlatformTime::Seconds();
+		if (Remaining <= 0.0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Redis pool exhausted, all %d connections busy"), MaxSize);
+			return nullptr;
+		}
+		ReleaseEvent->Wait(FMath::Max(1, FMath::CeilToInt(Remaining * 1000.0)));
+	}
+}
+
+void FRedisConnectionPool::Release(TSharedPtr<URedisClient> InClient)
+{
+	if (!InClient.IsValid())
+	{
+		return;
+	}
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		// Connections opened before a Repoint still talk to the old server
+		if (!bShutdown && InClient->IsConnected() && InClient->GetPort() == Port && InClient->GetHost() == Host)
+		{
+			IdleClients.Add({ MoveTemp(InClient), FPlatformTime::Seconds() });
+		}
+		else
+		{
+			--NumTotal;
+		}
+	}
+	ReleaseEvent->Trigger();
+}
+
+void FRedisConnectionPool::SelectIndex(int32 InIndex)
+{
+	DbIndex.Set(InIndex);
+}
+
+void FRedisConnectionPool::Repoint(const FString& InHost, int32 InPort)
+{
+	TArray<FIdleClient> Closing;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Host = InHost;
+		Port = InPort;
+		Closing = MoveTemp(IdleClients);
+		IdleClients.Reset();
+		NumTotal -= Closing.Num();
+	}
+	ReleaseEvent->Trigger();
+}
+
+void FRedisConnectionPool::ReapIdle()
+{
+#if STATS
+	{
+		FScopeLock ScopeLock(&Lock);
+		INC_DWORD_STAT_BY(STAT_RedisPoolOpen, NumTotal);
+		INC_DWORD_STAT_BY(STAT_RedisPoolInUse, NumTotal - IdleClients.Num());
+	}
+#endif
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now < NextReapTime)
+	{
+		return;
+	}
+	NextReapTime = Now + 1.0;
+
+	TArray<FIdleClient> Closing;
+	{
+		FScopeLock ScopeLock(&Lock);
+		// Index 0 has been idle the longest
+		int32 ReapNum = 0;
+		while (ReapNum < IdleClients.Num()
+			&& NumTotal - ReapNum > MinSize
+			&& Now - IdleClients[ReapNum].ReleaseTime > IdleTimeout)
+		{
+			++ReapNum;
+		}
+		if (ReapNum == 0)
+		{
+			return;
+		}
+		Closing.Append(IdleClients.GetData(), ReapNum);
+		IdleClients.RemoveAt(0, ReapNum, false);
+		NumTotal -= ReapNum;
+	}
+}
+
+int32 FRedisConnectionPool::GetNumIdle() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return IdleClients.Num();
+}
+
+int32 FRedisConnectionPool::GetNumTotal() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumTotal;
+}
+
+TSharedPtr<URedisClient> FRedisConnectionPool::NewClient()
+{
+	FString ConnectHost;
+	int32 ConnectPort;
+	{
+		FScopeLock ScopeLock(&Lock);
+		ConnectHost = Host;
+		ConnectPort = Port;
+	}
+
+	TSharedPtr<URedisClient> NewRedisClient(new URedisClient());
+	if (!NewRedisClient->ConnectToRedis(ConnectHost, ConnectPort, Password, ConnectTimeout))
+	{
+		return nullptr;
+	}
+
+	const int32 WantedIndex = DbIndex.GetValue();
+	if (WantedIndex != 0 && !NewRedisClient->SelectIndex(WantedIndex))
+	{
+		return nullptr;
+	}
+
+	if (OnConnected)
+	{
+		OnConnected(*NewRedisClient);
+	}
+	return NewRedisClient;
+}
+
+void FRedisConnectionPool::Discard()
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		--NumTotal;
+	}
+	ReleaseEvent->Trigger();
+}
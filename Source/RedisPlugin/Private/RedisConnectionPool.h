@@ -0,0 +1,157 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "RedisClient.h"
+
+class FEvent;
+
+/**
+ * Bounded pool of blocking URedisClient connections.
+ * Checkout and release only hold the lock long enough to push or pop a pointer; connecting,
+ * validating and closing always happen outside it. Idle connections are reused most recent
+ * first, so rarely needed ones sink to the bottom where ReapIdle closes them.
+ */
+class FRedisConnectionPool
+{
+public:
+
+	FRedisConnectionPool();
+	~FRedisConnectionPool();
+
+	/** Opens MinSize connections in parallel. Returns false if none of them could connect. */
+	bool Init(const FString& InHost, int32 InPort, const FString& InPassword, int32 InMinSize, int32 InMaxSize);
+
+	/** Closes every idle connection. Connections still checked out are closed on release. */
+	void Shutdown();
+
+	/**
+	 * Returns an idle connection, opens a new one while below MaxSize, or waits up to
+	 * AcquireTimeout for one to be released. Returns null on failure.
+	 */
+	TSharedPtr<URedisClient> Acquire();
+
+	void Release(TSharedPtr<URedisClient> InClient);
+
+	/**
+	 * A new connection that is never counted or pooled, for blocking reads that hold on to it
+	 * indefinitely. Set up like pooled ones, against the address of the latest Repoint.
+	 */
+	TSharedPtr<URedisClient> OpenDedicated()
+	{
+		return NewClient();
+	}
+
+	/** Applied to idle connections lazily, on their next checkout. */
+	void SelectIndex(int32 InIndex);
+
+	/**
+	 * Points the pool at a new server, e.g. after a failover. Idle connections are dropped now;
+	 * connections still checked out are dropped when released. Never blocks on the network.
+	 */
+	void Repoint(const FString& InHost, int32 InPort);
+
+	/** Closes connections idle for longer than IdleTimeout, never going below MinSize. Once a tick, so it also reports the pool stats. */
+	void ReapIdle();
+
+	int32 GetNumIdle() const;
+
+	int32 GetNumTotal() const;
+
+public:
+	/** Seconds an idle connection is kept above MinSize. */
+	float	IdleTimeout;
+
+	/** Connections idle for longer than this are PINGed before being handed out. */
+	float	ValidateAfter;
+
+	/** Longest Acquire waits for a release once MaxSize connections are open. */
+	float	AcquireTimeout;
+
+	/** Seconds a new connection may take to connect. */
+	float	ConnectTimeout;
+
+	/** Runs on every new connection before it is handed out, on whichever thread opened it. */
+	TFunction<void(URedisClient&)>	OnConnected;
+
+private:
+
+	TSharedPtr<URedisClient> NewClient();
+
+	void Discard();
+
+private:
+	struct FIdleClient
+	{
+		TSharedPtr<URedisClient>	Client;
+		double						ReleaseTime;
+	};
+
+	FString		Host;
+	int32		Port;
+	FString		Password;
+	int32		MinSize;
+	int32		MaxSize;
+
+	mutable FCriticalSection	Lock;
+	TArray<FIdleClient>			IdleClients;
+	int32						NumTotal;
+	bool						bShutdown;
+
+	/** Auto-reset, triggered whenever a connection or a slot is given back. */
+	FEvent*				ReleaseEvent;
+	FThreadSafeCounter	DbIndex;
+	double				NextReapTime;
+};
+
+/** Checks a connection out of the pool for the lifetime of the scope. */
+class FRedisPooledClient
+{
+public:
+
+	explicit FRedisPooledClient(FRedisConnectionPool* InPool) :
+		Pool(InPool)
+	{
+		if (Pool)
+		{
+			const uint64 AcquireCycles = FPlatformTime::Cycles64();
+			Client = Pool->Acquire();
+			if (Client.IsValid())
+			{
+				Client->SetQueueCycles(FPlatformTime::Cycles64() - AcquireCycles);
+			}
+		}
+	}
+
+	~FRedisPooledClient()
+	{
+		if (Pool && Client.IsValid())
+		{
+			Pool->Release(MoveTemp(Client));
+		}
+	}
+
+	URedisClient* operator->() const
+	{
+		return Client.Get();
+	}
+
+	URedisClient& operator*() const
+	{
+		return *Client;
+	}
+
+	explicit operator bool() const
+	{
+		return Client.IsValid();
+	}
+
+private:
+	FRedisPooledClient(const FRedisPooledClient&) = delete;
+	FRedisPooledClient& operator=(const FRedisPooledClient&) = delete;
+
+	FRedisConnectionPool*		Pool;
+	TSharedPtr<URedisClient>	Client;
+};
@@ -0,0 +1,123 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisDictionaryCommandlet.h"
+#include "RedisClient.h"
+#include "RedisCompression.h"
+#include "RedisCompressionDictionary.h"
+#include "RedisScanIterator.h"
+#include "Misc/Parse.h"
+
+/** Values taken from one hash at most, so a few huge hashes cannot crowd out the rest. */
+static const int32 RedisDictionarySamplesPerKey = 100;
+
+URedisDictionaryCommandlet::URedisDictionaryCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 URedisDictionaryCommandlet::Main(const FString& Params)
+{
+	FString Host = TEXT("127.0.0.1");
+	int32 Port = 6379;
+	FString Password;
+	FString Match = TEXT("*");
+	FString Key;
+	int32 MaxSamples = 20000;
+	int32 Size = FRedisCompressionDictionary::MaxSize;
+	bool bActivate = true;
+
+	FParse::Value(*Params, TEXT("Host="), Host);
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("Password="), Password);
+	FParse::Value(*Params, TEXT("Match="), Match);
+	FParse::Value(*Params, TEXT("Key="), Key);
+	FParse::Value(*Params, TEXT("Samples="), MaxSamples);
+	FParse::Value(*Params, TEXT("Size="), Size);
+	FParse::Bool(*Params, TEXT("Activate="), bActivate);
+
+	if (Key.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisDictionary needs -Key= naming the hash to store the dictionary in"));
+		return 1;
+	}
+
+	URedisClient RedisClient;
+	if (!RedisClient.ConnectToRedis(Host, Port, Password))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisDictionary could not connect to %s:%d"), *Host, Port);
+		return 1;
+	}
+
+	TArray<TArray<uint8>> Samples;
+	FString Cursor = TEXT("0");
+	do
+	{
+		TArray<FString> Keys;
+		if (!RedisClient.Scan(ERedisScanType::Keys, FString(), Cursor, Match, 1000, Keys))
+		{
+			UE_LOG(LogTemp, Error, TEXT("RedisDictionary SCAN failed: %s"), *RedisClient.GetLastError());
+			return 1;
+		}
+
+		for (const FString& it : Keys)
+		{
+			FString Type;
+			if (it == Key || !RedisClient.TypeKey(it, Type) || Type != TEXT("hash"))
+			{
+				continue;
+			}
+
+			// One HSCAN page, enough to see what this hash's values look like
+			FString FieldCursor = TEXT("0");
+			TArray<FString> FieldValues;
+			RedisClient.Scan(ERedisScanType::Hash, it, FieldCursor, TEXT("*"), RedisDictionarySamplesPerKey, FieldValues);
+			for (int32 i = 1; i < FieldValues.Num() && Samples.Num() < MaxSamples; i += 2)
+			{
+				const FString& Value = FieldValues[i];
+				// Empty, or already compressed
+				if (Value.IsEmpty() || Value[0] == TEXT('\0'))
+				{
+					continue;
+				}
+				FTCHARToUTF8 Utf8(*Value);
+				Samples.Emplace((const uint8*)Utf8.Get(), Utf8.Length());
+			}
+		}
+	}
+	while (Cursor != TEXT("0") && Samples.Num() < MaxSamples);
+
+	if (Samples.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisDictionary found no hash values under %s"), *Match);
+		return 1;
+	}
+
+	TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe> Dictionary = FRedisCompressionDictionary::Register(FRedisCompressionDictionary::Train(Samples, Size));
+
+	// Measured on the samples themselves, so an upper bound on what live values will see
+	int64 RawBytes = 0;
+	int64 CompressedBytes = 0;
+	TArray<uint8> Compressed;
+	for (const TArray<uint8>& Sample : Samples)
+	{
+		Compressed.Reset();
+		RawBytes += Sample.Num();
+		CompressedBytes += Dictionary->Compress(Sample.GetData(), Sample.Num(), Compressed) ? FMath::Min(Sample.Num(), FRedisCompression::DictionaryHeaderSize + Compressed.Num()) : Sample.Num();
+	}
+	UE_LOG(LogTemp, Display, TEXT("RedisDictionary trained %d bytes as %u on %d values, %lld bytes compress to %lld"),
+		Dictionary->GetData().Num(), Dictionary->GetId(), Samples.Num(), RawBytes, CompressedBytes);
+
+	const FString DictionaryId = LexToString(Dictionary->GetId());
+	if (!RedisClient.HSetBytes(Key, DictionaryId, Dictionary->GetData())
+		|| (bActivate && !RedisClient.HSet(Key, FRedisCompressionDictionary::CurrentField, DictionaryId)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RedisDictionary could not store the dictionary in %s: %s"), *Key, *RedisClient.GetLastError());
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("RedisDictionary stored %u in %s%s"), Dictionary->GetId(), *Key, bActivate ? TEXT(" as the current dictionary") : TEXT(""));
+	return 0;
+}
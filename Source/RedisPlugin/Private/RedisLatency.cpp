@@ -0,0 +1,241 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisLatency.h"
+#include "AsyncRedisDefines.h"
+#include "HAL/PlatformAtomics.h"
+#include "Misc/FileHelper.h"
+
+/** Longest command name kept, e.g. "ZRANGEBYSCORE". */
+static const int32 RedisLatencyNameSize = 24;
+
+struct FRedisCommandHistograms
+{
+	ANSICHAR				Name[RedisLatencyNameSize];
+	FRedisLatencyHistogram	Queue;
+	FRedisLatencyHistogram	RoundTrip;
+};
+
+/** Claimed by setting Hash, usable once Histograms is published. Never released. */
+struct FRedisCommandSlot
+{
+	volatile int32					Hash;
+	FRedisCommandHistograms* volatile	Histograms;
+};
+
+static FRedisCommandSlot RedisCommandSlots[FRedisLatency::MaxCommands];
+
+static FRedisCommandHistograms* GetHistograms(const FRedisCommandSlot& InSlot)
+{
+	// Published once, behind the full barrier of InterlockedExchangePtr, and never changed
+	return InSlot.Histograms;
+}
+
+FRedisLatencyHistogram::FRedisLatencyHistogram()
+{
+	Reset();
+}
+
+void FRedisLatencyHistogram::Record(uint64 InMicroseconds)
+{
+	FPlatformAtomics::InterlockedIncrement(&Buckets[GetBucket(InMicroseconds)]);
+
+	int64 CurrentMax = FPlatformAtomics::AtomicRead(&Max);
+	while ((int64)InMicroseconds > CurrentMax)
+	{
+		const int64 Previous = FPlatformAtomics::InterlockedCompareExchange(&Max, (int64)InMicroseconds, CurrentMax);
+		if (Previous == CurrentMax)
+		{
+			break;
+		}
+		CurrentMax = Previous;
+	}
+}
+
+void FRedisLatencyHistogram::Reset()
+{
+	for (int32 i = 0; i < BucketNum; ++i)
+	{
+		FPlatformAtomics::InterlockedExchange(&Buckets[i], 0);
+	}
+	FPlatformAtomics::InterlockedExchange(&Max, 0);
+}
+
+void FRedisLatencyHistogram::GetPercentiles(FRedisLatencyPercentiles& OutPercentiles) const
+{
+	// One snapshot, so the percentiles agree with each other and with the count
+	int64 Snapshot[BucketNum];
+	int64 Count = 0;
+	for (int32 i = 0; i < BucketNum; ++i)
+	{
+		Snapshot[i] = FPlatformAtomics::AtomicRead(&Buckets[i]);
+		Count += Snapshot[i];
+	}
+
+	OutPercentiles.Count = Count;
+	OutPercentiles.P50 = GetPercentile(Snapshot, Count, 0.5) / 1000.f;
+	OutPercentiles.P90 = GetPercentile(Snapshot, Count, 0.9) / 1000.f;
+	OutPercentiles.P99 = GetPercentile(Snapshot, Count, 0.99) / 1000.f;
+	OutPercentiles.P999 = GetPercentile(Snapshot, Count, 0.999) / 1000.f;
+	OutPercentiles.Max = FPlatformAtomics::AtomicRead(&Max) / 1000.f;
+}
+
+int32 FRedisLatencyHistogram::GetBucket(uint64 InValue)
+{
+	if (InValue < 2 * SubBucketNum)
+	{
+		return (int32)InValue;
+	}
+
+	const int32 Exponent = (int32)FMath::FloorLog2_64(InValue);
+	if (Exponent > MaxExponent)
+	{
+		return BucketNum - 1;
+	}
+	const int32 Shift = Exponent - SubBucketBits;
+	return (Exponent - SubBucketBits + 1) * SubBucketNum + (int32)((InValue >> Shift) & (SubBucketNum - 1));
+}
+
+uint64 FRedisLatencyHistogram::GetBucketValue(int32 InBucket)
+{
+	const int32 Group = InBucket / SubBucketNum;
+	if (Group <= 1)
+	{
+		return InBucket;
+	}
+
+	const int32 Shift = Group - 1;
+	const uint64 Lowest = (uint64)(SubBucketNum + InBucket % SubBucketNum) << Shift;
+	return Lowest + ((uint64)1 << Shift) - 1;
+}
+
+uint64 FRedisLatencyHistogram::GetPercentile(const int64* InBuckets, int64 InCount, double InPercentile) const
+{
+	if (InCount == 0)
+	{
+		return 0;
+	}
+
+	const int64 Rank = FMath::Max<int64>(1, (int64)FMath::CeilToDouble(InCount * InPercentile));
+	int64 Seen = 0;
+	for (int32 i = 0; i < BucketNum; ++i)
+	{
+		Seen += InBuckets[i];
+		if (Seen >= Rank)
+		{
+			// A bucket's top can be above anything actually recorded
+			return FMath::Min<uint64>(GetBucketValue(i), FPlatformAtomics::AtomicRead(&Max));
+		}
+	}
+	return FPlatformAtomics::AtomicRead(&Max);
+}
+
+int32 FRedisLatency::FindCommand(FAnsiStringView InName)
+{
+	// Upper case, so "get" and "GET" share a slot
+	ANSICHAR Name[RedisLatencyNameSize] = {};
+	const int32 NameLen = FMath::Min(InName.Len(), RedisLatencyNameSize - 1);
+	uint32 Hash = 2166136261u;
+	for (int32 i = 0; i < NameLen; ++i)
+	{
+		Name[i] = FCharAnsi::ToUpper(InName[i]);
+		Hash = (Hash ^ (uint8)Name[i]) * 16777619u;
+	}
+	// 0 marks a free slot
+	const int32 SlotHash = Hash ? (int32)Hash : 1;
+
+	for (int32 Probe = 0; Probe < MaxCommands; ++Probe)
+	{
+		FRedisCommandSlot& Slot = RedisCommandSlots[(Hash + Probe) % MaxCommands];
+		int32 Claimed = FPlatformAtomics::AtomicRead(&Slot.Hash);
+		if (Claimed == 0)
+		{
+			Claimed = FPlatformAtomics::InterlockedCompareExchange(&Slot.Hash, SlotHash, 0);
+			if (Claimed == 0)
+			{
+				FRedisCommandHistograms* Histograms = new FRedisCommandHistograms();
+				FMemory::Memcpy(Histograms->Name, Name, sizeof(Name));
+				FPlatformAtomics::InterlockedExchangePtr((void**)&Slot.Histograms, Histograms);
+				return (Hash + Probe) % MaxCommands;
+			}
+		}
+
+		if (Claimed == SlotHash)
+		{
+			FRedisCommandHistograms* Histograms = GetHistograms(Slot);
+			if (!Histograms)
+			{
+				// Being claimed by another thread right now; this one command goes unrecorded
+				return INDEX_NONE;
+			}
+			if (FCStringAnsi::Strcmp(Histograms->Name, Name) == 0)
+			{
+				return (Hash + Probe) % MaxCommands;
+			}
+		}
+	}
+	return INDEX_NONE;
+}
+
+void FRedisLatency::Record(int32 InCommand, uint64 InQueueCycles, uint64 InRoundTripCycles)
+{
+	if (InCommand == INDEX_NONE)
+	{
+		return;
+	}
+
+	FRedisCommandHistograms* Histograms = GetHistograms(RedisCommandSlots[InCommand]);
+	if (Histograms)
+	{
+		const double MicrosecondsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000000.0;
+		Histograms->Queue.Record((uint64)(InQueueCycles * MicrosecondsPerCycle));
+		Histograms->RoundTrip.Record((uint64)(InRoundTripCycles * MicrosecondsPerCycle));
+	}
+}
+
+void FRedisLatency::GetLatencies(TArray<FRedisCommandLatency>& OutLatencies)
+{
+	OutLatencies.Reset();
+	for (FRedisCommandSlot& Slot : RedisCommandSlots)
+	{
+		FRedisCommandHistograms* Histograms = GetHistograms(Slot);
+		if (Histograms)
+		{
+			FRedisCommandLatency& Latency = OutLatencies.AddDefaulted_GetRef();
+			Latency.Command = ANSI_TO_TCHAR(Histograms->Name);
+			Histograms->Queue.GetPercentiles(Latency.Queue);
+			Histograms->RoundTrip.GetPercentiles(Latency.RoundTrip);
+		}
+	}
+	OutLatencies.Sort([](const FRedisCommandLatency& A, const FRedisCommandLatency& B)
+	{
+		return A.Command < B.Command;
+	});
+}
+
+bool FRedisLatency::DumpCsv(const FString& InPath)
+{
+	TArray<FRedisCommandLatency> Latencies;
+	GetLatencies(Latencies);
+
+	FString Csv = TEXT("Command,Count,QueueP50Ms,QueueP90Ms,QueueP99Ms,QueueP999Ms,QueueMaxMs,RttP50Ms,RttP90Ms,RttP99Ms,RttP999Ms,RttMaxMs\n");
+	for (const FRedisCommandLatency& it : Latencies)
+	{
+		Csv += FString::Printf(TEXT("%s,%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"), *it.Command, it.RoundTrip.Count,
+			it.Queue.P50, it.Queue.P90, it.Queue.P99, it.Queue.P999, it.Queue.Max,
+			it.RoundTrip.P50, it.RoundTrip.P90, it.RoundTrip.P99, it.RoundTrip.P999, it.RoundTrip.Max);
+	}
+	return FFileHelper::SaveStringToFile(Csv, *InPath);
+}
+
+void FRedisLatency::Reset()
+{
+	for (FRedisCommandSlot& Slot : RedisCommandSlots)
+	{
+		FRedisCommandHistograms* Histograms = GetHistograms(Slot);
+		if (Histograms)
+		{
+			Histograms->Queue.Reset();
+			Histograms->RoundTrip.Reset();
+		}
+	}
+}
@@ -0,0 +1,68 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+struct FRedisCommandLatency;
+struct FRedisLatencyPercentiles;
+
+/**
+ * Log-linear histogram of microsecond values, in the spirit of HdrHistogram: exact below 32,
+ * then 16 buckets per power of two (within 6.25%) up to about 35 minutes. Recording is a
+ * couple of interlocked adds, safe from any number of threads; reads are approximate while
+ * values keep coming in.
+ */
+class FRedisLatencyHistogram
+{
+public:
+
+	FRedisLatencyHistogram();
+
+	void Record(uint64 InMicroseconds);
+
+	void Reset();
+
+	/** In milliseconds. */
+	void GetPercentiles(FRedisLatencyPercentiles& OutPercentiles) const;
+
+private:
+	static const int32 SubBucketBits = 4;
+	static const int32 SubBucketNum = 1 << SubBucketBits;
+	static const int32 MaxExponent = 31;
+	static const int32 BucketNum = (MaxExponent - SubBucketBits + 2) * SubBucketNum;
+
+	static int32 GetBucket(uint64 InValue);
+
+	/** Largest value that lands in InBucket. */
+	static uint64 GetBucketValue(int32 InBucket);
+
+	uint64 GetPercentile(const int64* InBuckets, int64 InCount, double InPercentile) const;
+
+private:
+	volatile int64		Buckets[BucketNum];
+	volatile int64		Max;
+};
+
+/**
+ * Process-wide latency of every Redis command type, as the time a command waited on the client
+ * side (for a pooled connection, or in the async engine's queue) and its network round trip.
+ * Commands are told apart by name and get their histograms on first use, without locks.
+ */
+struct FRedisLatency
+{
+	/** Distinct command names tracked; later ones are not recorded. */
+	static const int32 MaxCommands = 128;
+
+	/** Slot of a command name such as "HGET", claimed on first use; INDEX_NONE when out of slots. */
+	static int32 FindCommand(FAnsiStringView InName);
+
+	static void Record(int32 InCommand, uint64 InQueueCycles, uint64 InRoundTripCycles);
+
+	static void GetLatencies(TArray<FRedisCommandLatency>& OutLatencies);
+
+	static bool DumpCsv(const FString& InPath);
+
+	static void Reset();
+};
@@ -0,0 +1,85 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisListConsumer.h"
+#include "RedisClient.h"
+
+FRedisListConsumer::FRedisListConsumer() :
+	bRecovered(false)
+{
+}
+
+FRedisListConsumer::~FRedisListConsumer()
+{
+	Shutdown();
+}
+
+bool FRedisListConsumer::Start(const FRedisListConsumerSettings& InSettings)
+{
+	Settings = InSettings;
+	// 0 would block forever and never notice Stop
+	Settings.Timeout = FMath::Max(0.01f, Settings.Timeout);
+	if (!Settings.ProcessingList.IsEmpty() && Settings.Keys.Num() > 1)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis BLMOVE takes one source list, only %s is consumed into %s"), *Settings.Keys[0], *Settings.ProcessingList);
+	}
+	return StartThread(TEXT("RedisListConsumer"));
+}
+
+bool FRedisListConsumer::OnConnected(URedisClient& InRedisClient)
+{
+	if (Settings.ProcessingList.IsEmpty() || bRecovered)
+	{
+		return true;
+	}
+
+	// Moved in by an earlier run that never acknowledged them; the oldest sits at the tail
+	TArray<FString> Jobs;
+	if (!InRedisClient.LRange(Settings.ProcessingList, 0, -1, Jobs))
+	{
+		return false;
+	}
+	for (int32 i = Jobs.Num() - 1; i >= 0; --i)
+	{
+		OnJob(Settings.Keys[0], MoveTemp(Jobs[i]));
+	}
+	bRecovered = true;
+	return true;
+}
+
+bool FRedisListConsumer::Poll(URedisClient& InRedisClient)
+{
+	FString Key;
+	FString Job;
+	bool bPopped = false;
+	if (Settings.ProcessingList.IsEmpty())
+	{
+		if (!InRedisClient.BPop(Settings.PopFrom, Settings.Keys, Settings.Timeout, Key, Job, bPopped))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		Key = Settings.Keys[0];
+		if (!InRedisClient.BLMove(Key, Settings.ProcessingList, Settings.PopFrom, Settings.Timeout, Job, bPopped))
+		{
+			return false;
+		}
+	}
+
+	if (bPopped)
+	{
+		OnJob(Key, MoveTemp(Job));
+	}
+	return true;
+}
+
+float FRedisListConsumer::GetBlockTime() const
+{
+	return Settings.Timeout;
+}
+
+FString FRedisListConsumer::GetDescription() const
+{
+	return FString::Printf(TEXT("list consumer of %s"), *FString::Join(Settings.Keys, TEXT(", ")));
+}
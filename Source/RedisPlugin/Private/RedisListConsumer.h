@@ -0,0 +1,41 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RedisBlockingConsumer.h"
+#include "AsyncRedisDefines.h"
+
+/**
+ * Pops jobs off lists with BLPOP/BRPOP, or BLMOVE into a processing list, on a connection of
+ * its own. An idle consumer costs one request per Timeout instead of one per poll.
+ */
+class FRedisListConsumer : public FRedisBlockingConsumer
+{
+public:
+
+	FRedisListConsumer();
+	virtual ~FRedisListConsumer();
+
+	bool Start(const FRedisListConsumerSettings& InSettings);
+
+public:
+	/** Consumer thread: one job and the list it came from. */
+	TFunction<void(const FString&, FString&&)>	OnJob;
+
+protected:
+	/* FRedisBlockingConsumer */
+	virtual bool OnConnected(URedisClient& InRedisClient) override;
+
+	virtual bool Poll(URedisClient& InRedisClient) override;
+
+	virtual float GetBlockTime() const override;
+
+	virtual FString GetDescription() const override;
+
+private:
+	FRedisListConsumerSettings	Settings;
+
+	/** Consumer thread only: jobs left in ProcessingList were handed out again. */
+	bool	bRecovered;
+};
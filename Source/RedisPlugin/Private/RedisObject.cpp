@@ -2,9 +2,23 @@
 
 #include "RedisObject.h"
 #include "RedisClient.h"
-#include "AsyncRedisTask.h"
+#include "RedisConnectionPool.h"
+#include "RedisAsyncEngine.h"
+#include "RedisCluster.h"
+#include "RedisReplicaSet.h"
+#include "RedisSentinel.h"
+#include "RedisSubscriber.h"
+#include "RedisStreamConsumer.h"
+#include "RedisListConsumer.h"
+#include "RedisStats.h"
+#include "RedisReplyParser.h"
+#include "RedisStructLayout.h"
+#include "RedisCompression.h"
+#include "RedisCompressionDictionary.h"
+#include "RedisLatency.h"
 #include "LatentActions.h"
-#include "RedisSubscribeObject.h"
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
 
 IMPLEMENT_ASYNC_RESULTS(FAsyncResultNoReturn, NoReturn);
 IMPLEMENT_ASYNC_RESULTS(FAsyncResultExistsKey, ExistsKey);
@@ -15,6 +29,23 @@ IMPLEMENT_ASYNC_RESULTS(FAsyncResultHGet, HGet);
 IMPLEMENT_ASYNC_RESULTS(FAsyncResultHMGet, HMGet);
 IMPLEMENT_ASYNC_RESULTS(FAsyncResultHGetAll, HGetAll);
 IMPLEMENT_ASYNC_RESULTS(FAsyncResultSMembers, SMembers);
+IMPLEMENT_ASYNC_RESULTS(FAsyncResultPipeline, Pipeline);
+IMPLEMENT_ASYNC_RESULTS(FAsyncResultZRange, ZRange);
+IMPLEMENT_ASYNC_RESULTS(FAsyncResultZScore, ZScore);
+IMPLEMENT_ASYNC_RESULTS(FAsyncResultScript, Script);
+IMPLEMENT_ASYNC_RESULTS(FAsyncResultScan, Scan);
+IMPLEMENT_ASYNC_RESULTS(FAsyncResultStream, Stream);
+IMPLEMENT_ASYNC_RESULTS(FAsyncResultJob, Job);
+
+/** For requests with no engine to go to: the caller still gets its failed result. */
+static void FailAsyncRequest(FRedisAsyncRequest* InRequest)
+{
+	if (InRequest->OnReply)
+	{
+		InRequest->OnReply(nullptr);
+	}
+	delete InRequest;
+}
 
 void URedisObject::Init(const FString& InHost, int32 InPort, const FString& InPassword)
 {
@@ -25,23 +56,106 @@ void URedisObject::Init(const FString& InHost, int32 InPort, const FString& InPa
 	Host = InHost;
 	Port = InPort;
 	Password = InPassword;
-	SyncRedisClient = FindOrNewRedisClient();
-	if (SyncRedisClient)
+
+	if (bClusterMode || ShardHosts.Num())
 	{
-		if (SyncRedisClient->ConnectToRedis(Host, Port, Password))
+		// Pools and engines are per node, the cluster opens them as it discovers the topology
+		Cluster = MakeShared<FRedisCluster, ESPMode::ThreadSafe>();
+		Cluster->MinPoolSize = MinPoolSize;
+		Cluster->MaxPoolSize = MaxPoolSize;
+		Cluster->PoolIdleTimeout = PoolIdleTimeout;
+		Cluster->PoolValidateAfter = PoolValidateAfter;
+		Cluster->AsyncConnectionNum = AsyncConnectionNum;
+		Cluster->OnConnected = [this](URedisClient& InRedisClient)
 		{
-			bInitFinished = true;
+			LoadScripts(InRedisClient);
+		};
+		if (bClusterMode)
+		{
+			bInitFinished = Cluster->Init(Host, Port, Password);
+		}
+		else
+		{
+			bInitFinished = Cluster->InitSharded(ShardHosts, Password, ShardVirtualNodes);
 		}
+
+		if (ReplicaHosts.Num() || SentinelHosts.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Redis ReplicaHosts and SentinelHosts are ignored in cluster and sharded mode"));
+		}
+
+		// Same node Publish goes to: cluster PUBLISH reaches every node, shards are independent servers
+		FString SubscribeHost = Host;
+		int32 SubscribePort = Port;
+		Cluster->GetNodeAddress(FString(), SubscribeHost, SubscribePort);
+		StartSubscriber(SubscribeHost, SubscribePort);
 	}
+	else
+	{
+		FString PrimaryHost = Host;
+		int32 PrimaryPort = Port;
+		if (SentinelHosts.Num())
+		{
+			FRedisSentinel::ResolveMaster(SentinelHosts, SentinelMasterName, ConnectTimeout, PrimaryHost, PrimaryPort);
+		}
 
-	int32 FreeClientNum = 0;
+		ConnectionPool = MakeShareable(new FRedisConnectionPool());
+		ConnectionPool->IdleTimeout = PoolIdleTimeout;
+		ConnectionPool->ValidateAfter = PoolValidateAfter;
+		ConnectionPool->ConnectTimeout = ConnectTimeout;
+		ConnectionPool->OnConnected = [this](URedisClient& InRedisClient)
+		{
+			LoadScripts(InRedisClient);
+		};
+		if (ConnectionPool->Init(PrimaryHost, PrimaryPort, Password, MinPoolSize, MaxPoolSize))
+		{
+			bInitFinished = true;
+		}
+
+		AsyncEngine = MakeShareable(new FRedisAsyncEngine());
+		if (!AsyncEngine->Start(PrimaryHost, PrimaryPort, Password, AsyncConnectionNum))
+		{
+			AsyncEngine.Reset();
+		}
+
+		StartSubscriber(PrimaryHost, PrimaryPort);
+
+		if (SentinelHosts.Num())
+		{
+			StartSentinel(PrimaryHost, PrimaryPort);
+		}
+
+		if (ReplicaHosts.Num())
+		{
+			ReplicaSet = MakeShareable(new FRedisReplicaSet());
+			ReplicaSet->bLeastOutstanding = ReplicaBalance == ERedisReplicaBalance::LeastOutstanding;
+			ReplicaSet->MinPoolSize = MinPoolSize;
+			ReplicaSet->MaxPoolSize = MaxPoolSize;
+			ReplicaSet->PoolIdleTimeout = PoolIdleTimeout;
+			ReplicaSet->PoolValidateAfter = PoolValidateAfter;
+			ReplicaSet->AsyncConnectionNum = AsyncConnectionNum;
+			// The replica set is shut down before the engine
+			FRedisAsyncEngine* Engine = AsyncEngine.Get();
+			ReplicaSet->OnFallback = [Engine](FRedisAsyncRequest* InRequest)
+			{
+				if (Engine)
+				{
+					Engine->Submit(InRequest);
+				}
+				else
+				{
+					FailAsyncRequest(InRequest);
+				}
+			};
+			// Reads fall back to the primary while no replica answers
+			ReplicaSet->Init(ReplicaHosts, Password);
+		}
+	}
 
-// 	for (int i = 0; i < FreeClientNum; ++i)
-// 	{
-// 		TSharedPtr<URedisClient> NewRedisClient(new URedisClient());
-// 		NewRedisClient->ConnectToRedis(Host, Port, Password);
-// 		IdleRedisClients.Push(NewRedisClient);
-// 	}
+	if (bInitFinished && !CompressionDictionaryKey.IsEmpty())
+	{
+		LoadCompressionDictionaries();
+	}
 
 	ResultsPoolSize = 100;
 
@@ -60,11 +174,100 @@ void URedisObject::Init(const FString& InHost, int32 InPort, const FString& InPa
 }
 
 
+void URedisObject::BeginDestroy()
+{
+	// They read through the pool's or the cluster's addresses and report back into this object
+	for (auto& it : StreamConsumers)
+	{
+		it.Value.Consumer->Stop();
+		StoppingConsumers.Add(it.Value.Consumer);
+	}
+	for (auto& it : ListConsumers)
+	{
+		it.Value.Consumer->Stop();
+		StoppingConsumers.Add(it.Value.Consumer);
+	}
+	for (auto& it : StoppingConsumers)
+	{
+		it->Shutdown();
+	}
+	StreamConsumers.Reset();
+	ListConsumers.Reset();
+	StoppingConsumers.Reset();
+
+	// Stopped before what it re-points: the pool, the engine and the subscriber
+	if (Sentinel.IsValid())
+	{
+		Sentinel->Shutdown();
+		Sentinel.Reset();
+	}
+
+	if (Subscriber.IsValid())
+	{
+		Subscriber->Shutdown();
+		Subscriber.Reset();
+	}
+
+	// Before the engine its failed reads fall back to
+	if (ReplicaSet.IsValid())
+	{
+		ReplicaSet->Shutdown();
+		ReplicaSet.Reset();
+	}
+
+	if (AsyncEngine.IsValid())
+	{
+		AsyncEngine->Shutdown();
+		AsyncEngine.Reset();
+	}
+
+	// Pool-thread work (transactions) reports back into this object
+	while (BackgroundTasks.GetValue() > 0)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	if (Cluster.IsValid())
+	{
+		Cluster->Shutdown();
+		Cluster.Reset();
+	}
+
+	if (ConnectionPool.IsValid())
+	{
+		ConnectionPool->Shutdown();
+		ConnectionPool.Reset();
+	}
+
+	if (TickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+
+	Super::BeginDestroy();
+}
+
 bool URedisObject::Reconnect()
 {
-	if (!bInitFinished)
+	if (!bInitFinished && Cluster.IsValid())
 	{
-		if (SyncRedisClient->ConnectToRedis(Host, Port, Password))
+		bInitFinished = bClusterMode ? Cluster->Init(Host, Port, Password) : Cluster->InitSharded(ShardHosts, Password, ShardVirtualNodes);
+	}
+	else if (!bInitFinished && ConnectionPool.IsValid())
+	{
+		FString PrimaryHost = Host;
+		int32 PrimaryPort = Port;
+		if (SentinelHosts.Num())
+		{
+			FRedisSentinel::ResolveMaster(SentinelHosts, SentinelMasterName, ConnectTimeout, PrimaryHost, PrimaryPort);
+			if (AsyncEngine.IsValid())
+			{
+				AsyncEngine->Repoint(PrimaryHost, PrimaryPort);
+			}
+			StartSentinel(PrimaryHost, PrimaryPort);
+		}
+		if (ConnectionPool->Init(PrimaryHost, PrimaryPort, Password, MinPoolSize, MaxPoolSize))
 		{
 			bInitFinished = true;
 		}
@@ -74,19 +277,46 @@ bool URedisObject::Reconnect()
 
 void URedisObject::Quit()
 {
-	if (SyncRedisClient.Get())
+	if (Sentinel.IsValid())
+	{
+		Sentinel->Shutdown();
+		Sentinel.Reset();
+	}
+	if (ConnectionPool.IsValid())
 	{
-		 SyncRedisClient->Quit();
+		 ConnectionPool->Shutdown();
 		 bInitFinished = false;
 	}
+	if (Cluster.IsValid())
+	{
+		Cluster->Shutdown();
+		bInitFinished = false;
+	}
+	if (ReplicaSet.IsValid())
+	{
+		ReplicaSet->Shutdown();
+	}
 }
 
 
 void URedisObject::SelectIndex(int32 InIndex)
 {
-	if (SyncRedisClient.Get())
+	if (Cluster.IsValid() && InIndex != 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis cluster and sharded mode only use database 0, SelectIndex(%d) ignored"), InIndex);
+		return;
+	}
+	if (ConnectionPool.IsValid())
+	{
+		ConnectionPool->SelectIndex(InIndex);
+	}
+	if (AsyncEngine.IsValid())
+	{
+		AsyncEngine->SelectIndex(InIndex);
+	}
+	if (ReplicaSet.IsValid())
 	{
-		SyncRedisClient->SelectIndex(InIndex);
+		ReplicaSet->SelectIndex(InIndex);
 	}
 }
 
@@ -118,27 +348,6 @@ bool URedisObject::OnTest(const FString& InKey)
 }
 */
 
-TSharedPtr<URedisClient> URedisObject::FindOrNewRedisClient()
-{
-	if (IdleRedisClients.Num())
-	{
-		return IdleRedisClients.Pop();
-	}
-
-	TSharedPtr<URedisClient> NewRedisClient(new URedisClient());
-	NewRedisClient->ConnectToRedis(Host, Port, Password);
-
-	return NewRedisClient;
-}
-
-void URedisObject::RecycleRedisClient(TSharedPtr<URedisClient> InRedisClient)
-{
-	if (InRedisClient.Get())
-	{
-		IdleRedisClients.Push(InRedisClient);
-	}
-}
-
 bool URedisObject::Tick(float DeltaTime)
 {
 	int32 LimitCount = 0;
@@ -160,7 +369,7 @@ bool URedisObject::Tick(float DeltaTime)
 	while (MGetFinishedResults.Dequeue(CurrentMGetResult))
 	{
 		FWrapArray TmpWrapArray;
-		TmpWrapArray.RealArray = CurrentMGetResult->ResultMemberList;
+		TmpWrapArray.RealArray = MoveTemp(CurrentMGetResult->ResultMemberList);
 		CurrentMGetResult->MGetCallback.ExecuteIfBound(CurrentMGetResult->bResult, TmpWrapArray);
 		PUSH_ASYNC_RESULT(MGet, CurrentMGetResult);
 	}
@@ -191,7 +400,7 @@ bool URedisObject::Tick(float DeltaTime)
 	FAsyncResultHMGet* CurrentHMGetResult = nullptr;
 	while (HMGetFinishedResults.Dequeue(CurrentHMGetResult))
 	{
-		TmpWrapMap.RealMap = CurrentHMGetResult->ResultFieldValueMap;
+		TmpWrapMap.RealMap = MoveTemp(CurrentHMGetResult->ResultFieldValueMap);
 		CurrentHMGetResult->HMGetCallback.ExecuteIfBound(CurrentHMGetResult->bResult, TmpWrapMap);
 		PUSH_ASYNC_RESULT(HMGet, CurrentHMGetResult);
 	}
@@ -199,7 +408,7 @@ bool URedisObject::Tick(float DeltaTime)
 	FAsyncResultHGetAll* CurrentHGetAllResult = nullptr;
 	while (HGetAllFinishedResults.Dequeue(CurrentHGetAllResult))
 	{
-		TmpWrapMap.RealMap = CurrentHGetAllResult->ResultFieldValueMap;
+		TmpWrapMap.RealMap = MoveTemp(CurrentHGetAllResult->ResultFieldValueMap);
 		CurrentHGetAllResult->HGetAllCallback.ExecuteIfBound(CurrentHGetAllResult->bResult, TmpWrapMap);
 		PUSH_ASYNC_RESULT(HGetAll, CurrentHGetAllResult);
 	}
@@ -208,17 +417,87 @@ bool URedisObject::Tick(float DeltaTime)
 	while (SMembersFinishedResults.Dequeue(CurrentSMembersResult))
 	{
 		FWrapArray TmpWrapArray;
-		TmpWrapArray.RealArray = CurrentSMembersResult->ResultMemberList;
+		TmpWrapArray.RealArray = MoveTemp(CurrentSMembersResult->ResultMemberList);
 		CurrentSMembersResult->SMembersCallback.ExecuteIfBound(CurrentSMembersResult->bResult, TmpWrapArray);
 		PUSH_ASYNC_RESULT(SMembers, CurrentSMembersResult);
 	}
 
-	for (auto& Iter : SubscribeMap)
+	FAsyncResultZRange* CurrentZRangeResult = nullptr;
+	while (ZRangeFinishedResults.Dequeue(CurrentZRangeResult))
 	{
-		if (Iter.Value)
-		{
-			Iter.Value->Tick(DeltaTime);
-		}
+		FWrapScoredArray TmpWrapScoredArray;
+		TmpWrapScoredArray.RealArray = MoveTemp(CurrentZRangeResult->ResultMemberList);
+		CurrentZRangeResult->ZRangeCallback.ExecuteIfBound(CurrentZRangeResult->bResult, TmpWrapScoredArray);
+		PUSH_ASYNC_RESULT(ZRange, CurrentZRangeResult);
+	}
+
+	FAsyncResultZScore* CurrentZScoreResult = nullptr;
+	while (ZScoreFinishedResults.Dequeue(CurrentZScoreResult))
+	{
+		CurrentZScoreResult->ZScoreCallback.ExecuteIfBound(CurrentZScoreResult->bResult, CurrentZScoreResult->ResultScore);
+		PUSH_ASYNC_RESULT(ZScore, CurrentZScoreResult);
+	}
+
+	FAsyncResultPipeline* CurrentPipelineResult = nullptr;
+	while (PipelineFinishedResults.Dequeue(CurrentPipelineResult))
+	{
+		CurrentPipelineResult->PipelineCallback.ExecuteIfBound(CurrentPipelineResult->bResult, CurrentPipelineResult->Replies);
+		PUSH_ASYNC_RESULT(Pipeline, CurrentPipelineResult);
+	}
+
+	FAsyncResultScript* CurrentScriptResult = nullptr;
+	while (ScriptFinishedResults.Dequeue(CurrentScriptResult))
+	{
+		CurrentScriptResult->ScriptCallback.ExecuteIfBound(CurrentScriptResult->bResult, CurrentScriptResult->Reply);
+		PUSH_ASYNC_RESULT(Script, CurrentScriptResult);
+	}
+
+	FAsyncResultScan* CurrentScanResult = nullptr;
+	while (ScanFinishedResults.Dequeue(CurrentScanResult))
+	{
+		OnScanPage(CurrentScanResult);
+		PUSH_ASYNC_RESULT(Scan, CurrentScanResult);
+	}
+
+	FAsyncResultStream* CurrentStreamResult = nullptr;
+	while (StreamFinishedResults.Dequeue(CurrentStreamResult))
+	{
+		OnStreamBatch(CurrentStreamResult);
+		// Allocated by a consumer thread, which cannot take from the free list
+		delete CurrentStreamResult;
+		DEC_DWORD_STAT(STAT_RedisPendingStream);
+	}
+
+	FAsyncResultJob* CurrentJobResult = nullptr;
+	while (JobFinishedResults.Dequeue(CurrentJobResult))
+	{
+		OnListJob(CurrentJobResult);
+		delete CurrentJobResult;
+		DEC_DWORD_STAT(STAT_RedisPendingJob);
+	}
+
+	StoppingConsumers.RemoveAll([](const TSharedPtr<FRedisBlockingConsumer>& InConsumer)
+	{
+		return InConsumer->IsFinished();
+	});
+
+	if (ConnectionPool.IsValid())
+	{
+		ConnectionPool->ReapIdle();
+	}
+	if (Cluster.IsValid())
+	{
+		Cluster->Tick();
+	}
+	if (ReplicaSet.IsValid())
+	{
+		ReplicaSet->ReapIdle();
+	}
+	FRedisStats::UpdateRates();
+
+	if (Subscriber.IsValid())
+	{
+		DeliverMessages();
 	}
 
 	return true;
@@ -228,562 +507,1955 @@ bool URedisObject::Tick(float DeltaTime)
 
 bool URedisObject::ExecCommand(const FString& InCommand)
 {
-	if (SyncRedisClient.Get())
+	TArray<FString> CommandTokens;
+	InCommand.ParseIntoArrayWS(CommandTokens);
+
+	return RunCommand(FRedisCluster::GetCommandKey(CommandTokens.GetData(), CommandTokens.Num()), [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ExecCommand(InCommand);
+	});
+}
+
+bool URedisObject::ExecPipeline(const FRedisPipeline& InPipeline, TArray<FRedisReply>& OutReplies)
+{
+	if (Cluster.IsValid())
+	{
+		return Cluster->ExecPipeline(InPipeline, OutReplies);
+	}
+
+	FRedisPooledClient RedisClient(ConnectionPool.Get());
+	if (RedisClient)
 	{
-		return SyncRedisClient->ExecCommand(InCommand);
+		return RedisClient->ExecPipeline(InPipeline, OutReplies);
 	}
 	return false;
 }
 
+bool URedisObject::ExecTransaction(const FRedisTransaction& InTransaction, TArray<FRedisReply>& OutReplies)
+{
+	return RunCommand(GetTransactionKey(InTransaction), [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ExecTransaction(InTransaction, OutReplies);
+	});
+}
+
 bool URedisObject::ExpireKey(const FString& InKey, int32 InSec)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->ExpireKey(InKey, InSec);
-	}
-	return false;
+		return RedisClient.ExpireKey(InKey, InSec);
+	});
 }
 
-bool URedisObject::ExistsKey(const FString& InKey)
+bool URedisObject::ExistsKey(const FString& InKey, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->ExistsKey(InKey);
-	}
-	return false;
+		return RedisClient.ExistsKey(InKey);
+	});
 }
 
 
 bool URedisObject::PersistKey(const FString& InKey)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->PersistKey(InKey);
-	}
-	return false;
+		return RedisClient.PersistKey(InKey);
+	});
 }
 
 
 bool URedisObject::RenameKey(const FString& CurrentKey, const FString& NewKey)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(CurrentKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->RenameKey(CurrentKey, NewKey);
-	}
-	return false;
+		return RedisClient.RenameKey(CurrentKey, NewKey);
+	});
 }
 
 bool URedisObject::DelKey(const FString& InKey)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->DelKey(InKey);
-	}
-	return false;
+		return RedisClient.DelKey(InKey);
+	});
 }
 
 
-bool URedisObject::TypeKey(const FString& InKey, FString& OutType)
+bool URedisObject::TypeKey(const FString& InKey, FString& OutType, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->TypeKey(InKey, OutType);
-	}
-	return false;
+		return RedisClient.TypeKey(InKey, OutType);
+	});
 }
 
 
 bool URedisObject::MSet(TMap<FString, FString>& InMemberMap)
 {
-	if (SyncRedisClient.Get())
+	if (Cluster.IsValid())
+	{
+		return Cluster->MSet(InMemberMap);
+	}
+
+	FRedisPooledClient RedisClient(ConnectionPool.Get());
+	if (RedisClient)
 	{
-		return SyncRedisClient->MSet(InMemberMap);
+		return RedisClient->MSet(InMemberMap);
 	}
 	return false;
 }
 
 
-bool URedisObject::MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList)
+bool URedisObject::MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	if (Cluster.IsValid())
 	{
-		return SyncRedisClient->MGet(InKeyList, OutMemberList);
+		return Cluster->MGet(InKeyList, OutMemberList);
 	}
-	return false;
+
+	return RunRead(FString(), bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.MGet(InKeyList, OutMemberList);
+	});
 }
 
 bool URedisObject::SetInt(const FString& InKey, int32 InValue)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->SetInt(InKey, InValue);
-	}
-	return false;
+		return RedisClient.SetInt(InKey, InValue);
+	});
 }
 
-bool URedisObject::GetInt(const FString& InKey, int32& OutValue)
+bool URedisObject::GetInt(const FString& InKey, int32& OutValue, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->GetInt(InKey, OutValue);
-	}
-	return false;
+		return RedisClient.GetInt(InKey, OutValue);
+	});
 }
 
 bool URedisObject::SetStr(const FString& InKey, const FString& InValue)
 {
-	if (SyncRedisClient.Get())
+	TArray<uint8> Compressed;
+	if (FRedisCompression::Compress(Compression, CompressionThreshold, InValue, Compressed))
 	{
-		return SyncRedisClient->SetStr(InKey, InValue);
+		return SetBytesView(InKey, Compressed);
 	}
-	return false;
+
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.SetStr(InKey, InValue);
+	});
 }
 
-bool URedisObject::GetStr(const FString& InKey, FString& OutValue)
+bool URedisObject::GetStr(const FString& InKey, FString& OutValue, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->GetStr(InKey, OutValue);
-	}
-	return false;
+		return RedisClient.GetStr(InKey, OutValue);
+	});
 }
 
 
 bool URedisObject::Append(const FString& InKey, const FString& InValue)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->Append(InKey, InValue);
-	}
-	return false;
+		return RedisClient.Append(InKey, InValue);
+	});
 }
 
-bool URedisObject::SAdd(const FString& InKey, const TArray<FString>& InMemberList)
+bool URedisObject::SetBytes(const FString& InKey, const TArray<uint8>& InValue)
 {
-	if (SyncRedisClient.Get())
-	{
-		return SyncRedisClient->SAdd(InKey, InMemberList);
-	}
-	return false;
+	return SetBytesView(InKey, InValue);
 }
 
-
-bool URedisObject::SCard(const FString& InKey, int32& OutValue)
+bool URedisObject::GetBytes(const FString& InKey, TArray<uint8>& OutValue, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->SCard(InKey, OutValue);
-	}
-	return false;
+		return RedisClient.GetBytes(InKey, OutValue);
+	});
 }
 
-bool URedisObject::SRem(const FString& InKey, const TArray<FString>& InMemberList)
+bool URedisObject::HSetBytes(const FString& InKey, const FString& InField, const TArray<uint8>& InValue)
 {
-	if (SyncRedisClient.Get())
-	{
-		return SyncRedisClient->SRem(InKey, InMemberList);
-	}
-	return false;
+	return HSetBytesView(InKey, InField, InValue);
 }
 
-bool URedisObject::SMembers(const FString& InKey, TArray<FString>& OutMemberList)
+bool URedisObject::HGetBytes(const FString& InKey, const FString& InField, TArray<uint8>& OutValue, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->SMembers(InKey, OutMemberList);
-	}
-	return false;
+		return RedisClient.HGetBytes(InKey, InField, OutValue);
+	});
 }
 
-bool URedisObject::HSet(const FString& InKey, const FString& InField, const FString& InValue)
+bool URedisObject::MGetBytes(const TArray<FString>& InKeyList, TArray<FRedisBytes>& OutValues, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	OutValues.Reset();
+	OutValues.SetNum(InKeyList.Num());
+	if (InKeyList.Num() == 0)
 	{
-		return SyncRedisClient->HSet(InKey, InField, InValue);
+		return true;
 	}
-	return false;
-}
 
-bool URedisObject::HGet(const FString& InKey, const FString& InField, FString& OutValue)
-{
-	if (SyncRedisClient.Get())
+	// One MGET per slot in cluster and sharded mode, a single one otherwise
+	TMap<uint16, TArray<int32>> Groups;
+	if (Cluster.IsValid())
 	{
-		return SyncRedisClient->HSet(InKey, InField, OutValue);
+		FRedisCluster::GroupBySlot(InKeyList, Groups);
+	}
+	else
+	{
+		TArray<int32>& Indices = Groups.Add(0);
+		for (int32 i = 0; i < InKeyList.Num(); ++i)
+		{
+			Indices.Add(i);
+		}
 	}
-	return false;
-}
 
-bool URedisObject::HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap)
-{
-	if (SyncRedisClient.Get())
+	TArray<FString> GroupKeys;
+	FRedisBinaryReply Reply;
+	for (auto& Group : Groups)
 	{
-		return SyncRedisClient->HMSet(InKey, InMemberMap);
+		GroupKeys.Reset();
+		for (int32 Index : Group.Value)
+		{
+			GroupKeys.Add(InKeyList[Index]);
+		}
+		if (!MGetBytesView(GroupKeys, Reply, bReadFromReplica))
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < Group.Value.Num(); ++i)
+		{
+			FRedisBytes& OutValue = OutValues[Group.Value[i]];
+			TArrayView<const uint8> Value = Reply[i];
+			OutValue.bFound = Reply.IsValid(i);
+			OutValue.Bytes.Append(Value.GetData(), Value.Num());
+		}
 	}
-	return false;
+	return true;
 }
 
-bool URedisObject::HDel(const FString& InKey, const TArray<FString>& InFieldList)
+bool URedisObject::SetBytesView(const FString& InKey, TArrayView<const uint8> InValue)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->HDel(InKey, InFieldList);
-	}
-	return false;
+		return RedisClient.SetBytes(InKey, InValue);
+	});
 }
 
-
-bool URedisObject::HExists(const FString& InKey, const FString& Field)
+bool URedisObject::HSetBytesView(const FString& InKey, const FString& InField, TArrayView<const uint8> InValue)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->HExists(InKey, Field);
-	}
-	return false;
+		return RedisClient.HSetBytes(InKey, InField, InValue);
+	});
 }
 
-bool URedisObject::HMGet(const FString& InKey, const TSet<FString>& InFieldList, TMap<FString, FString>& OutMemberMap)
+bool URedisObject::GetBytesView(const FString& InKey, FRedisBinaryReply& OutValue, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->HMGet(InKey, InFieldList, OutMemberMap);
-	}
-	return false;
+		return RedisClient.GetBytes(InKey, OutValue);
+	});
 }
 
-bool URedisObject::HGetAll(const FString& InKey, TMap<FString, FString>& OutMemberMap)
+bool URedisObject::HGetBytesView(const FString& InKey, const FString& InField, FRedisBinaryReply& OutValue, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
 	{
-		return SyncRedisClient->HGetAll(InKey, OutMemberMap);
-	}
-	return false;
+		return RedisClient.HGetBytes(InKey, InField, OutValue);
+	});
 }
 
-bool URedisObject::HIncrby(const FString & Key, const FString & Field, int32 Value)
+bool URedisObject::MGetBytesView(const TArray<FString>& InKeyList, FRedisBinaryReply& OutValues, bool bReadFromReplica)
 {
-	if (SyncRedisClient.Get())
+	if (InKeyList.Num() == 0)
 	{
-		return SyncRedisClient->HIncrby(Key, Field, Value);
+		OutValues.Reset();
+		return true;
 	}
-	return false;
+
+	return RunRead(InKeyList[0], bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.MGetBytes(InKeyList, OutValues);
+	});
 }
 
-bool URedisObject::LIndex(const FString& InKey, int32 InIndex, FString& OutValue)
+bool URedisObject::SaveStructToHash(const FString& InKey, const UScriptStruct* InStruct, const void* InData, const void* InBaseline)
 {
-	if (SyncRedisClient.Get())
+	if (!InStruct || !InData)
 	{
-		return SyncRedisClient->LIndex(InKey, InIndex, OutValue);
+		return false;
 	}
-	return false;
+
+	TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe> Layout = FRedisStructLayout::Get(InStruct);
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HSetStruct(InKey, *Layout, InData, InBaseline);
+	});
+}
+
+bool URedisObject::LoadStructFromHash(const FString& InKey, const UScriptStruct* InStruct, void* OutData, bool bReadFromReplica)
+{
+	if (!InStruct || !OutData)
+	{
+		return false;
+	}
+
+	TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe> Layout = FRedisStructLayout::Get(InStruct);
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HGetStruct(InKey, *Layout, OutData);
+	});
+}
+
+bool URedisObject::SAdd(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.SAdd(InKey, InMemberList);
+	});
+}
+
+
+bool URedisObject::SCard(const FString& InKey, int32& OutValue)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.SCard(InKey, OutValue);
+	});
+}
+
+bool URedisObject::SRem(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.SRem(InKey, InMemberList);
+	});
+}
+
+bool URedisObject::SMembers(const FString& InKey, TArray<FString>& OutMemberList, bool bReadFromReplica)
+{
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.SMembers(InKey, OutMemberList);
+	});
+}
+
+bool URedisObject::ZAdd(const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag, int32& OutAdded)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZAdd(InKey, InMemberList, InFlag, OutAdded);
+	});
+}
+
+bool URedisObject::ZIncrby(const FString& InKey, const FString& InMember, double Incre, double& OutScore)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZIncrby(InKey, InMember, Incre, OutScore);
+	});
+}
+
+bool URedisObject::ZRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZRange(InKey, Start, Stop, OutMemberList);
+	});
+}
+
+bool URedisObject::ZRevRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZRevRange(InKey, Start, Stop, OutMemberList);
+	});
+}
+
+bool URedisObject::ZRangeByScore(const FString& InKey, double Min, double Max, int32 Offset, int32 Count, TArray<FRedisScoredMember>& OutMemberList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZRangeByScore(InKey, Min, Max, Offset, Count, OutMemberList);
+	});
+}
+
+bool URedisObject::ZRank(const FString& InKey, const FString& InMember, int32& OutRank)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZRank(InKey, InMember, OutRank);
+	});
+}
+
+bool URedisObject::ZScore(const FString& InKey, const FString& InMember, double& OutScore)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZScore(InKey, InMember, OutScore);
+	});
+}
+
+bool URedisObject::ZMScore(const FString& InKey, const TArray<FString>& InMemberList, TArray<FRedisScoredMember>& OutMemberList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZMScore(InKey, InMemberList, OutMemberList);
+	});
+}
+
+bool URedisObject::ZRem(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.ZRem(InKey, InMemberList);
+	});
+}
+
+bool URedisObject::HSet(const FString& InKey, const FString& InField, const FString& InValue)
+{
+	TArray<uint8> Compressed;
+	if (CompressionDictionary.IsValid() && FRedisCompression::Compress(*CompressionDictionary, DictionaryCompressionThreshold, InValue, Compressed))
+	{
+		return HSetBytesView(InKey, InField, Compressed);
+	}
+
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HSet(InKey, InField, InValue);
+	});
+}
+
+bool URedisObject::HGet(const FString& InKey, const FString& InField, FString& OutValue, bool bReadFromReplica)
+{
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HGet(InKey, InField, OutValue);
+	});
+}
+
+bool URedisObject::HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HMSet(InKey, InMemberMap, CompressionDictionary.Get(), DictionaryCompressionThreshold);
+	});
+}
+
+bool URedisObject::LoadCompressionDictionaries()
+{
+	if (CompressionDictionaryKey.IsEmpty())
+	{
+		return false;
+	}
+
+	FRedisBinaryReply Reply;
+	if (!RunCommand(CompressionDictionaryKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HGetAllBytes(CompressionDictionaryKey, Reply);
+	}))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis failed to read compression dictionaries from %s"), *CompressionDictionaryKey);
+		return false;
+	}
+
+	// Every dictionary is registered, so values written with an older one still read back
+	uint32 CurrentId = 0;
+	TSharedPtr<const FRedisCompressionDictionary, ESPMode::ThreadSafe> Current;
+	TArray<TSharedRef<const FRedisCompressionDictionary, ESPMode::ThreadSafe>> Loaded;
+	for (int32 i = 0; i + 1 < Reply.Num(); i += 2)
+	{
+		const TArrayView<const uint8> Field = Reply[i];
+		const TArrayView<const uint8> Value = Reply[i + 1];
+		const FString FieldName = FRedisReplyParser::ToString((const char*)Field.GetData(), Field.Num());
+		if (FieldName == FRedisCompressionDictionary::CurrentField)
+		{
+			CurrentId = (uint32)FCString::Strtoui64(*FRedisReplyParser::ToString((const char*)Value.GetData(), Value.Num()), nullptr, 10);
+			continue;
+		}
+
+		Loaded.Add(FRedisCompressionDictionary::Register(TArray<uint8>(Value.GetData(), Value.Num())));
+	}
+
+	for (auto& it : Loaded)
+	{
+		if (it->GetId() == CurrentId)
+		{
+			Current = it;
+		}
+	}
+	if (!Current.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis %s has no current compression dictionary, hash values are written uncompressed"), *CompressionDictionaryKey);
+		CompressionDictionary.Reset();
+		return false;
+	}
+
+	CompressionDictionary = Current;
+	UE_LOG(LogTemp, Log, TEXT("Redis loaded %d compression dictionaries from %s, writing with %u"), Loaded.Num(), *CompressionDictionaryKey, CurrentId);
+	return true;
+}
+
+bool URedisObject::HDel(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HDel(InKey, InFieldList);
+	});
+}
+
+
+bool URedisObject::HExists(const FString& InKey, const FString& Field)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HExists(InKey, Field);
+	});
+}
+
+bool URedisObject::HMGet(const FString& InKey, const TSet<FString>& InFieldList, TMap<FString, FString>& OutMemberMap, bool bReadFromReplica)
+{
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HMGet(InKey, InFieldList, OutMemberMap);
+	});
+}
+
+bool URedisObject::HGetAll(const FString& InKey, TMap<FString, FString>& OutMemberMap, bool bReadFromReplica)
+{
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HGetAll(InKey, OutMemberMap);
+	});
+}
+
+bool URedisObject::HIncrby(const FString & Key, const FString & Field, int32 Value)
+{
+	return RunCommand(Key, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.HIncrby(Key, Field, Value);
+	});
+}
+
+bool URedisObject::LIndex(const FString& InKey, int32 InIndex, FString& OutValue)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LIndex(InKey, InIndex, OutValue);
+	});
 }
 
 bool URedisObject::LInsertBefore(const FString& InKey, const FString& Pivot, const FString& InValue)
 {
-	if (SyncRedisClient.Get())
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LInsertBefore(InKey, Pivot, InValue);
+	});
+}
+
+bool URedisObject::LInsertAfter(const FString& InKey, const FString& Pivot, const FString& InValue)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LInsertAfter(InKey, Pivot, InValue);
+	});
+}
+
+bool URedisObject::LLen(const FString& InKey, int32& Len)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LLen(InKey, Len);
+	});
+}
+
+bool URedisObject::LPop(const FString& InKey, FString& OutValue)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LPop(InKey, OutValue);
+	});
+}
+
+bool URedisObject::LPush(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LPush(InKey, InFieldList);
+	});
+}
+
+bool URedisObject::LRange(const FString& InKey, int32 Start, int32 End, TArray<FString>& OutMemberList, bool bReadFromReplica)
+{
+	return RunRead(InKey, bReadFromReplica, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LRange(InKey, Start, End, OutMemberList);
+	});
+}
+
+bool URedisObject::LRem(const FString& InKey, const FString& InValue, int32 Count /*= 0*/)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LRem(InKey, InValue, Count);
+	});
+}
+
+bool URedisObject::LSet(const FString& InKey, int32 InIndex, const FString& InValue)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LSet(InKey, InIndex, InValue);
+	});
+}
+
+bool URedisObject::LTrim(const FString& InKey, int32 Start, int32 Stop)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LTrim(InKey, Start, Stop);
+	});
+}
+
+bool URedisObject::RPop(const FString& InKey, FString& OutValue)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.RPop(InKey, OutValue);
+	});
+}
+
+bool URedisObject::RPush(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.RPush(InKey, InFieldList);
+	});
+}
+
+bool URedisObject::XAdd(const FString& InKey, const TArray<FRedisStreamEntry>& InEntries, int32 InMaxLen, TArray<FString>& OutIds)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.XAdd(InKey, InEntries, InMaxLen, OutIds);
+	});
+}
+
+bool URedisObject::XAck(const FString& InKey, const FString& InGroup, const TArray<FString>& InIds, int32& OutAcked)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.XAck(InKey, InGroup, InIds, OutAcked);
+	});
+}
+
+bool URedisObject::XAutoClaim(const FString& InKey, const FString& InGroup, const FString& InConsumer, int32 InMinIdleMs, int32 InCount, FString& InOutCursor, TArray<FRedisStreamEntry>& OutEntries)
+{
+	return RunCommand(InKey, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.XAutoClaim(InKey, InGroup, InConsumer, InMinIdleMs, InOutCursor, InCount, OutEntries);
+	});
+}
+
+int32 URedisObject::StartStreamConsumer(const FRedisStreamConsumerSettings& Settings, FStreamEntriesReceived OnEntries)
+{
+	if (!ConnectionPool.IsValid() && !Cluster.IsValid())
+	{
+		return 0;
+	}
+	if (Settings.Streams.Num() == 0 || Settings.Group.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis stream consumer needs at least one stream and a group"));
+		return 0;
+	}
+
+	const int32 ConsumerId = ++LastConsumerId;
+	const FString RouteKey = Settings.Streams[0];
+
+	// Both run on the consumer thread, which BeginDestroy joins before anything they touch goes away
+	TSharedPtr<FRedisStreamConsumer> Consumer = MakeShareable(new FRedisStreamConsumer());
+	Consumer->Connect = [this, RouteKey]()
+	{
+		return ConnectDedicated(RouteKey);
+	};
+	Consumer->OnEntries = [this, ConsumerId](const FString& InStream, TArray<FRedisStreamEntry>&& InEntries)
+	{
+		FAsyncResultStream* Result = new FAsyncResultStream();
+		INC_DWORD_STAT(STAT_RedisPendingStream);
+		Result->bResult = true;
+		Result->ConsumerId = ConsumerId;
+		Result->Stream = InStream;
+		Result->Entries = MoveTemp(InEntries);
+		OnNotifyStreamResult(Result);
+	};
+	if (!Consumer->Start(Settings))
+	{
+		return 0;
+	}
+
+	FStreamConsumerState& State = StreamConsumers.Add(ConsumerId);
+	State.Consumer = Consumer;
+	State.OnEntries = OnEntries;
+	State.Group = Settings.Group;
+	State.bAckAfterHandler = Settings.bAckAfterHandler;
+	return ConsumerId;
+}
+
+void URedisObject::StopStreamConsumer(int32 ConsumerId)
+{
+	FStreamConsumerState State;
+	if (!StreamConsumers.RemoveAndCopyValue(ConsumerId, State))
+	{
+		return;
+	}
+
+	// Not joined here: the thread may sit in XREADGROUP ... BLOCK for a while
+	State.Consumer->Stop();
+	StoppingConsumers.Add(State.Consumer);
+}
+
+int32 URedisObject::StartListConsumer(const FRedisListConsumerSettings& Settings, FListJobReceived OnJob)
+{
+	if (!ConnectionPool.IsValid() && !Cluster.IsValid())
+	{
+		return 0;
+	}
+	if (Settings.Keys.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis list consumer needs at least one key"));
+		return 0;
+	}
+
+	const int32 ConsumerId = ++LastConsumerId;
+	const FString RouteKey = Settings.Keys[0];
+
+	// Same lifetime rules as the stream consumers
+	TSharedPtr<FRedisListConsumer> Consumer = MakeShareable(new FRedisListConsumer());
+	Consumer->Connect = [this, RouteKey]()
+	{
+		return ConnectDedicated(RouteKey);
+	};
+	Consumer->OnJob = [this, ConsumerId](const FString& InKey, FString&& InJob)
+	{
+		FAsyncResultJob* Result = new FAsyncResultJob();
+		INC_DWORD_STAT(STAT_RedisPendingJob);
+		Result->bResult = true;
+		Result->ConsumerId = ConsumerId;
+		Result->Key = InKey;
+		Result->Job = MoveTemp(InJob);
+		OnNotifyJobResult(Result);
+	};
+	if (!Consumer->Start(Settings))
+	{
+		return 0;
+	}
+
+	FListConsumerState& State = ListConsumers.Add(ConsumerId);
+	State.Consumer = Consumer;
+	State.OnJob = OnJob;
+	State.ProcessingList = Settings.ProcessingList;
+	State.bAckAfterHandler = Settings.bAckAfterHandler && !Settings.ProcessingList.IsEmpty();
+	return ConsumerId;
+}
+
+void URedisObject::StopListConsumer(int32 ConsumerId)
+{
+	FListConsumerState State;
+	if (!ListConsumers.RemoveAndCopyValue(ConsumerId, State))
+	{
+		return;
+	}
+
+	State.Consumer->Stop();
+	StoppingConsumers.Add(State.Consumer);
+}
+
+bool URedisObject::AckJob(const FString& ProcessingList, const FString& Job)
+{
+	return RunCommand(ProcessingList, [&](URedisClient& RedisClient)
+	{
+		return RedisClient.LRem(ProcessingList, Job, 1);
+	});
+}
+
+void URedisObject::AsyncExistsKey(const FString& RedisKey, FExistsKeyFinished OnFinished, bool bReadFromReplica)
+{
+	POP_ASYNC_RESULT(ExistsKey, ResultHandler);
+	ResultHandler->ExistsKeyCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("EXISTS").Add(RedisKey);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseBool(Reply);
+		OnNotifyExistsKeyResult(ResultHandler);
+	};
+	SubmitRead(RedisKey, bReadFromReplica, Request);
+}
+
+void URedisObject::AsyncExpireKey(const FString& InKey, int32 InSec)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("EXPIRE").Add(InKey).Add(InSec);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseBool(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncDelKey(const FString& InKey)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("DEL").Add(InKey);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncSetInt(const FString& InKey, int32 InValue)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("SET").Add(InKey).Add(InValue);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncSetStr(const FString& InKey, const FString& InValue)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("SET").Add(InKey);
+	TArray<uint8> Compressed;
+	if (FRedisCompression::Compress(Compression, CompressionThreshold, InValue, Compressed))
+	{
+		Request->Args.AddRaw(Compressed.GetData(), Compressed.Num());
+	}
+	else
+	{
+		Request->Args.Add(InValue);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncSAdd(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("SADD").Add(InKey);
+	for (auto& it : InMemberList)
+	{
+		Request->Args.Add(it);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncSRem(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("SREM").Add(InKey);
+	for (auto& it : InMemberList)
+	{
+		Request->Args.Add(it);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZAdd(const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	URedisClient::BuildZAddCommand(Request->Args, InKey, InMemberList, InFlag);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZIncrby(const FString& InKey, const FString& InMember, double Incre, FZScoreFinished OnFinished)
+{
+	POP_ASYNC_RESULT(ZScore, ResultHandler);
+	ResultHandler->ZScoreCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("ZINCRBY").Add(InKey).Add(Incre).Add(InMember);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseDouble(Reply, ResultHandler->ResultScore);
+		OnNotifyZScoreResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZRange(const FString& InKey, int32 Start, int32 Stop, FZRangeFinished OnFinished)
+{
+	POP_ASYNC_RESULT(ZRange, ResultHandler);
+	ResultHandler->ZRangeCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("ZRANGE").Add(InKey).Add(Start).Add(Stop).Add("WITHSCORES");
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseScoredMembers(Reply, ResultHandler->ResultMemberList);
+		OnNotifyZRangeResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZRevRange(const FString& InKey, int32 Start, int32 Stop, FZRangeFinished OnFinished)
+{
+	POP_ASYNC_RESULT(ZRange, ResultHandler);
+	ResultHandler->ZRangeCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("ZREVRANGE").Add(InKey).Add(Start).Add(Stop).Add("WITHSCORES");
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseScoredMembers(Reply, ResultHandler->ResultMemberList);
+		OnNotifyZRangeResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZRangeByScore(const FString& InKey, double Min, double Max, int32 Offset, int32 Count, FZRangeFinished OnFinished)
+{
+	POP_ASYNC_RESULT(ZRange, ResultHandler);
+	ResultHandler->ZRangeCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	URedisClient::BuildZRangeByScoreCommand(Request->Args, InKey, Min, Max, Offset, Count);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseScoredMembers(Reply, ResultHandler->ResultMemberList);
+		OnNotifyZRangeResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZRank(const FString& InKey, const FString& InMember, FGetIntFinished OnFinished)
+{
+	POP_ASYNC_RESULT(GetInt, ResultHandler);
+	ResultHandler->GetIntCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("ZRANK").Add(InKey).Add(InMember);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseInt(Reply, ResultHandler->ResultValue);
+		OnNotifyGetIntResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZScore(const FString& InKey, const FString& InMember, FZScoreFinished OnFinished)
+{
+	POP_ASYNC_RESULT(ZScore, ResultHandler);
+	ResultHandler->ZScoreCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("ZSCORE").Add(InKey).Add(InMember);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseDouble(Reply, ResultHandler->ResultScore);
+		OnNotifyZScoreResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZMScore(const FString& InKey, const TArray<FString>& InMemberList, FZRangeFinished OnFinished)
+{
+	POP_ASYNC_RESULT(ZRange, ResultHandler);
+	ResultHandler->ZRangeCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("ZMSCORE").Add(InKey);
+	for (auto& it : InMemberList)
+	{
+		Request->Args.Add(it);
+	}
+	Request->OnReply = [this, ResultHandler, InMemberList](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseScores(Reply, InMemberList, ResultHandler->ResultMemberList);
+		OnNotifyZRangeResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncZRem(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("ZREM").Add(InKey);
+	for (auto& it : InMemberList)
+	{
+		Request->Args.Add(it);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncHSet(const FString& InKey, const FString& InField, const FString& InValue)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("HSET").Add(InKey).Add(InField);
+	FRedisCompression::AddValue(Request->Args, InValue, CompressionDictionary.Get(), DictionaryCompressionThreshold);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncHMSet(const FString& InKey, const TMap<FString, FString>& InFieldValueMap)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("HMSET").Add(InKey);
+	for (auto& it : InFieldValueMap)
+	{
+		Request->Args.Add(it.Key);
+		FRedisCompression::AddValue(Request->Args, it.Value, CompressionDictionary.Get(), DictionaryCompressionThreshold);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncHDel(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("HDEL").Add(InKey);
+	for (auto& it : InFieldList)
+	{
+		Request->Args.Add(it);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncXAdd(const FString& InKey, const TArray<FRedisStreamEntry>& InEntries, int32 InMaxLen)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	ResultHandler->bResult = true;
+
+	if (InEntries.Num() == 0)
+	{
+		OnNotifyNoReturnResult(ResultHandler);
+		return;
+	}
+
+	TSharedRef<FThreadSafeCounter, ESPMode::ThreadSafe> Remaining = MakeShared<FThreadSafeCounter, ESPMode::ThreadSafe>(InEntries.Num());
+	TArray<FRedisAsyncRequest*> Requests;
+	Requests.Reserve(InEntries.Num());
+	for (auto& it : InEntries)
+	{
+		FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+		URedisClient::BuildXAddCommand(Request->Args, InKey, it, InMaxLen);
+		Request->OnReply = [this, ResultHandler, Remaining](redisReply* Reply)
+		{
+			if (!FRedisReplyParser::ParseStatus(Reply))
+			{
+				ResultHandler->bResult = false;
+			}
+			if (Remaining->Decrement() == 0)
+			{
+				OnNotifyNoReturnResult(ResultHandler);
+			}
+		};
+		Requests.Add(Request);
+	}
+
+	if (Cluster.IsValid())
+	{
+		for (FRedisAsyncRequest* Request : Requests)
+		{
+			Cluster->Submit(InKey, Request);
+		}
+		return;
+	}
+	if (!AsyncEngine.IsValid())
+	{
+		for (FRedisAsyncRequest* Request : Requests)
+		{
+			FailAsyncRequest(Request);
+		}
+		return;
+	}
+	AsyncEngine->SubmitBatch(Requests);
+}
+
+void URedisObject::AsyncXAck(const FString& InKey, const FString& InGroup, const TArray<FString>& InIds)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	URedisClient::BuildXAckCommand(Request->Args, InKey, InGroup, InIds);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(InKey, Request);
+}
+
+void URedisObject::AsyncAckJob(const FString& ProcessingList, const FString& Job)
+{
+	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("LREM").Add(ProcessingList).Add(1).Add(Job);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseStatus(Reply);
+		OnNotifyNoReturnResult(ResultHandler);
+	};
+	SubmitRequest(ProcessingList, Request);
+}
+
+void URedisObject::AsyncMGet(const TArray<FString>& InKeyList, FMGetFinished OnFinished, bool bReadFromReplica)
+{
+	POP_ASYNC_RESULT(MGet, ResultHandler);
+	ResultHandler->MGetCallback = OnFinished;
+
+	if (Cluster.IsValid())
+	{
+		Cluster->SubmitMGet(InKeyList, [this, ResultHandler](bool bResult, TArray<FString>&& Values)
+		{
+			ResultHandler->bResult = bResult;
+			ResultHandler->ResultMemberList = MoveTemp(Values);
+			OnNotifyMGetResult(ResultHandler);
+		});
+		return;
+	}
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("MGET");
+	for (auto& it : InKeyList)
+	{
+		Request->Args.Add(it);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisCompression::ParseArray(Reply, ResultHandler->ResultMemberList);
+		OnNotifyMGetResult(ResultHandler);
+	};
+	SubmitRead(FString(), bReadFromReplica, Request);
+}
+
+void URedisObject::AsyncGetInt(const FString& InKey, FGetIntFinished OnFinished, bool bReadFromReplica)
+{
+	POP_ASYNC_RESULT(GetInt, ResultHandler);
+	ResultHandler->GetIntCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("GET").Add(InKey);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseInt(Reply, ResultHandler->ResultValue);
+		OnNotifyGetIntResult(ResultHandler);
+	};
+	SubmitRead(InKey, bReadFromReplica, Request);
+}
+
+void URedisObject::AsyncGetStr(const FString& InKey, FGetStrFinished OnFinished, bool bReadFromReplica)
+{
+	POP_ASYNC_RESULT(GetStr, ResultHandler);
+	ResultHandler->GetStrCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("GET").Add(InKey);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		// On the I/O thread, so large values never decompress on the game thread
+		ResultHandler->bResult = FRedisCompression::ParseString(Reply, ResultHandler->ResultValue);
+		OnNotifyGetStrResult(ResultHandler);
+	};
+	SubmitRead(InKey, bReadFromReplica, Request);
+}
+
+void URedisObject::AsyncHGet(const FString& InKey, const FString& InField, FHGetFinished OnFinished, bool bReadFromReplica)
+{
+	POP_ASYNC_RESULT(HGet, ResultHandler);
+	ResultHandler->HGetCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("HGET").Add(InKey).Add(InField);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisCompression::ParseString(Reply, ResultHandler->ResultValue);
+		OnNotifyHGetResult(ResultHandler);
+	};
+	SubmitRead(InKey, bReadFromReplica, Request);
+}
+
+void URedisObject::AsyncHMGet(const FString& InKey, const TSet<FString>& InFieldList, FHMGetFinished OnFinished, bool bReadFromReplica)
+{
+	POP_ASYNC_RESULT(HMGet, ResultHandler);
+	ResultHandler->HMGetCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("HMGET").Add(InKey);
+	for (auto& it : InFieldList)
+	{
+		Request->Args.Add(it);
+		ResultHandler->ResultFieldValueMap.Add(it);
+	}
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisCompression::ParseFieldValues(Reply, ResultHandler->ResultFieldValueMap);
+		OnNotifyHMGetResult(ResultHandler);
+	};
+	SubmitRead(InKey, bReadFromReplica, Request);
+}
+
+void URedisObject::AsyncHGetAll(const FString& InKey, FHGetAllFinished OnFinished, bool bReadFromReplica)
+{
+	POP_ASYNC_RESULT(HGetAll, ResultHandler);
+	ResultHandler->HGetAllCallback = OnFinished;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("HGETALL").Add(InKey);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisCompression::ParseMap(Reply, ResultHandler->ResultFieldValueMap);
+		OnNotifyHGetAllResult(ResultHandler);
+	};
+	SubmitRead(InKey, bReadFromReplica, Request);
+}
+
+void URedisObject::AsyncExecTransaction(const TSharedRef<FRedisTransaction, ESPMode::ThreadSafe>& InTransaction, FPipelineFinished OnFinished)
+{
+	POP_ASYNC_RESULT(Pipeline, ResultHandler);
+	ResultHandler->PipelineCallback = OnFinished;
+
+	BackgroundTasks.Increment();
+	Async(EAsyncExecution::ThreadPool, [this, ResultHandler, InTransaction]()
+	{
+		ResultHandler->bResult = ExecTransaction(*InTransaction, ResultHandler->Replies);
+		OnNotifyPipelineResult(ResultHandler);
+		BackgroundTasks.Decrement();
+	});
+}
+
+void URedisObject::AsyncExecPipeline(const FRedisPipeline& InPipeline, FPipelineFinished OnFinished)
+{
+	POP_ASYNC_RESULT(Pipeline, ResultHandler);
+	ResultHandler->PipelineCallback = OnFinished;
+	ResultHandler->bResult = true;
+
+	if (InPipeline.IsEmpty())
+	{
+		OnNotifyPipelineResult(ResultHandler);
+		return;
+	}
+
+	// Replies are stored by index; whichever arrives last hands the batch back to the game thread
+	ResultHandler->Replies.SetNum(InPipeline.Num());
+	TSharedRef<FThreadSafeCounter, ESPMode::ThreadSafe> Remaining = MakeShared<FThreadSafeCounter, ESPMode::ThreadSafe>(InPipeline.Num());
+
+	TArray<FRedisAsyncRequest*> Requests;
+	Requests.Reserve(InPipeline.Num());
+	int32 NextIndex = 0;
+	InPipeline.ForEachCommand([this, ResultHandler, &InPipeline, &Remaining, &Requests, &NextIndex](const FString* Args, int32 ArgCount)
+	{
+		const int32 Index = NextIndex++;
+		const FString Key = FRedisCluster::GetCommandKey(Args, ArgCount);
+		FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+		for (int32 i = 0; i < ArgCount; ++i)
+		{
+			Request->Args.Add(Args[i]);
+		}
+		auto OnReply = [this, ResultHandler, Index, Remaining](redisReply* Reply)
+		{
+			if (!Reply)
+			{
+				ResultHandler->bResult = false;
+			}
+			FRedisReplyParser::ToReply(Reply, ResultHandler->Replies[Index]);
+			if (Remaining->Decrement() == 0)
+			{
+				OnNotifyPipelineResult(ResultHandler);
+			}
+		};
+
+		TSharedPtr<URedisScript, ESPMode::ThreadSafe> Script = InPipeline.FindScript(Index);
+		if (Script.IsValid())
+		{
+			// A NOSCRIPT retry lands after the rest of the batch
+			SetScriptReply(Request, Key, Script.ToSharedRef(), TArray<FString>(Args + 2, ArgCount - 2), MoveTemp(OnReply));
+		}
+		else
+		{
+			Request->OnReply = MoveTemp(OnReply);
+		}
+
+		// Cluster: every command goes to its own node, the engines pipeline what shares one
+		if (Cluster.IsValid())
+		{
+			Cluster->Submit(Key, Request);
+		}
+		else
+		{
+			Requests.Add(Request);
+		}
+	});
+	if (AsyncEngine.IsValid())
 	{
-		return SyncRedisClient->LInsertBefore(InKey, Pivot, InValue);
+		AsyncEngine->SubmitBatch(Requests);
+		return;
+	}
+	for (FRedisAsyncRequest* Request : Requests)
+	{
+		FailAsyncRequest(Request);
 	}
-	return false;
 }
 
-bool URedisObject::LInsertAfter(const FString& InKey, const FString& Pivot, const FString& InValue)
+bool URedisObject::RegisterScript(FName InName, const FString& InSource)
 {
-	if (SyncRedisClient.Get())
+	TSharedRef<URedisScript, ESPMode::ThreadSafe> Script = MakeShared<URedisScript, ESPMode::ThreadSafe>(InName, InSource);
 	{
-		return SyncRedisClient->LInsertAfter(InKey, Pivot, InValue);
+		FScopeLock ScopeLock(&ScriptsLock);
+		Scripts.Add(InName, Script);
 	}
-	return false;
-}
 
-bool URedisObject::LLen(const FString& InKey, int32& Len)
-{
-	if (SyncRedisClient.Get())
+	// Every cluster node keeps its own script cache
+	if (Cluster.IsValid())
 	{
-		return SyncRedisClient->LLen(InKey, Len);
+		bool bLoaded = true;
+		Cluster->ForEachNode([&Script, &bLoaded](URedisClient& RedisClient)
+		{
+			bLoaded &= RedisClient.ScriptLoad(*Script);
+		});
+		return bLoaded;
 	}
-	return false;
-}
 
-bool URedisObject::LPop(const FString& InKey, FString& OutValue)
-{
-	if (SyncRedisClient.Get())
+	// The script cache is server-wide, loading through any one connection is enough
+	FRedisPooledClient RedisClient(ConnectionPool.Get());
+	if (RedisClient)
 	{
-		return SyncRedisClient->LPop(InKey, OutValue);
+		return RedisClient->ScriptLoad(*Script);
 	}
 	return false;
 }
 
-bool URedisObject::LPush(const FString& InKey, const TArray<FString>& InFieldList)
+TSharedPtr<URedisScript, ESPMode::ThreadSafe> URedisObject::FindScript(FName InName) const
 {
-	if (SyncRedisClient.Get())
+	FScopeLock ScopeLock(&ScriptsLock);
+	const TSharedRef<URedisScript, ESPMode::ThreadSafe>* Script = Scripts.Find(InName);
+	if (Script)
 	{
-		return SyncRedisClient->LPush(InKey, InFieldList);
+		return *Script;
 	}
-	return false;
+	return nullptr;
 }
 
-bool URedisObject::LRange(const FString& InKey, int32 Start, int32 End, TArray<FString>& OutMemberList)
+bool URedisObject::EvalScript(FName InName, const TArray<FString>& InKeys, const TArray<FString>& InArgs, FRedisReply& OutReply)
 {
-	if (SyncRedisClient.Get())
+	TSharedPtr<URedisScript, ESPMode::ThreadSafe> Script = FindScript(InName);
+	if (!Script.IsValid())
 	{
-		return SyncRedisClient->LRange(InKey, Start, End, OutMemberList);
+		UE_LOG(LogTemp, Warning, TEXT("Redis script %s is not registered"), *InName.ToString());
+		return false;
 	}
-	return false;
+
+	return RunCommand(InKeys.Num() ? InKeys[0] : FString(), [&](URedisClient& RedisClient)
+	{
+		return RedisClient.EvalScript(*Script, InKeys, InArgs, OutReply);
+	});
 }
 
-bool URedisObject::LRem(const FString& InKey, const FString& InValue, int32 Count /*= 0*/)
+void URedisObject::AsyncEvalScript(FName InName, const TArray<FString>& InKeys, const TArray<FString>& InArgs, FEvalScriptFinished OnFinished)
 {
-	if (SyncRedisClient.Get())
+	POP_ASYNC_RESULT(Script, ResultHandler);
+	ResultHandler->ScriptCallback = OnFinished;
+
+	TSharedPtr<URedisScript, ESPMode::ThreadSafe> Script = FindScript(InName);
+	if (!Script.IsValid())
 	{
-		return SyncRedisClient->LRem(InKey, InValue, Count);
+		UE_LOG(LogTemp, Warning, TEXT("Redis script %s is not registered"), *InName.ToString());
+		OnNotifyScriptResult(ResultHandler);
+		return;
 	}
-	return false;
+
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	URedisClient::BuildEvalCommand(Request->Args, *Script, true, InKeys, InArgs);
+
+	TArray<FString> EvalArgs;
+	EvalArgs.Reserve(1 + InKeys.Num() + InArgs.Num());
+	EvalArgs.Add(FString::FromInt(InKeys.Num()));
+	EvalArgs.Append(InKeys);
+	EvalArgs.Append(InArgs);
+
+	const FString Key = InKeys.Num() ? InKeys[0] : FString();
+	SetScriptReply(Request, Key, Script.ToSharedRef(), MoveTemp(EvalArgs), [this, ResultHandler](redisReply* Reply)
+	{
+		FRedisReplyParser::ToReply(Reply, ResultHandler->Reply);
+		ResultHandler->bResult = Reply && !ResultHandler->Reply.IsError();
+		OnNotifyScriptResult(ResultHandler);
+	});
+	SubmitRequest(Key, Request);
 }
 
-bool URedisObject::LSet(const FString& InKey, int32 InIndex, const FString& InValue)
+void URedisObject::LoadScripts(URedisClient& InRedisClient)
 {
-	if (SyncRedisClient.Get())
+	TArray<TSharedRef<URedisScript, ESPMode::ThreadSafe>> ScriptList;
 	{
-		return SyncRedisClient->LSet(InKey, InIndex, InValue);
+		FScopeLock ScopeLock(&ScriptsLock);
+		Scripts.GenerateValueArray(ScriptList);
 	}
-	return false;
-}
 
-bool URedisObject::LTrim(const FString& InKey, int32 Start, int32 Stop)
-{
-	if (SyncRedisClient.Get())
+	for (auto& it : ScriptList)
 	{
-		return SyncRedisClient->LTrim(InKey, Start, Stop);
+		InRedisClient.ScriptLoad(*it);
 	}
-	return false;
 }
 
-bool URedisObject::RPop(const FString& InKey, FString& OutValue)
+void URedisObject::SetScriptReply(FRedisAsyncRequest* InRequest, const FString& InKey, const TSharedRef<URedisScript, ESPMode::ThreadSafe>& InScript, TArray<FString>&& InEvalArgs, TFunction<void(redisReply*)>&& InOnReply)
 {
-	if (SyncRedisClient.Get())
+	InRequest->OnReply = [this, Key = InKey, InScript, EvalArgs = MoveTemp(InEvalArgs), OnReply = MoveTemp(InOnReply)](redisReply* Reply) mutable
 	{
-		return SyncRedisClient->RPop(InKey, OutValue);
-	}
-	return false;
+		if (!FRedisReplyParser::IsNoScript(Reply))
+		{
+			OnReply(Reply);
+			return;
+		}
+
+		// EVAL also puts the script back into the server cache
+		FRedisAsyncRequest* Retry = new FRedisAsyncRequest();
+		Retry->Args.Add("EVAL").Add(InScript->GetSource());
+		for (auto& it : EvalArgs)
+		{
+			Retry->Args.Add(it);
+		}
+		Retry->OnReply = MoveTemp(OnReply);
+		SubmitRequest(Key, Retry);
+	};
 }
 
-bool URedisObject::RPush(const FString& InKey, const TArray<FString>& InFieldList)
+void URedisObject::AsyncScan(const TSharedRef<FRedisScanIterator, ESPMode::ThreadSafe>& InIterator)
 {
-	if (SyncRedisClient.Get())
+	if (InIterator->bStarted)
 	{
-		return SyncRedisClient->RPush(InKey, InFieldList);
+		UE_LOG(LogTemp, Warning, TEXT("Redis scan iterator already started"));
+		return;
 	}
-	return false;
+	InIterator->bStarted = true;
+	WarnClusterKeyspaceScan(*InIterator);
+
+	RequestScanPage(InIterator);
 }
 
-void URedisObject::AsyncExistsKey(const FString& RedisKey, FExistsKeyFinished OnFinished)
+bool URedisObject::ScanNext(const TSharedRef<FRedisScanIterator, ESPMode::ThreadSafe>& InIterator, TArray<FString>& OutElements)
 {
-	POP_ASYNC_RESULT(ExistsKey, ResultHandler);
+	OutElements.Reset();
+	if (InIterator->bFinished)
+	{
+		return false;
+	}
+	if (!InIterator->bStarted)
+	{
+		WarnClusterKeyspaceScan(*InIterator);
+	}
+	InIterator->bStarted = true;
 
-	FAsyncTask<AsyncExistsKeyTask>* AsyncTaskPtr = new FAsyncTask<AsyncExistsKeyTask>(RedisKey, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyExistsKeyResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	bool bConnected = false;
+	const bool bScanned = RunCommand(InIterator->Key, [&](URedisClient& RedisClient)
+	{
+		bConnected = true;
+		return RedisClient.Scan(InIterator->Type, InIterator->Key, InIterator->Cursor, InIterator->Match, InIterator->Count, OutElements);
+	});
+	if (!bConnected)
+	{
+		return false;
+	}
+	if (!bScanned)
+	{
+		InIterator->Finish(false);
+		return false;
+	}
+	if (InIterator->Cursor == TEXT("0"))
+	{
+		InIterator->Finish(true);
+	}
+	return true;
 }
 
-void URedisObject::AsyncExpireKey(const FString& InKey, int32 InSec)
+void URedisObject::RequestScanPage(const TSharedRef<FRedisScanIterator, ESPMode::ThreadSafe>& InIterator)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	POP_ASYNC_RESULT(Scan, ResultHandler);
+	ResultHandler->Iterator = InIterator;
 
-	FAsyncTask<AsyncExpireKeyTask>* AsyncTaskPtr = new FAsyncTask<AsyncExpireKeyTask>(InKey, InSec, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	URedisClient::BuildScanCommand(Request->Args, InIterator->Type, InIterator->Key, InIterator->Cursor, InIterator->Match, InIterator->Count);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseScan(Reply, ResultHandler->Cursor, ResultHandler->Elements);
+		OnNotifyScanResult(ResultHandler);
+	};
+	SubmitRequest(InIterator->Key, Request);
 }
 
-void URedisObject::AsyncDelKey(const FString& InKey)
+void URedisObject::OnScanPage(FAsyncResultScan* InResult)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	TSharedPtr<FRedisScanIterator, ESPMode::ThreadSafe> Iterator = InResult->Iterator;
+	if (!Iterator.IsValid() || Iterator->bFinished)
+	{
+		// Prefetched page of a walk that was stopped in the meantime
+		return;
+	}
+
+	if (!InResult->bResult || Iterator->bCancelled)
+	{
+		Iterator->Finish(false);
+		return;
+	}
+
+	Iterator->Cursor = InResult->Cursor;
+	const bool bLastPage = Iterator->Cursor == TEXT("0");
+
+	// At most one page in flight while this one is being handled
+	if (!bLastPage && Iterator->bPrefetch)
+	{
+		RequestScanPage(Iterator.ToSharedRef());
+	}
 
-	FAsyncTask<AsyncDelKeyTask>* AsyncTaskPtr = new FAsyncTask<AsyncDelKeyTask>(InKey, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	const bool bContinue = Iterator->OnPage.IsBound() ? Iterator->OnPage.Execute(InResult->Elements) : true;
+	if (bLastPage || !bContinue || Iterator->bCancelled)
+	{
+		Iterator->Finish(bLastPage && bContinue);
+		return;
+	}
+
+	if (!Iterator->bPrefetch)
+	{
+		RequestScanPage(Iterator.ToSharedRef());
+	}
 }
 
-void URedisObject::AsyncSetInt(const FString& InKey, int32 InValue)
+bool URedisObject::Publish(const FString& Channel, const FString& Message)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
-
-	FAsyncTask<AsyncSetIntTask>* AsyncTaskPtr = new FAsyncTask<AsyncSetIntTask>(InKey, InValue, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	// Cluster nodes forward every PUBLISH to the whole bus; shards don't, so all channels share one
+	return RunCommand(FString(), [&](URedisClient& RedisClient)
+	{
+		return RedisClient.Publish(Channel, Message);
+	});
 }
 
-void URedisObject::AsyncSetStr(const FString& InKey, const FString& InValue)
+bool URedisObject::PublishBytes(const FString& Channel, const TArray<uint8>& Message)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	return RunCommand(FString(), [&](URedisClient& RedisClient)
+	{
+		return RedisClient.PublishBytes(Channel, Message);
+	});
+}
 
-	FAsyncTask<AsyncSetStrTask>* AsyncTaskPtr = new FAsyncTask<AsyncSetStrTask>(InKey, InValue, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+void URedisObject::Subscribe(const FString& Channel)
+{
+	SubscribeChannel(Channel, FRedisMessageHandler());
 }
 
-void URedisObject::AsyncSAdd(const FString& InKey, const TArray<FString>& InMemberList)
+void URedisObject::Unsubscribe(const FString& Channel)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	if (!Subscriber.IsValid())
+	{
+		return;
+	}
+	ChannelHandlers.Remove(Channel);
+	Subscriber->Unsubscribe(Channel);
+}
 
-	FAsyncTask<AsyncSAddTask>* AsyncTaskPtr = new FAsyncTask<AsyncSAddTask>(InKey, InMemberList, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+void URedisObject::SubscribeChannel(const FString& Channel, FRedisMessageHandler Handler)
+{
+	if (!Subscriber.IsValid())
+	{
+		return;
+	}
+	ChannelHandlers.Add(Channel, Handler);
+	Subscriber->Subscribe(Channel);
 }
 
-void URedisObject::AsyncSRem(const FString& InKey, const TArray<FString>& InMemberList)
+void URedisObject::PSubscribe(const FString& Pattern, FRedisMessageHandler Handler)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	if (!Subscriber.IsValid())
+	{
+		return;
+	}
+	PatternHandlers.Add(Pattern, Handler);
+	Subscriber->PSubscribe(Pattern);
+}
 
-	FAsyncTask<AsyncSRemTask>* AsyncTaskPtr = new FAsyncTask<AsyncSRemTask>(InKey, InMemberList, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+void URedisObject::SubscribeConflated(const FString& Channel, FRedisMessageHandler Handler, const FString& KeyField)
+{
+	if (!Subscriber.IsValid())
+	{
+		return;
+	}
+	ChannelHandlers.Add(Channel, Handler);
+	Subscriber->Subscribe(Channel, true, KeyField);
 }
 
-void URedisObject::AsyncHSet(const FString& InKey, const FString& InField, const FString& InValue)
+void URedisObject::PSubscribeConflated(const FString& Pattern, FRedisMessageHandler Handler, const FString& KeyField)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	if (!Subscriber.IsValid())
+	{
+		return;
+	}
+	PatternHandlers.Add(Pattern, Handler);
+	Subscriber->PSubscribe(Pattern, true, KeyField);
+}
 
-	FAsyncTask<AsyncHSetTask>* AsyncTaskPtr = new FAsyncTask<AsyncHSetTask>(InKey, InField, InValue, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+void URedisObject::PUnsubscribe(const FString& Pattern)
+{
+	if (!Subscriber.IsValid())
+	{
+		return;
+	}
+	PatternHandlers.Remove(Pattern);
+	Subscriber->PUnsubscribe(Pattern);
 }
 
-void URedisObject::AsyncHMSet(const FString& InKey, const TMap<FString, FString>& InFieldValueMap)
+void URedisObject::AsyncSMembers(const FString& InKey, FSMembersFinished OnFinished, bool bReadFromReplica)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	POP_ASYNC_RESULT(SMembers, ResultHandler);
+	ResultHandler->SMembersCallback = OnFinished;
 
-	FAsyncTask<AsyncHMSetTask>* AsyncTaskPtr = new FAsyncTask<AsyncHMSetTask>(InKey, InFieldValueMap, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	FRedisAsyncRequest* Request = new FRedisAsyncRequest();
+	Request->Args.Add("SMEMBERS").Add(InKey);
+	Request->OnReply = [this, ResultHandler](redisReply* Reply)
+	{
+		ResultHandler->bResult = FRedisReplyParser::ParseArray(Reply, ResultHandler->ResultMemberList);
+		OnNotifySMembersResult(ResultHandler);
+	};
+	SubmitRead(InKey, bReadFromReplica, Request);
 }
 
-void URedisObject::AsyncHDel(const FString& InKey, const TArray<FString>& InFieldList)
+bool URedisObject::RunCommand(const FString& InKey, TFunctionRef<bool(URedisClient&)> InCommand)
 {
-	POP_ASYNC_RESULT(NoReturn, ResultHandler);
+	if (Cluster.IsValid())
+	{
+		return Cluster->Exec(InKey, InCommand);
+	}
 
-	FAsyncTask<AsyncHDelTask>* AsyncTaskPtr = new FAsyncTask<AsyncHDelTask>(InKey, InFieldList, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyNoReturnResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	FRedisPooledClient RedisClient(ConnectionPool.Get());
+	if (RedisClient)
+	{
+		return InCommand(*RedisClient);
+	}
+	return false;
 }
 
-void URedisObject::AsyncMGet(const TArray<FString>& InKeyList, FMGetFinished OnFinished)
+void URedisObject::SubmitRequest(const FString& InKey, FRedisAsyncRequest* InRequest)
 {
-	POP_ASYNC_RESULT(MGet, ResultHandler);
-	ResultHandler->MGetCallback = OnFinished;
-
-	FAsyncTask<AsyncMGetTask>* AsyncTaskPtr = new FAsyncTask<AsyncMGetTask>(InKeyList, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyMGetResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	if (Cluster.IsValid())
+	{
+		Cluster->Submit(InKey, InRequest);
+		return;
+	}
+	// Null before Init, or when the engine failed to start
+	if (!AsyncEngine.IsValid())
+	{
+		FailAsyncRequest(InRequest);
+		return;
+	}
+	AsyncEngine->Submit(InRequest);
 }
 
-void URedisObject::AsyncGetInt(const FString& InKey, FGetIntFinished OnFinished)
+void URedisObject::DeliverMessages()
 {
-	POP_ASYNC_RESULT(GetInt, ResultHandler);
-	ResultHandler->GetIntCallback = OnFinished;
+	const double Deadline = FPlatformTime::Seconds() + PubSubTickBudgetUs * 0.000001;
+	int32 DeliveredNum = 0;
+
+	FRedisPubSubMessage PubSubMessage;
+	while (Subscriber->PopMessage(PubSubMessage))
+	{
+		const FRedisMessageHandler* Found = PubSubMessage.Pattern.IsEmpty()
+			? ChannelHandlers.Find(PubSubMessage.Channel)
+			: PatternHandlers.Find(PubSubMessage.Pattern);
+		if (Found)
+		{
+			// Copied, the handler may subscribe or unsubscribe and so change the map it lives in
+			const FRedisMessageHandler Handler = *Found;
+			Handler.ExecuteIfBound(PubSubMessage.Channel, PubSubMessage.Message);
+		}
+		SubscribeReply.Broadcast(PubSubMessage.Channel, PubSubMessage.Message);
+
+		++DeliveredNum;
+		if (PubSubDrain == ERedisPubSubDrain::MaxMessages && DeliveredNum >= PubSubMaxMessagesPerTick)
+		{
+			break;
+		}
+		if (PubSubDrain == ERedisPubSubDrain::TimeBudget && FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+	}
 
-	FAsyncTask<AsyncGetIntTask>* AsyncTaskPtr = new FAsyncTask<AsyncGetIntTask>(InKey, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyGetIntResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	INC_DWORD_STAT_BY(STAT_RedisPubSubBacklog, Subscriber->GetBacklog());
+	FRedisStats::ReportPubSubOldestAge(Subscriber->GetOldestAge());
 }
 
-void URedisObject::AsyncGetStr(const FString& InKey, FGetStrFinished OnFinished)
+int32 URedisObject::GetPubSubBacklog() const
 {
-	POP_ASYNC_RESULT(GetStr, ResultHandler);
-	ResultHandler->GetStrCallback = OnFinished;
-
-	FAsyncTask<AsyncGetStrTask>* AsyncTaskPtr = new FAsyncTask<AsyncGetStrTask>(InKey, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyGetStrResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	return Subscriber.IsValid() ? Subscriber->GetBacklog() : 0;
 }
 
-void URedisObject::AsyncHGet(const FString& InKey, const FString& InField, FHGetFinished OnFinished)
+float URedisObject::GetPubSubOldestAge() const
 {
-	POP_ASYNC_RESULT(HGet, ResultHandler);
-	ResultHandler->HGetCallback = OnFinished;
+	return Subscriber.IsValid() ? (float)Subscriber->GetOldestAge() : 0.f;
+}
 
-	FAsyncTask<AsyncHGetTask>* AsyncTaskPtr = new FAsyncTask<AsyncHGetTask>(InKey, InField, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyHGetResult);
-	AsyncTaskPtr->StartBackgroundTask();
+void URedisObject::GetCommandLatencies(TArray<FRedisCommandLatency>& OutLatencies) const
+{
+	FRedisLatency::GetLatencies(OutLatencies);
 }
 
-void URedisObject::AsyncHMGet(const FString& InKey, const TSet<FString>& InFieldList, FHMGetFinished OnFinished)
+bool URedisObject::DumpLatencyCsv(const FString& Path) const
 {
-	POP_ASYNC_RESULT(HMGet, ResultHandler);
-	ResultHandler->HMGetCallback = OnFinished;
+	return FRedisLatency::DumpCsv(Path);
+}
 
-	FAsyncTask<AsyncHMGetTask>* AsyncTaskPtr = new FAsyncTask<AsyncHMGetTask>(InKey, InFieldList, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyHMGetResult);
-	AsyncTaskPtr->StartBackgroundTask();
+void URedisObject::ResetLatencies()
+{
+	FRedisLatency::Reset();
 }
 
-void URedisObject::AsyncHGetAll(const FString& InKey, FHGetAllFinished OnFinished)
+bool URedisObject::GetSentinelSwitches(int32& OutSwitches, double& OutRepointSeconds) const
 {
-	POP_ASYNC_RESULT(HGetAll, ResultHandler);
-	ResultHandler->HGetAllCallback = OnFinished;
+	OutSwitches = 0;
+	OutRepointSeconds = 0.0;
+	if (!Sentinel.IsValid())
+	{
+		return false;
+	}
+	OutSwitches = Sentinel->GetSwitchCount();
+	OutRepointSeconds = Sentinel->GetLastSwitchSeconds();
+	return true;
+}
 
-	FAsyncTask<AsyncHGetAllTask>* AsyncTaskPtr = new FAsyncTask<AsyncHGetAllTask>(InKey, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifyHGetAllResult);
-	AsyncTaskPtr->StartBackgroundTask();
+void URedisObject::StartSubscriber(const FString& InHost, int32 InPort)
+{
+	Subscriber = MakeShareable(new FRedisSubscriber());
+	if (!Subscriber->Start(InHost, InPort, Password, ConnectTimeout))
+	{
+		Subscriber.Reset();
+	}
 }
 
-bool URedisObject::Publish(const FString& Channel, const FString& Message)
+void URedisObject::StartSentinel(const FString& InHost, int32 InPort)
 {
-	if (SyncRedisClient.Get())
+	if (Sentinel.IsValid())
 	{
-		return SyncRedisClient->Publish(Channel, Message);
+		return;
+	}
+
+	// Runs on the sentinel thread; both are only reset after the sentinel has been shut down
+	FRedisConnectionPool* Pool = ConnectionPool.Get();
+	FRedisAsyncEngine* Engine = AsyncEngine.Get();
+	FRedisSubscriber* PubSub = Subscriber.Get();
+	Sentinel = MakeShareable(new FRedisSentinel());
+	Sentinel->Timeout = ConnectTimeout;
+	Sentinel->OnSwitchMaster = [Pool, Engine, PubSub](const FString& InNewHost, int32 InNewPort)
+	{
+		Pool->Repoint(InNewHost, InNewPort);
+		if (Engine)
+		{
+			Engine->Repoint(InNewHost, InNewPort);
+		}
+		if (PubSub)
+		{
+			PubSub->Repoint(InNewHost, InNewPort);
+		}
+	};
+	if (!Sentinel->Start(SentinelHosts, SentinelMasterName, InHost, InPort))
+	{
+		Sentinel.Reset();
 	}
-	return false;
 }
 
-void URedisObject::Subscribe(const FString& Channel)
+bool URedisObject::RunRead(const FString& InKey, bool bReadFromReplica, TFunctionRef<bool(URedisClient&)> InCommand)
 {
-	URedisSubscribeObject* SubObject = nullptr;
-	if (SubscribeMap.Contains(Channel))
+	if (bReadFromReplica && ReplicaSet.IsValid())
 	{
-		SubObject = *SubscribeMap.Find(Channel);
-		if (SubObject)
+		bool bResult = false;
+		if (ReplicaSet->Exec(InCommand, bResult))
 		{
-			if (SubObject->SubscribeChannel.IsEmpty())
-			{
-				SubObject->Subscribe(Channel);
-				SubObject->OnSubscribeReply.BindUObject(this, &URedisObject::SubscribeCallback);
-			}
+			return bResult;
 		}
 	}
-	else
+	return RunCommand(InKey, InCommand);
+}
+
+void URedisObject::SubmitRead(const FString& InKey, bool bReadFromReplica, FRedisAsyncRequest* InRequest)
+{
+	if (bReadFromReplica && ReplicaSet.IsValid() && ReplicaSet->Submit(InRequest))
 	{
-		SubObject = NewObject<URedisSubscribeObject>(this);
-		SubObject->Init(Host, Port, Password);
-		SubObject->Subscribe(Channel);
-		SubObject->OnSubscribeReply.BindUObject(this, &URedisObject::SubscribeCallback);
-		SubscribeMap.Add(Channel, SubObject);
+		return;
 	}
+	SubmitRequest(InKey, InRequest);
 }
 
-void URedisObject::SubscribeCallback(FString Channel, FString Message)
+FString URedisObject::GetTransactionKey(const FRedisTransaction& InTransaction)
 {
-	if (SubscribeReply.IsBound())
+	if (InTransaction.GetWatchKeys().Num())
 	{
-		SubscribeReply.Broadcast(Channel, Message);
+		return InTransaction.GetWatchKeys()[0];
 	}
+
+	FString Key;
+	const FRedisPipeline& Commands = InTransaction.GetReads().IsEmpty() ? InTransaction.GetCommands() : InTransaction.GetReads();
+	Commands.ForEachCommand([&Key](const FString* Args, int32 ArgCount)
+	{
+		if (Key.IsEmpty())
+		{
+			Key = FRedisCluster::GetCommandKey(Args, ArgCount);
+		}
+	});
+	return Key;
 }
 
-void URedisObject::Unsubscribe(const FString& Channel)
+void URedisObject::WarnClusterKeyspaceScan(const FRedisScanIterator& InIterator) const
 {
-	if (SubscribeMap.Contains(Channel))
+	if (Cluster.IsValid() && InIterator.Type == ERedisScanType::Keys)
 	{
-		URedisSubscribeObject* SubObject = *SubscribeMap.Find(Channel);
-		SubObject->Unsubscribe();
+		UE_LOG(LogTemp, Warning, TEXT("Redis SCAN in cluster or sharded mode only walks the keys of one node"));
 	}
 }
 
-void URedisObject::AsyncSMembers(const FString& InKey, FSMembersFinished OnFinished)
+TSharedPtr<URedisClient> URedisObject::ConnectDedicated(const FString& InKey)
 {
-	POP_ASYNC_RESULT(SMembers, ResultHandler);
-	ResultHandler->SMembersCallback = OnFinished;
+	if (Cluster.IsValid())
+	{
+		FString NodeHost;
+		int32 NodePort = 0;
+		if (!Cluster->GetNodeAddress(InKey, NodeHost, NodePort))
+		{
+			return nullptr;
+		}
+
+		TSharedPtr<URedisClient> RedisClient = MakeShareable(new URedisClient());
+		if (!RedisClient->ConnectToRedis(NodeHost, NodePort, Password, ConnectTimeout))
+		{
+			return nullptr;
+		}
+		return RedisClient;
+	}
+
+	// Follows Sentinel failovers through the pool's address
+	return ConnectionPool.IsValid() ? ConnectionPool->OpenDedicated() : nullptr;
+}
+
+void URedisObject::OnStreamBatch(FAsyncResultStream* InResult)
+{
+	const FStreamConsumerState* State = StreamConsumers.Find(InResult->ConsumerId);
+	if (!State)
+	{
+		// Stopped meanwhile; the entries stay pending for the group
+		return;
+	}
+
+	// Copied, the handler may stop its consumer
+	const FStreamEntriesReceived OnEntries = State->OnEntries;
+	const FString Group = State->Group;
+	TArray<FString> Ids;
+	if (State->bAckAfterHandler)
+	{
+		Ids.Reserve(InResult->Entries.Num());
+		for (auto& it : InResult->Entries)
+		{
+			Ids.Add(it.Id);
+		}
+	}
+
+	FWrapStreamEntries TmpWrapEntries;
+	TmpWrapEntries.RealArray = MoveTemp(InResult->Entries);
+	OnEntries.ExecuteIfBound(InResult->Stream, TmpWrapEntries);
 
-	FAsyncTask<AsyncSMembersTask>* AsyncTaskPtr = new FAsyncTask<AsyncSMembersTask>(InKey, ResultHandler);
-	AsyncTaskPtr->GetTask().GetDelegate().BindUObject(this, &URedisObject::OnNotifySMembersResult);
-	AsyncTaskPtr->StartBackgroundTask();
+	if (Ids.Num())
+	{
+		AsyncXAck(InResult->Stream, Group, Ids);
+	}
 }
 
+void URedisObject::OnListJob(FAsyncResultJob* InResult)
+{
+	const FListConsumerState* State = ListConsumers.Find(InResult->ConsumerId);
+	if (!State)
+	{
+		return;
+	}
+
+	// Copied, the handler may stop its consumer
+	const FListJobReceived OnJob = State->OnJob;
+	const FString ProcessingList = State->ProcessingList;
+	const bool bAck = State->bAckAfterHandler;
+
+	OnJob.ExecuteIfBound(InResult->Key, InResult->Job);
+
+	if (bAck)
+	{
+		AsyncAckJob(ProcessingList, InResult->Job);
+	}
+}
@@ -0,0 +1,242 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisPipeline.h"
+
+FRedisPipeline::FRedisPipeline()
+{
+}
+
+FRedisPipeline& FRedisPipeline::Begin(const TCHAR* InCommand)
+{
+	Args.Add(InCommand);
+	ArgCounts.Add(1);
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::AddArg(const FString& InArg)
+{
+	check(ArgCounts.Num() > 0);
+
+	Args.Add(InArg);
+	++ArgCounts.Last();
+	return *this;
+}
+
+void FRedisPipeline::Reset()
+{
+	Args.Reset();
+	ArgCounts.Reset();
+	Scripts.Reset();
+}
+
+FRedisPipeline& FRedisPipeline::Command(const TArray<FString>& InArgs)
+{
+	if (InArgs.Num() > 0)
+	{
+		Args.Append(InArgs);
+		ArgCounts.Add(InArgs.Num());
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::ExistsKey(const FString& InKey)
+{
+	return Begin(TEXT("EXISTS")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::ExpireKey(const FString& InKey, int32 Sec)
+{
+	return Begin(TEXT("EXPIRE")).AddArg(InKey).AddArg(FString::FromInt(Sec));
+}
+
+FRedisPipeline& FRedisPipeline::PersistKey(const FString& InKey)
+{
+	return Begin(TEXT("PERSIST")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::DelKey(const FString& InKey)
+{
+	return Begin(TEXT("DEL")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::MSet(const TMap<FString, FString>& InMemberMap)
+{
+	Begin(TEXT("MSET"));
+	for (auto& it : InMemberMap)
+	{
+		AddArg(it.Key).AddArg(it.Value);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::MGet(const TArray<FString>& InKeyList)
+{
+	Begin(TEXT("MGET"));
+	for (auto& it : InKeyList)
+	{
+		AddArg(it);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::SetInt(const FString& InKey, int32 InValue)
+{
+	return Begin(TEXT("SET")).AddArg(InKey).AddArg(FString::FromInt(InValue));
+}
+
+FRedisPipeline& FRedisPipeline::SetStr(const FString& InKey, const FString& InValue)
+{
+	return Begin(TEXT("SET")).AddArg(InKey).AddArg(InValue);
+}
+
+FRedisPipeline& FRedisPipeline::GetStr(const FString& InKey)
+{
+	return Begin(TEXT("GET")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::Incrby(const FString& InKey, int32 Incre)
+{
+	return Begin(TEXT("INCRBY")).AddArg(InKey).AddArg(FString::FromInt(Incre));
+}
+
+FRedisPipeline& FRedisPipeline::SAdd(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	Begin(TEXT("SADD")).AddArg(InKey);
+	for (auto& it : InMemberList)
+	{
+		AddArg(it);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::SRem(const FString& InKey, const TArray<FString>& InMemberList)
+{
+	Begin(TEXT("SREM")).AddArg(InKey);
+	for (auto& it : InMemberList)
+	{
+		AddArg(it);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::SMembers(const FString& InKey)
+{
+	return Begin(TEXT("SMEMBERS")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::HSet(const FString& InKey, const FString& InField, const FString& InValue)
+{
+	return Begin(TEXT("HSET")).AddArg(InKey).AddArg(InField).AddArg(InValue);
+}
+
+FRedisPipeline& FRedisPipeline::HGet(const FString& InKey, const FString& InField)
+{
+	return Begin(TEXT("HGET")).AddArg(InKey).AddArg(InField);
+}
+
+FRedisPipeline& FRedisPipeline::HIncrby(const FString& InKey, const FString& InField, int32 Incre)
+{
+	return Begin(TEXT("HINCRBY")).AddArg(InKey).AddArg(InField).AddArg(FString::FromInt(Incre));
+}
+
+FRedisPipeline& FRedisPipeline::HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap)
+{
+	Begin(TEXT("HMSET")).AddArg(InKey);
+	for (auto& it : InMemberMap)
+	{
+		AddArg(it.Key).AddArg(it.Value);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::HDel(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	Begin(TEXT("HDEL")).AddArg(InKey);
+	for (auto& it : InFieldList)
+	{
+		AddArg(it);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::HMGet(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	Begin(TEXT("HMGET")).AddArg(InKey);
+	for (auto& it : InFieldList)
+	{
+		AddArg(it);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::HGetAll(const FString& InKey)
+{
+	return Begin(TEXT("HGETALL")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::LPush(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	Begin(TEXT("LPUSH")).AddArg(InKey);
+	for (auto& it : InFieldList)
+	{
+		AddArg(it);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::RPush(const FString& InKey, const TArray<FString>& InFieldList)
+{
+	Begin(TEXT("RPUSH")).AddArg(InKey);
+	for (auto& it : InFieldList)
+	{
+		AddArg(it);
+	}
+	return *this;
+}
+
+FRedisPipeline& FRedisPipeline::LPop(const FString& InKey)
+{
+	return Begin(TEXT("LPOP")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::RPop(const FString& InKey)
+{
+	return Begin(TEXT("RPOP")).AddArg(InKey);
+}
+
+FRedisPipeline& FRedisPipeline::LRange(const FString& InKey, int32 Start, int32 End)
+{
+	return Begin(TEXT("LRANGE")).AddArg(InKey).AddArg(FString::FromInt(Start)).AddArg(FString::FromInt(End));
+}
+
+FRedisPipeline& FRedisPipeline::Publish(const FString& InChannel, const FString& InMessage)
+{
+	return Begin(TEXT("PUBLISH")).AddArg(InChannel).AddArg(InMessage);
+}
+
+FRedisPipeline& FRedisPipeline::EvalScript(const TSharedRef<URedisScript, ESPMode::ThreadSafe>& InScript, const TArray<FString>& InKeys, const TArray<FString>& InArgs)
+{
+	Begin(TEXT("EVALSHA")).AddArg(InScript->GetSha1()).AddArg(FString::FromInt(InKeys.Num()));
+	for (auto& it : InKeys)
+	{
+		AddArg(it);
+	}
+	for (auto& it : InArgs)
+	{
+		AddArg(it);
+	}
+	Scripts.Emplace(ArgCounts.Num() - 1, InScript);
+	return *this;
+}
+
+TSharedPtr<URedisScript, ESPMode::ThreadSafe> FRedisPipeline::FindScript(int32 InCommandIndex) const
+{
+	for (auto& it : Scripts)
+	{
+		if (it.Key == InCommandIndex)
+		{
+			return it.Value;
+		}
+	}
+	return nullptr;
+}
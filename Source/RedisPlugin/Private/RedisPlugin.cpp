@@ -1,18 +1,27 @@
 // Copyright (C) 2019 GameSeed - All Rights Reserved
 
 #include "RedisPlugin.h"
+#include "RedisStructLayout.h"
+#include "UObject/UObjectGlobals.h"
 
 #define LOCTEXT_NAMESPACE "FRedisPluginModule"
 
 void FRedisPluginModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	// Hot reload and Live Coding replace struct objects; cached hash layouts hold their old offsets
+	ObjectsReplacedHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddLambda([](const TMap<UObject*, UObject*>&)
+	{
+		FRedisStructLayout::ClearCache();
+	});
 }
 
 void FRedisPluginModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedHandle);
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,200 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisReplicaSet.h"
+#include "RedisClient.h"
+#include "RedisConnectionPool.h"
+#include "RedisAsyncEngine.h"
+
+/** Seconds a replica that failed to hand out a connection is left alone. */
+static const double RedisReplicaRetryDelay = 5.0;
+
+static int64 RedisNowMs()
+{
+	return (int64)(FPlatformTime::Seconds() * 1000.0);
+}
+
+FRedisReplicaSet::FRedisReplicaSet() :
+	bLeastOutstanding(false),
+	MinPoolSize(2),
+	MaxPoolSize(16),
+	PoolIdleTimeout(60.f),
+	PoolValidateAfter(10.f),
+	AsyncConnectionNum(2)
+{
+}
+
+FRedisReplicaSet::~FRedisReplicaSet()
+{
+	Shutdown();
+}
+
+bool FRedisReplicaSet::Init(const TArray<FString>& InReplicas, const FString& InPassword)
+{
+	Shutdown();
+
+	int32 ConnectedNum = 0;
+	for (const FString& it : InReplicas)
+	{
+		TUniquePtr<FReplica> Replica = MakeUnique<FReplica>();
+		FString PortStr;
+		if (!it.Split(TEXT(":"), &Replica->Host, &PortStr, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+		{
+			Replica->Host = it;
+		}
+		Replica->Port = PortStr.IsEmpty() ? 6379 : FCString::Atoi(*PortStr);
+
+		Replica->Pool = MakeShareable(new FRedisConnectionPool());
+		Replica->Pool->IdleTimeout = PoolIdleTimeout;
+		Replica->Pool->ValidateAfter = PoolValidateAfter;
+		if (Replica->Pool->Init(Replica->Host, Replica->Port, InPassword, MinPoolSize, MaxPoolSize))
+		{
+			++ConnectedNum;
+		}
+		else
+		{
+			// Kept: the pool connects lazily once the replica comes back
+			UE_LOG(LogTemp, Warning, TEXT("Redis replica %s:%d unreachable"), *Replica->Host, Replica->Port);
+			MarkDown(*Replica);
+		}
+
+		Replica->Engine = MakeShareable(new FRedisAsyncEngine());
+		if (!Replica->Engine->Start(Replica->Host, Replica->Port, InPassword, AsyncConnectionNum))
+		{
+			Replica->Engine.Reset();
+		}
+		Replicas.Add(MoveTemp(Replica));
+	}
+	return ConnectedNum > 0;
+}
+
+void FRedisReplicaSet::Shutdown()
+{
+	for (auto& it : Replicas)
+	{
+		if (it->Engine.IsValid())
+		{
+			it->Engine->Shutdown();
+		}
+		it->Pool->Shutdown();
+	}
+	Replicas.Reset();
+}
+
+void FRedisReplicaSet::SelectIndex(int32 InIndex)
+{
+	for (auto& it : Replicas)
+	{
+		it->Pool->SelectIndex(InIndex);
+		if (it->Engine.IsValid())
+		{
+			it->Engine->SelectIndex(InIndex);
+		}
+	}
+}
+
+void FRedisReplicaSet::ReapIdle()
+{
+	for (auto& it : Replicas)
+	{
+		it->Pool->ReapIdle();
+	}
+}
+
+bool FRedisReplicaSet::Exec(TFunctionRef<bool(URedisClient&)> InCommand, bool& bOutResult)
+{
+	for (int32 Attempt = 0; Attempt < Replicas.Num(); ++Attempt)
+	{
+		FReplica* Replica = Pick(false);
+		if (!Replica)
+		{
+			return false;
+		}
+
+		FRedisPooledClient RedisClient(Replica->Pool.Get());
+		if (!RedisClient)
+		{
+			MarkDown(*Replica);
+			continue;
+		}
+
+		Replica->Outstanding.Increment();
+		bOutResult = InCommand(*RedisClient);
+		Replica->Outstanding.Decrement();
+		return true;
+	}
+	return false;
+}
+
+bool FRedisReplicaSet::Submit(FRedisAsyncRequest* InRequest)
+{
+	FReplica* Replica = Pick(true);
+	if (!Replica)
+	{
+		return false;
+	}
+
+	// Replicas outlive every engine request: Shutdown stops the engines before freeing them
+	Replica->Outstanding.Increment();
+	InRequest->OnReply = [this, Replica, InRequest, OnReply = MoveTemp(InRequest->OnReply)](redisReply* Reply) mutable
+	{
+		Replica->Outstanding.Decrement();
+		if (!Reply)
+		{
+			// The engine keeps running without a connection, so it has to be skipped from here
+			MarkDown(*Replica);
+			if (OnFallback)
+			{
+				FRedisAsyncRequest* Retry = new FRedisAsyncRequest();
+				Retry->Args = MoveTemp(InRequest->Args);
+				Retry->OnReply = MoveTemp(OnReply);
+				OnFallback(Retry);
+				return;
+			}
+		}
+		if (OnReply)
+		{
+			OnReply(Reply);
+		}
+	};
+	Replica->Engine->Submit(InRequest);
+	return true;
+}
+
+FRedisReplicaSet::FReplica* FRedisReplicaSet::Pick(bool bAsync)
+{
+	const int32 ReplicaNum = Replicas.Num();
+	if (ReplicaNum == 0)
+	{
+		return nullptr;
+	}
+
+	const int64 NowMs = RedisNowMs();
+	const int32 Start = (uint32)NextIndex.Increment() % ReplicaNum;
+	FReplica* Best = nullptr;
+	for (int32 i = 0; i < ReplicaNum; ++i)
+	{
+		FReplica* Replica = Replicas[(Start + i) % ReplicaNum].Get();
+		if (Replica->DownUntilMs.GetValue() > NowMs)
+		{
+			continue;
+		}
+		if (bAsync && !(Replica->Engine.IsValid() && Replica->Engine->IsRunning()))
+		{
+			continue;
+		}
+		if (!bLeastOutstanding)
+		{
+			return Replica;
+		}
+		if (!Best || Replica->Outstanding.GetValue() < Best->Outstanding.GetValue())
+		{
+			Best = Replica;
+		}
+	}
+	return Best;
+}
+
+void FRedisReplicaSet::MarkDown(FReplica& InReplica)
+{
+	InReplica.DownUntilMs.Set(RedisNowMs() + (int64)(RedisReplicaRetryDelay * 1000.0));
+}
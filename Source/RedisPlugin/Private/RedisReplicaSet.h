@@ -0,0 +1,82 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+class URedisClient;
+class FRedisConnectionPool;
+class FRedisAsyncEngine;
+struct FRedisAsyncRequest;
+
+/**
+ * Read replicas of the primary, each with a connection pool and an async engine of its own.
+ * Reads pick a replica round robin, or the one with the fewest requests in flight. A replica
+ * that can't hand out a connection, or loses one under an async read, is skipped for a while
+ * and the read moves on to the next one; when none is usable the read falls back to the primary.
+ */
+class FRedisReplicaSet
+{
+public:
+
+	FRedisReplicaSet();
+	~FRedisReplicaSet();
+
+	/** InReplicas are "host:port" (port defaults to 6379). Returns false if none of them answered. */
+	bool Init(const TArray<FString>& InReplicas, const FString& InPassword);
+
+	void Shutdown();
+
+	void SelectIndex(int32 InIndex);
+
+	void ReapIdle();
+
+	/** Runs InCommand on a replica connection. Returns false, without running it, if no replica is usable. */
+	bool Exec(TFunctionRef<bool(URedisClient&)> InCommand, bool& bOutResult);
+
+	/** Hands InRequest to a replica engine. Returns false, leaving InRequest with the caller, if none is running. */
+	bool Submit(FRedisAsyncRequest* InRequest);
+
+	int32 Num() const
+	{
+		return Replicas.Num();
+	}
+
+public:
+	/** Pick by fewest requests in flight instead of round robin. */
+	bool	bLeastOutstanding;
+
+	/** Applied to the pool and engine of every replica. */
+	int32	MinPoolSize;
+	int32	MaxPoolSize;
+	float	PoolIdleTimeout;
+	float	PoolValidateAfter;
+	int32	AsyncConnectionNum;
+
+	/** Retries on the primary an async read whose replica connection dropped. Runs on that replica's I/O thread. */
+	TFunction<void(FRedisAsyncRequest*)>	OnFallback;
+
+private:
+	struct FReplica
+	{
+		FString		Host;
+		int32		Port;
+		TSharedPtr<FRedisConnectionPool>	Pool;
+		TSharedPtr<FRedisAsyncEngine>		Engine;
+		/** Sync and async requests currently sent to this replica. */
+		FThreadSafeCounter		Outstanding;
+		/** Milliseconds (FPlatformTime) until which the replica is skipped. */
+		FThreadSafeCounter64	DownUntilMs;
+	};
+
+	/** Null if no replica is usable; bAsync also requires a running engine. */
+	FReplica* Pick(bool bAsync);
+
+	static void MarkDown(FReplica& InReplica);
+
+private:
+	TArray<TUniquePtr<FReplica>>	Replicas;
+	FThreadSafeCounter				NextIndex;
+};
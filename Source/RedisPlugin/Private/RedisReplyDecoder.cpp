@@ -0,0 +1,214 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisReplyDecoder.h"
+#include "RedisReplyParser.h"
+#include "RedisCompression.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+namespace
+{
+	/** Only depth matters: the root is the reply itself, its direct children are the elements. */
+	bool IsRoot(const redisReadTask* InTask)
+	{
+		return InTask->parent == nullptr;
+	}
+
+	bool IsElement(const redisReadTask* InTask)
+	{
+		return InTask->parent != nullptr && InTask->parent->parent == nullptr;
+	}
+}
+
+FRedisReplyDecoder::FRedisReplyDecoder(TArray<FString>& InList) :
+	bSkipNil(true),
+	bDecompress(false),
+	List(&InList),
+	Map(nullptr),
+	Slots(nullptr),
+	Size(0),
+	bArray(false),
+	bError(false)
+{
+}
+
+FRedisReplyDecoder::FRedisReplyDecoder(TMap<FString, FString>& InMap) :
+	bSkipNil(true),
+	bDecompress(false),
+	List(nullptr),
+	Map(&InMap),
+	Slots(nullptr),
+	Size(0),
+	bArray(false),
+	bError(false)
+{
+}
+
+FRedisReplyDecoder::FRedisReplyDecoder(const TArray<FString*>& InSlots) :
+	bSkipNil(true),
+	bDecompress(false),
+	List(nullptr),
+	Map(nullptr),
+	Slots(&InSlots),
+	Size(0),
+	bArray(false),
+	bError(false)
+{
+}
+
+bool FRedisReplyDecoder::Read(redisContext* InContext)
+{
+	static redisReplyObjectFunctions DecoderFunctions =
+	{
+		&FRedisReplyDecoder::CreateString,
+		&FRedisReplyDecoder::CreateArray,
+		&FRedisReplyDecoder::CreateInteger,
+		&FRedisReplyDecoder::CreateNil,
+		&FRedisReplyDecoder::FreeObject
+	};
+
+	if (!InContext || !InContext->reader)
+	{
+		return false;
+	}
+
+	redisReader* Reader = InContext->reader;
+	redisReplyObjectFunctions* SavedFunctions = Reader->fn;
+	void* SavedPrivdata = Reader->privdata;
+	Reader->fn = &DecoderFunctions;
+	Reader->privdata = this;
+
+	void* Reply = nullptr;
+	const int Status = redisGetReply(InContext, &Reply);
+
+	// A read cut short leaves the half-built root behind; it must not reach the default freeObject
+	if (Reader->reply == this)
+	{
+		Reader->reply = nullptr;
+	}
+	Reader->fn = SavedFunctions;
+	Reader->privdata = SavedPrivdata;
+
+	return Status == REDIS_OK && Reply == this && bArray && !bError;
+}
+
+void FRedisReplyDecoder::AddElement(int32 InIndex, FString&& InValue)
+{
+	if (List)
+	{
+		List->Add(MoveTemp(InValue));
+	}
+	else if (Map)
+	{
+		if ((InIndex & 1) == 0)
+		{
+			PendingField = MoveTemp(InValue);
+		}
+		else
+		{
+			Map->Add(MoveTemp(PendingField), MoveTemp(InValue));
+		}
+	}
+	else if (Slots && Slots->IsValidIndex(InIndex))
+	{
+		*(*Slots)[InIndex] = MoveTemp(InValue);
+	}
+}
+
+void* FRedisReplyDecoder::CreateString(const redisReadTask* InTask, char* InStr, size_t InLen)
+{
+	FRedisReplyDecoder* Decoder = (FRedisReplyDecoder*)InTask->privdata;
+	Decoder->Size += InLen;
+	if (IsRoot(InTask))
+	{
+		if (InTask->type == REDIS_REPLY_ERROR)
+		{
+			Decoder->Error = FRedisReplyParser::ToString(InStr, InLen);
+			UE_LOG(LogTemp, Warning, TEXT("Redis error reply: %s"), *Decoder->Error);
+		}
+		// Status or error where an array was expected
+		Decoder->bError = true;
+	}
+	else if (IsElement(InTask))
+	{
+		FString Value;
+		if (!Decoder->bDecompress)
+		{
+			Value = FRedisReplyParser::ToString(InStr, InLen);
+		}
+		else if (!FRedisCompression::ToString(InStr, InLen, Value))
+		{
+			Decoder->bError = true;
+		}
+		Decoder->AddElement(InTask->idx, MoveTemp(Value));
+	}
+	return Decoder;
+}
+
+void* FRedisReplyDecoder::CreateArray(const redisReadTask* InTask, int InElements)
+{
+	FRedisReplyDecoder* Decoder = (FRedisReplyDecoder*)InTask->privdata;
+	if (IsRoot(InTask))
+	{
+		Decoder->bArray = true;
+		if (Decoder->List)
+		{
+			Decoder->List->Reserve(Decoder->List->Num() + InElements);
+		}
+		else if (Decoder->Map)
+		{
+			Decoder->Map->Reserve(Decoder->Map->Num() + InElements / 2);
+		}
+	}
+	return Decoder;
+}
+
+void* FRedisReplyDecoder::CreateInteger(const redisReadTask* InTask, long long InValue)
+{
+	FRedisReplyDecoder* Decoder = (FRedisReplyDecoder*)InTask->privdata;
+	if (IsRoot(InTask))
+	{
+		Decoder->bError = true;
+	}
+	else if (IsElement(InTask))
+	{
+		Decoder->AddElement(InTask->idx, LexToString((int64)InValue));
+	}
+	return Decoder;
+}
+
+void* FRedisReplyDecoder::CreateNil(const redisReadTask* InTask)
+{
+	FRedisReplyDecoder* Decoder = (FRedisReplyDecoder*)InTask->privdata;
+	if (IsRoot(InTask))
+	{
+		// Nil multi-bulk: a valid, empty result
+		Decoder->bArray = true;
+	}
+	else if (IsElement(InTask))
+	{
+		if (Decoder->Map)
+		{
+			Decoder->AddElement(InTask->idx, FString());
+		}
+		else if (Decoder->List && !Decoder->bSkipNil)
+		{
+			Decoder->AddElement(InTask->idx, FString());
+		}
+	}
+	return Decoder;
+}
+
+void FRedisReplyDecoder::FreeObject(void* InObject)
+{
+	// Every object is the decoder itself, owned by the caller
+}
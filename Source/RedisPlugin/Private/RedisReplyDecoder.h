@@ -0,0 +1,75 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct redisContext;
+struct redisReadTask;
+
+/**
+ * Reads one array reply straight into UE containers.
+ * The connection's reader is switched to custom redisReplyObjectFunctions for the duration
+ * of the read, so elements go from the socket buffer into FStrings without an intermediate
+ * redisReply tree (one malloc per element) in between.
+ * Only for blocking connections with exactly one reply outstanding.
+ */
+class FRedisReplyDecoder
+{
+public:
+
+	/** Elements are appended in reply order. */
+	explicit FRedisReplyDecoder(TArray<FString>& InList);
+
+	/** Elements are taken as alternating field/value pairs (HGETALL). */
+	explicit FRedisReplyDecoder(TMap<FString, FString>& InMap);
+
+	/** Element i is written to *InSlots[i] (HMGET); nil elements leave the slot untouched. */
+	explicit FRedisReplyDecoder(const TArray<FString*>& InSlots);
+
+	/** Returns false on I/O errors, error replies and anything that is not an array. */
+	bool Read(redisContext* InContext);
+
+	/** Text of the error reply, if the server answered with one instead of an array. */
+	const FString& GetError() const
+	{
+		return Error;
+	}
+
+	/** Bytes of every string read, for FRedisStats. */
+	uint64 GetSize() const
+	{
+		return Size;
+	}
+
+	/** Nil elements of a list are dropped rather than stored as empty strings. */
+	bool bSkipNil;
+
+	/** Elements may be compressed values (see FRedisCompression); one that fails to decode fails the read. */
+	bool bDecompress;
+
+private:
+
+	void AddElement(int32 InIndex, FString&& InValue);
+
+	static void* CreateString(const redisReadTask* InTask, char* InStr, size_t InLen);
+
+	static void* CreateArray(const redisReadTask* InTask, int InElements);
+
+	static void* CreateInteger(const redisReadTask* InTask, long long InValue);
+
+	static void* CreateNil(const redisReadTask* InTask);
+
+	static void FreeObject(void* InObject);
+
+private:
+	TArray<FString>*			List;
+	TMap<FString, FString>*		Map;
+	const TArray<FString*>*		Slots;
+
+	FString		PendingField;
+	FString		Error;
+	uint64		Size;
+	bool		bArray;
+	bool		bError;
+};
@@ -0,0 +1,325 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisReplyParser.h"
+#include "AsyncRedisDefines.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+static void FlattenReplyElements(const redisReply* InReply, TArray<FString>& OutElements)
+{
+	for (size_t i = 0; i < InReply->elements; i++)
+	{
+		const redisReply* Element = InReply->element[i];
+		switch (Element->type)
+		{
+			case REDIS_REPLY_STRING:
+			case REDIS_REPLY_STATUS:
+			case REDIS_REPLY_ERROR:
+				OutElements.Add(FRedisReplyParser::ToString(Element->str, Element->len));
+				break;
+			case REDIS_REPLY_INTEGER:
+				OutElements.Add(FString::Printf(TEXT("%lld"), Element->integer));
+				break;
+			case REDIS_REPLY_ARRAY:
+				FlattenReplyElements(Element, OutElements);
+				break;
+			default:
+				OutElements.AddDefaulted();
+				break;
+		}
+	}
+}
+
+FString FRedisReplyParser::ToString(const char* InStr, size_t InLen)
+{
+	FUTF8ToTCHAR Converted(InStr, (int32)InLen);
+	return FString(Converted.Length(), Converted.Get());
+}
+
+void FRedisReplyParser::ToReply(const redisReply* InReply, FRedisReply& OutReply)
+{
+	if (!InReply)
+	{
+		OutReply.Type = ERedisReplyType::Error;
+		OutReply.Str = TEXT("ERR connection lost");
+		return;
+	}
+
+	switch (InReply->type)
+	{
+		case REDIS_REPLY_STRING:
+			OutReply.Type = ERedisReplyType::String;
+			OutReply.Str = ToString(InReply->str, InReply->len);
+			break;
+		case REDIS_REPLY_STATUS:
+			OutReply.Type = ERedisReplyType::Status;
+			OutReply.Str = ToString(InReply->str, InReply->len);
+			break;
+		case REDIS_REPLY_ERROR:
+			OutReply.Type = ERedisReplyType::Error;
+			OutReply.Str = ToString(InReply->str, InReply->len);
+			break;
+		case REDIS_REPLY_INTEGER:
+			OutReply.Type = ERedisReplyType::Integer;
+			OutReply.Integer = InReply->integer;
+			break;
+		case REDIS_REPLY_ARRAY:
+			OutReply.Type = ERedisReplyType::Array;
+			OutReply.Elements.Reserve(InReply->elements);
+			FlattenReplyElements(InReply, OutReply.Elements);
+			break;
+		default:
+			OutReply.Type = ERedisReplyType::Nil;
+			break;
+	}
+}
+
+bool FRedisReplyParser::IsNoScript(const redisReply* InReply)
+{
+	return InReply && InReply->type == REDIS_REPLY_ERROR && InReply->len >= 8 && FCStringAnsi::Strncmp(InReply->str, "NOSCRIPT", 8) == 0;
+}
+
+bool FRedisReplyParser::ParseStatus(const redisReply* InReply)
+{
+	return InReply && InReply->type != REDIS_REPLY_ERROR;
+}
+
+bool FRedisReplyParser::ParseBool(const redisReply* InReply)
+{
+	return InReply && InReply->type == REDIS_REPLY_INTEGER && InReply->integer != 0;
+}
+
+bool FRedisReplyParser::ParseInt(const redisReply* InReply, int32& OutValue)
+{
+	if (!InReply)
+	{
+		return false;
+	}
+
+	switch (InReply->type)
+	{
+		case REDIS_REPLY_INTEGER:
+			OutValue = InReply->integer;
+			return true;
+		case REDIS_REPLY_STRING:
+			OutValue = atoi(InReply->str);
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool FRedisReplyParser::ParseString(const redisReply* InReply, FString& OutValue)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_STRING)
+	{
+		return false;
+	}
+
+	OutValue = ToString(InReply->str, InReply->len);
+	return true;
+}
+
+bool FRedisReplyParser::ParseDouble(const redisReply* InReply, double& OutValue)
+{
+	if (!InReply)
+	{
+		return false;
+	}
+
+	switch (InReply->type)
+	{
+		case REDIS_REPLY_STRING:
+			// hiredis NUL-terminates bulk strings; strtod also understands inf/-inf
+			OutValue = FCStringAnsi::Atod(InReply->str);
+			return true;
+		case REDIS_REPLY_INTEGER:
+			OutValue = (double)InReply->integer;
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool FRedisReplyParser::ParseInt64(const redisReply* InReply, int64& OutValue)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_INTEGER)
+	{
+		return false;
+	}
+
+	OutValue = InReply->integer;
+	return true;
+}
+
+bool FRedisReplyParser::ParseArray(const redisReply* InReply, TArray<FString>& OutMemberList)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	OutMemberList.Reserve(OutMemberList.Num() + InReply->elements);
+	for (size_t i = 0; i < InReply->elements; i++)
+	{
+		if (InReply->element[i]->str != NULL)
+		{
+			OutMemberList.Add(ToString(InReply->element[i]->str, InReply->element[i]->len));
+		}
+	}
+	return true;
+}
+
+bool FRedisReplyParser::ParseMap(const redisReply* InReply, TMap<FString, FString>& OutMemberMap)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	OutMemberMap.Reserve(OutMemberMap.Num() + InReply->elements / 2);
+	for (size_t i = 0; i + 1 < InReply->elements; i += 2)
+	{
+		if (InReply->element[i]->str != NULL && InReply->element[i + 1]->str != NULL)
+		{
+			OutMemberMap.Add(ToString(InReply->element[i]->str, InReply->element[i]->len), ToString(InReply->element[i + 1]->str, InReply->element[i + 1]->len));
+		}
+	}
+	return true;
+}
+
+bool FRedisReplyParser::ParseFieldValues(const redisReply* InReply, TMap<FString, FString>& InOutMemberMap)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	size_t i = 0;
+	for (auto& it : InOutMemberMap)
+	{
+		if (i >= InReply->elements)
+		{
+			break;
+		}
+
+		if (InReply->element[i]->str != NULL)
+		{
+			it.Value = ToString(InReply->element[i]->str, InReply->element[i]->len);
+		}
+
+		++i;
+	}
+	return true;
+}
+
+bool FRedisReplyParser::ParseScoredMembers(const redisReply* InReply, TArray<FRedisScoredMember>& OutMembers)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	OutMembers.Reserve(OutMembers.Num() + InReply->elements / 2);
+	for (size_t i = 0; i + 1 < InReply->elements; i += 2)
+	{
+		FRedisScoredMember& Member = OutMembers.AddDefaulted_GetRef();
+		Member.Member = ToString(InReply->element[i]->str, InReply->element[i]->len);
+		ParseDouble(InReply->element[i + 1], Member.Score);
+	}
+	return true;
+}
+
+bool FRedisReplyParser::ParseScores(const redisReply* InReply, const TArray<FString>& InMembers, TArray<FRedisScoredMember>& OutMembers)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	const int32 Num = FMath::Min((int32)InReply->elements, InMembers.Num());
+	for (int32 i = 0; i < Num; ++i)
+	{
+		double Score = 0.0;
+		if (ParseDouble(InReply->element[i], Score))
+		{
+			OutMembers.Emplace(InMembers[i], Score);
+		}
+	}
+	return true;
+}
+
+bool FRedisReplyParser::ParseScan(const redisReply* InReply, FString& OutCursor, TArray<FString>& OutElements)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY || InReply->elements != 2)
+	{
+		return false;
+	}
+
+	const redisReply* CursorReply = InReply->element[0];
+	if (CursorReply->type != REDIS_REPLY_STRING)
+	{
+		return false;
+	}
+
+	OutCursor = ToString(CursorReply->str, CursorReply->len);
+	return ParseArray(InReply->element[1], OutElements);
+}
+
+bool FRedisReplyParser::ParseStreamEntries(const redisReply* InReply, TArray<FRedisStreamEntry>& OutEntries)
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	OutEntries.Reserve(OutEntries.Num() + InReply->elements);
+	for (size_t i = 0; i < InReply->elements; ++i)
+	{
+		const redisReply* Entry = InReply->element[i];
+		if (Entry->type != REDIS_REPLY_ARRAY || Entry->elements != 2 || Entry->element[0]->type != REDIS_REPLY_STRING)
+		{
+			continue;
+		}
+
+		FRedisStreamEntry& OutEntry = OutEntries.AddDefaulted_GetRef();
+		OutEntry.Id = ToString(Entry->element[0]->str, Entry->element[0]->len);
+		// Nil once the entry was deleted; still returned so its id can be acknowledged
+		ParseMap(Entry->element[1], OutEntry.Fields);
+	}
+	return true;
+}
+
+bool FRedisReplyParser::ParseStreamRead(const redisReply* InReply, TMap<FString, TArray<FRedisStreamEntry>>& OutEntries)
+{
+	if (InReply && InReply->type == REDIS_REPLY_NIL)
+	{
+		return true;
+	}
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < InReply->elements; ++i)
+	{
+		const redisReply* Stream = InReply->element[i];
+		if (Stream->type != REDIS_REPLY_ARRAY || Stream->elements != 2 || Stream->element[0]->type != REDIS_REPLY_STRING)
+		{
+			continue;
+		}
+
+		TArray<FRedisStreamEntry>& Entries = OutEntries.FindOrAdd(ToString(Stream->element[0]->str, Stream->element[0]->len));
+		ParseStreamEntries(Stream->element[1], Entries);
+	}
+	return true;
+}
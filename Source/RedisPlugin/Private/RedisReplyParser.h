@@ -0,0 +1,67 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct redisReply;
+struct FRedisReply;
+struct FRedisScoredMember;
+struct FRedisStreamEntry;
+
+/**
+ * Decodes raw hiredis replies into UE types. Shared by the blocking client and
+ * the async engine so both paths interpret replies the same way.
+ * Every function accepts a null reply (dropped connection) and returns false for it.
+ */
+struct FRedisReplyParser
+{
+	/** UTF-8 bytes with explicit length to FString. */
+	static FString ToString(const char* InStr, size_t InLen);
+
+	static void ToReply(const redisReply* InReply, FRedisReply& OutReply);
+
+	/** Error reply for an EVALSHA the server has no cached script for. */
+	static bool IsNoScript(const redisReply* InReply);
+
+	/** Anything but an error reply. */
+	static bool ParseStatus(const redisReply* InReply);
+
+	/** Integer reply interpreted as a boolean, e.g. EXISTS or EXPIRE. */
+	static bool ParseBool(const redisReply* InReply);
+
+	/** Integer reply, or a bulk string holding an integer. */
+	static bool ParseInt(const redisReply* InReply, int32& OutValue);
+
+	static bool ParseString(const redisReply* InReply, FString& OutValue);
+
+	/** Score reply, parsed from the reply bytes without an FString in between. Nil is false. */
+	static bool ParseDouble(const redisReply* InReply, double& OutValue);
+
+	/** Integer reply; nil (e.g. ZRANK of a missing member) is false. */
+	static bool ParseInt64(const redisReply* InReply, int64& OutValue);
+
+	/** Array reply; nil elements are skipped. */
+	static bool ParseArray(const redisReply* InReply, TArray<FString>& OutMemberList);
+
+	/** Flat field/value array as returned by HGETALL. */
+	static bool ParseMap(const redisReply* InReply, TMap<FString, FString>& OutMemberMap);
+
+	/** Array reply matched positionally against the keys of InOutMemberMap, as returned by HMGET. */
+	static bool ParseFieldValues(const redisReply* InReply, TMap<FString, FString>& InOutMemberMap);
+
+	/** Flat member/score array as returned with WITHSCORES. */
+	static bool ParseScoredMembers(const redisReply* InReply, TArray<FRedisScoredMember>& OutMembers);
+
+	/** ZMSCORE reply matched against InMembers; members without a score are left out. */
+	static bool ParseScores(const redisReply* InReply, const TArray<FString>& InMembers, TArray<FRedisScoredMember>& OutMembers);
+
+	/** Two element [cursor, elements] reply of the SCAN family. */
+	static bool ParseScan(const redisReply* InReply, FString& OutCursor, TArray<FString>& OutElements);
+
+	/** [[id, [field, value, ...]], ...] as returned by XRANGE and inside XREADGROUP/XAUTOCLAIM. */
+	static bool ParseStreamEntries(const redisReply* InReply, TArray<FRedisStreamEntry>& OutEntries);
+
+	/** [[stream, entries], ...] of XREADGROUP; nil (BLOCK timed out) is success with nothing read. */
+	static bool ParseStreamRead(const redisReply* InReply, TMap<FString, TArray<FRedisStreamEntry>>& OutEntries);
+};
@@ -0,0 +1,17 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisScript.h"
+#include "Misc/SecureHash.h"
+
+URedisScript::URedisScript(FName InName, const FString& InSource) :
+	Name(InName),
+	Source(InSource)
+{
+	// Redis hashes the script bytes as sent, which is UTF-8
+	FTCHARToUTF8 SourceUtf8(*Source, Source.Len());
+
+	uint8 Hash[FSHA1::DigestSize];
+	FSHA1::HashBuffer(SourceUtf8.Get(), SourceUtf8.Length(), Hash);
+
+	Sha1 = BytesToHex(Hash, FSHA1::DigestSize).ToLower();
+}
@@ -0,0 +1,261 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisSentinel.h"
+#include "RedisCommandArgs.h"
+#include "RedisReplyParser.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <winsock2.h>
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#define RedisPoll WSAPoll
+#else
+#include <poll.h>
+#define RedisPoll poll
+#endif
+
+/** Seconds between two rounds over the sentinel list when none of them answers. */
+static const float RedisSentinelRetryDelay = 1.f;
+
+/** Upper bound on how long the watch loop blocks, so Stop is noticed. */
+static const int32 RedisSentinelPollTimeoutMs = 200;
+
+static const ANSICHAR* RedisSwitchMasterChannel = "+switch-master";
+
+FRedisSentinel::FRedisSentinel() :
+	Timeout(0.2f),
+	MasterPort(0),
+	Thread(nullptr)
+{
+	StopEvent = FPlatformProcess::GetSynchEventFromPool(true);
+}
+
+FRedisSentinel::~FRedisSentinel()
+{
+	Shutdown();
+	FPlatformProcess::ReturnSynchEventToPool(StopEvent);
+	StopEvent = nullptr;
+}
+
+bool FRedisSentinel::ParseAddress(const FString& InAddress, FString& OutHost, int32& OutPort)
+{
+	FString PortStr;
+	if (!InAddress.Split(TEXT(":"), &OutHost, &PortStr, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+	{
+		OutHost = InAddress;
+	}
+	OutPort = PortStr.IsEmpty() ? 26379 : FCString::Atoi(*PortStr);
+	return !OutHost.IsEmpty() && OutPort > 0;
+}
+
+redisContext* FRedisSentinel::ConnectSentinel(const FString& InAddress, float InTimeout)
+{
+	FString SentinelHost;
+	int32 SentinelPort = 0;
+	if (!ParseAddress(InAddress, SentinelHost, SentinelPort))
+	{
+		return nullptr;
+	}
+
+	const int32 TimeoutUs = FMath::Max(1, FMath::RoundToInt(InTimeout * 1000000.f));
+	timeval TimeOut = { TimeoutUs / 1000000, TimeoutUs % 1000000 };
+	redisContext* Context = redisConnectWithTimeout(TCHAR_TO_ANSI(*SentinelHost), SentinelPort, TimeOut);
+	if (Context && Context->err)
+	{
+		redisFree(Context);
+		return nullptr;
+	}
+	if (Context)
+	{
+		// Replies must come back within the same budget; the watch loop polls instead
+		redisSetTimeout(Context, TimeOut);
+	}
+	return Context;
+}
+
+bool FRedisSentinel::ResolveMaster(const TArray<FString>& InSentinels, const FString& InMasterName, float InTimeout, FString& OutHost, int32& OutPort)
+{
+	FRedisCommandArgs Args;
+	Args.Add("SENTINEL").Add("get-master-addr-by-name").Add(InMasterName);
+
+	for (const FString& it : InSentinels)
+	{
+		redisContext* Context = ConnectSentinel(it, InTimeout);
+		if (!Context)
+		{
+			continue;
+		}
+
+		bool bResult = false;
+		redisReply* Reply = (redisReply*)redisCommandArgv(Context, Args.Num(), Args.GetArgv(), Args.GetArgvLen());
+		if (Reply && Reply->type == REDIS_REPLY_ARRAY && Reply->elements == 2
+			&& Reply->element[0]->type == REDIS_REPLY_STRING && Reply->element[1]->type == REDIS_REPLY_STRING)
+		{
+			OutHost = FRedisReplyParser::ToString(Reply->element[0]->str, Reply->element[0]->len);
+			OutPort = FCStringAnsi::Atoi(Reply->element[1]->str);
+			bResult = true;
+		}
+		if (Reply)
+		{
+			freeReplyObject(Reply);
+		}
+		redisFree(Context);
+
+		if (bResult)
+		{
+			return true;
+		}
+	}
+	UE_LOG(LogTemp, Warning, TEXT("No sentinel knows the primary of %s"), *InMasterName);
+	return false;
+}
+
+bool FRedisSentinel::Start(const TArray<FString>& InSentinels, const FString& InMasterName, const FString& InHost, int32 InPort)
+{
+	if (Thread)
+	{
+		return true;
+	}
+
+	Sentinels = InSentinels;
+	MasterName = InMasterName;
+	MasterHost = InHost;
+	MasterPort = InPort;
+
+	bStopping = false;
+	StopEvent->Reset();
+	Thread = FRunnableThread::Create(this, TEXT("RedisSentinel"), 0, TPri_BelowNormal);
+	return Thread != nullptr;
+}
+
+void FRedisSentinel::Shutdown()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FRedisSentinel::Stop()
+{
+	bStopping = true;
+	StopEvent->Trigger();
+}
+
+uint32 FRedisSentinel::Run()
+{
+	int32 SentinelIndex = 0;
+	while (!bStopping)
+	{
+		redisContext* Context = nullptr;
+		for (int32 i = 0; i < Sentinels.Num() && !Context; ++i)
+		{
+			Context = ConnectSentinel(Sentinels[(SentinelIndex + i) % Sentinels.Num()], Timeout);
+			if (Context)
+			{
+				SentinelIndex = (SentinelIndex + i) % Sentinels.Num();
+			}
+		}
+
+		if (!Context)
+		{
+			StopEvent->Wait(FMath::RoundToInt(RedisSentinelRetryDelay * 1000.f));
+			continue;
+		}
+
+		Watch(Context);
+		redisFree(Context);
+
+		// Lost this sentinel, try the next one first
+		SentinelIndex = (SentinelIndex + 1) % FMath::Max(1, Sentinels.Num());
+	}
+	return 0;
+}
+
+void FRedisSentinel::Watch(redisContext* InContext)
+{
+	FRedisCommandArgs Args;
+	Args.Add("SUBSCRIBE").Add(RedisSwitchMasterChannel);
+	redisReply* Reply = (redisReply*)redisCommandArgv(InContext, Args.Num(), Args.GetArgv(), Args.GetArgvLen());
+	if (!Reply)
+	{
+		return;
+	}
+	freeReplyObject(Reply);
+
+	// Subscribed first, so nothing can slip in between this answer and the first message
+	FString ResolvedHost;
+	int32 ResolvedPort = 0;
+	if (ResolveMaster(Sentinels, MasterName, Timeout, ResolvedHost, ResolvedPort))
+	{
+		SetMaster(ResolvedHost, ResolvedPort);
+	}
+
+	while (!bStopping)
+	{
+		Reply = nullptr;
+		if (redisGetReplyFromReader(InContext, (void**)&Reply) != REDIS_OK)
+		{
+			return;
+		}
+
+		if (!Reply)
+		{
+			pollfd Fd;
+			Fd.fd = InContext->fd;
+			Fd.events = POLLIN;
+			Fd.revents = 0;
+			const int32 Ready = RedisPoll(&Fd, 1, RedisSentinelPollTimeoutMs);
+			if (Ready < 0 || (Ready > 0 && redisBufferRead(InContext) != REDIS_OK))
+			{
+				return;
+			}
+			continue;
+		}
+
+		// ["message", "+switch-master", "<name> <old-ip> <old-port> <new-ip> <new-port>"]
+		if (Reply->type == REDIS_REPLY_ARRAY && Reply->elements == 3 && Reply->element[2]->type == REDIS_REPLY_STRING)
+		{
+			const FString Message = FRedisReplyParser::ToString(Reply->element[2]->str, Reply->element[2]->len);
+			TArray<FString> Fields;
+			Message.ParseIntoArray(Fields, TEXT(" "));
+			if (Fields.Num() == 5 && Fields[0] == MasterName)
+			{
+				SetMaster(Fields[3], FCString::Atoi(*Fields[4]));
+			}
+		}
+		freeReplyObject(Reply);
+	}
+}
+
+void FRedisSentinel::SetMaster(const FString& InHost, int32 InPort)
+{
+	if (InHost == MasterHost && InPort == MasterPort)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Redis primary of %s moved from %s:%d to %s:%d"), *MasterName, *MasterHost, MasterPort, *InHost, InPort);
+	MasterHost = InHost;
+	MasterPort = InPort;
+	if (OnSwitchMaster)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		OnSwitchMaster(MasterHost, MasterPort);
+		LastSwitchCycles.Set((int64)(FPlatformTime::Cycles64() - StartCycles));
+	}
+	// After the duration, so a reader seeing the new count also sees its duration
+	SwitchCount.Increment();
+}
@@ -0,0 +1,86 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+class FRunnableThread;
+class FEvent;
+struct redisContext;
+
+/**
+ * Follows the primary of one master name through Redis Sentinel.
+ * A background thread stays subscribed to +switch-master on one of the sentinels and reports
+ * the new address as soon as a failover completes. Whenever it has to (re)connect to a sentinel
+ * it also asks for the current primary, so a switch missed while disconnected is caught up.
+ */
+class FRedisSentinel : public FRunnable
+{
+public:
+
+	FRedisSentinel();
+	virtual ~FRedisSentinel();
+
+	/** Blocking: SENTINEL get-master-addr-by-name against each "host:port" in turn until one answers. */
+	static bool ResolveMaster(const TArray<FString>& InSentinels, const FString& InMasterName, float InTimeout, FString& OutHost, int32& OutPort);
+
+	/** InHost:InPort is the primary already in use; OnSwitchMaster only fires when it changes. */
+	bool Start(const TArray<FString>& InSentinels, const FString& InMasterName, const FString& InHost, int32 InPort);
+
+	void Shutdown();
+
+	/* FRunnable */
+	virtual uint32 Run() override;
+
+	virtual void Stop() override;
+
+	/** Primary changes followed since Start. */
+	int32 GetSwitchCount() const
+	{
+		return SwitchCount.GetValue();
+	}
+
+	/** Seconds OnSwitchMaster took for the last primary change. */
+	double GetLastSwitchSeconds() const
+	{
+		return FPlatformTime::ToSeconds64((uint64)LastSwitchCycles.GetValue());
+	}
+
+public:
+	/** Runs on the sentinel thread with the new primary address. */
+	TFunction<void(const FString&, int32)>	OnSwitchMaster;
+
+	/** Seconds a sentinel may take to connect or answer. */
+	float	Timeout;
+
+private:
+
+	static bool ParseAddress(const FString& InAddress, FString& OutHost, int32& OutPort);
+
+	static redisContext* ConnectSentinel(const FString& InAddress, float InTimeout);
+
+	/** Subscribes and reads switch messages until the connection drops or Stop is called. */
+	void Watch(redisContext* InContext);
+
+	void SetMaster(const FString& InHost, int32 InPort);
+
+private:
+	TArray<FString>		Sentinels;
+	FString				MasterName;
+
+	/** Sentinel thread only once started. */
+	FString				MasterHost;
+	int32				MasterPort;
+
+	FRunnableThread*	Thread;
+	FThreadSafeBool		bStopping;
+	/** Interrupts the wait between reconnect attempts. */
+	FEvent*				StopEvent;
+
+	FThreadSafeCounter		SwitchCount;
+	FThreadSafeCounter64	LastSwitchCycles;
+};
@@ -0,0 +1,199 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisStats.h"
+#include "RedisCommandArgs.h"
+#include "CoreGlobals.h"
+#include "HAL/PlatformAtomics.h"
+#include "Misc/Crc.h"
+#include "Trace/Trace.inl"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+DEFINE_STAT(STAT_RedisPubSubBacklog);
+DEFINE_STAT(STAT_RedisPubSubOldestAge);
+DEFINE_STAT(STAT_RedisPubSubConflated);
+DEFINE_STAT(STAT_RedisCommandsPerSecond);
+DEFINE_STAT(STAT_RedisBytesOutPerSecond);
+DEFINE_STAT(STAT_RedisBytesInPerSecond);
+DEFINE_STAT(STAT_RedisPoolOpen);
+DEFINE_STAT(STAT_RedisPoolInUse);
+DEFINE_STAT(STAT_RedisPendingNoReturn);
+DEFINE_STAT(STAT_RedisPendingExistsKey);
+DEFINE_STAT(STAT_RedisPendingMGet);
+DEFINE_STAT(STAT_RedisPendingGetInt);
+DEFINE_STAT(STAT_RedisPendingGetStr);
+DEFINE_STAT(STAT_RedisPendingHGet);
+DEFINE_STAT(STAT_RedisPendingHMGet);
+DEFINE_STAT(STAT_RedisPendingHGetAll);
+DEFINE_STAT(STAT_RedisPendingSMembers);
+DEFINE_STAT(STAT_RedisPendingPipeline);
+DEFINE_STAT(STAT_RedisPendingZRange);
+DEFINE_STAT(STAT_RedisPendingZScore);
+DEFINE_STAT(STAT_RedisPendingScript);
+DEFINE_STAT(STAT_RedisPendingScan);
+DEFINE_STAT(STAT_RedisPendingStream);
+DEFINE_STAT(STAT_RedisPendingJob);
+
+/** Enable with -trace=default,redis; begin and end pair up by Id, since async commands overlap. */
+UE_TRACE_CHANNEL(RedisChannel)
+
+UE_TRACE_EVENT_BEGIN(Redis, CommandBegin)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, Id)
+	/** CRC32 of the first argument after the command name, usually the key. */
+	UE_TRACE_EVENT_FIELD(uint32, KeyHash)
+	/** Bytes of every argument together. */
+	UE_TRACE_EVENT_FIELD(uint32, Size)
+	UE_TRACE_EVENT_FIELD(UE::Trace::AnsiString, Command)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Redis, CommandEnd)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, Id)
+	/** Bytes of reply payload. */
+	UE_TRACE_EVENT_FIELD(uint32, Size)
+	UE_TRACE_EVENT_FIELD(uint8, Succeeded)
+UE_TRACE_EVENT_END()
+
+#if STATS
+static volatile int64 RedisCommandNum = 0;
+static volatile int64 RedisBytesOut = 0;
+static volatile int64 RedisBytesIn = 0;
+#endif
+
+#if UE_TRACE_ENABLED
+static volatile int64 RedisTraceId = 0;
+#endif
+
+#if STATS || UE_TRACE_ENABLED
+/** Bytes of every string in InReply, nested ones included. */
+static uint64 GetReplySize(const redisReply* InReply)
+{
+	uint64 Size = InReply->str ? InReply->len : 0;
+	for (size_t i = 0; i < InReply->elements; ++i)
+	{
+		Size += GetReplySize(InReply->element[i]);
+	}
+	return Size;
+}
+#endif
+
+uint64 FRedisStats::BeginCommand(const FRedisCommandArgs& InArgs)
+{
+#if STATS
+	FPlatformAtomics::InterlockedAdd(&RedisBytesOut, InArgs.GetSize());
+#endif
+
+	uint64 Id = 0;
+#if UE_TRACE_ENABLED
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(RedisChannel))
+	{
+		Id = (uint64)FPlatformAtomics::InterlockedIncrement(&RedisTraceId);
+		const FAnsiStringView Name = InArgs.GetName();
+		const FAnsiStringView Key = InArgs.GetArg(1);
+		UE_TRACE_LOG(Redis, CommandBegin, RedisChannel)
+			<< CommandBegin.Cycle(FPlatformTime::Cycles64())
+			<< CommandBegin.Id(Id)
+			<< CommandBegin.KeyHash(Key.Len() ? FCrc::MemCrc32(Key.GetData(), Key.Len()) : 0)
+			<< CommandBegin.Size((uint32)InArgs.GetSize())
+			<< CommandBegin.Command(Name.GetData(), Name.Len());
+	}
+#endif
+	return Id;
+}
+
+void FRedisStats::EndCommand(uint64 InId, const redisReply* InReply)
+{
+#if STATS || UE_TRACE_ENABLED
+	// The reply is walked only while something reads its size: the trace channel (Id is 0 while
+	// it is off) or a stats capture. Large HGETALL/MGET replies are not walked twice otherwise.
+	bool bWantSize = InId != 0;
+#if STATS
+	bWantSize = bWantSize || FThreadStats::IsCollectingData(GET_STATID(STAT_RedisBytesInPerSecond));
+#endif
+	EndCommand(InId, InReply != nullptr, InReply && bWantSize ? GetReplySize(InReply) : 0);
+#endif
+}
+
+void FRedisStats::EndCommand(uint64 InId, bool bInSucceeded, uint64 InReplySize)
+{
+#if STATS
+	if (bInSucceeded)
+	{
+		FPlatformAtomics::InterlockedIncrement(&RedisCommandNum);
+		FPlatformAtomics::InterlockedAdd(&RedisBytesIn, (int64)InReplySize);
+	}
+#endif
+
+#if UE_TRACE_ENABLED
+	if (InId)
+	{
+		UE_TRACE_LOG(Redis, CommandEnd, RedisChannel)
+			<< CommandEnd.Cycle(FPlatformTime::Cycles64())
+			<< CommandEnd.Id(InId)
+			<< CommandEnd.Size((uint32)FMath::Min<uint64>(InReplySize, MAX_uint32))
+			<< CommandEnd.Succeeded(bInSucceeded ? 1 : 0);
+	}
+#endif
+}
+
+void FRedisStats::ReportPubSubOldestAge(double InSeconds)
+{
+#if STATS
+	static uint64 LastFrame = 0;
+	static double MaxSeconds = 0.0;
+
+	// Restarted on the first report of every frame
+	if (LastFrame != GFrameCounter)
+	{
+		LastFrame = GFrameCounter;
+		MaxSeconds = 0.0;
+	}
+	MaxSeconds = FMath::Max(MaxSeconds, InSeconds);
+	SET_FLOAT_STAT(STAT_RedisPubSubOldestAge, MaxSeconds * 1000.0);
+#endif
+}
+
+void FRedisStats::UpdateRates()
+{
+#if STATS
+	// Game thread only, whichever URedisObject ticks first
+	static double LastTime = 0.0;
+	static int64 LastCommandNum = 0;
+	static int64 LastBytesOut = 0;
+	static int64 LastBytesIn = 0;
+
+	const double Now = FPlatformTime::Seconds();
+	if (LastTime == 0.0)
+	{
+		LastTime = Now;
+		return;
+	}
+	const double Elapsed = Now - LastTime;
+	if (Elapsed < 1.0)
+	{
+		return;
+	}
+
+	const int64 CommandNum = FPlatformAtomics::AtomicRead(&RedisCommandNum);
+	const int64 BytesOut = FPlatformAtomics::AtomicRead(&RedisBytesOut);
+	const int64 BytesIn = FPlatformAtomics::AtomicRead(&RedisBytesIn);
+	SET_FLOAT_STAT(STAT_RedisCommandsPerSecond, (CommandNum - LastCommandNum) / Elapsed);
+	SET_FLOAT_STAT(STAT_RedisBytesOutPerSecond, (BytesOut - LastBytesOut) / Elapsed / 1024.0);
+	SET_FLOAT_STAT(STAT_RedisBytesInPerSecond, (BytesIn - LastBytesIn) / Elapsed / 1024.0);
+
+	LastTime = Now;
+	LastCommandNum = CommandNum;
+	LastBytesOut = BytesOut;
+	LastBytesIn = BytesIn;
+#endif
+}
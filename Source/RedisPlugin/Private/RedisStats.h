@@ -0,0 +1,76 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+class FRedisCommandArgs;
+struct redisReply;
+
+DECLARE_STATS_GROUP(TEXT("Redis"), STATGROUP_Redis, STATCAT_Advanced);
+
+/** Pub/sub messages received but not delivered yet, summed over every URedisObject. */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("PubSub Backlog"), STAT_RedisPubSubBacklog, STATGROUP_Redis, );
+
+/** Pub/sub messages overwritten by a newer one on a conflated subscription before delivery. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("PubSub Conflated"), STAT_RedisPubSubConflated, STATGROUP_Redis, );
+
+/** Age of the oldest undelivered pub/sub message, in milliseconds, over every URedisObject. */
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("PubSub Oldest Message (ms)"), STAT_RedisPubSubOldestAge, STATGROUP_Redis, );
+
+/** Commands answered per second over the last second, sync and async, every connection of the process. */
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Commands/s"), STAT_RedisCommandsPerSecond, STATGROUP_Redis, );
+
+/** Arguments written, in KB per second. */
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Sent KB/s"), STAT_RedisBytesOutPerSecond, STATGROUP_Redis, );
+
+/** Reply payload read, in KB per second; only counted while stats are being collected. */
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Received KB/s"), STAT_RedisBytesInPerSecond, STATGROUP_Redis, );
+
+/** Blocking connections open, summed over every pool (cluster nodes and replicas included). */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool Connections"), STAT_RedisPoolOpen, STATGROUP_Redis, );
+
+/** Blocking connections checked out of their pool. */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool Connections In Use"), STAT_RedisPoolInUse, STATGROUP_Redis, );
+
+/** Async calls waiting for their result, per result queue of URedisObject. */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending NoReturn"), STAT_RedisPendingNoReturn, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending ExistsKey"), STAT_RedisPendingExistsKey, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending MGet"), STAT_RedisPendingMGet, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending GetInt"), STAT_RedisPendingGetInt, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending GetStr"), STAT_RedisPendingGetStr, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending HGet"), STAT_RedisPendingHGet, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending HMGet"), STAT_RedisPendingHMGet, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending HGetAll"), STAT_RedisPendingHGetAll, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending SMembers"), STAT_RedisPendingSMembers, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Pipeline"), STAT_RedisPendingPipeline, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending ZRange"), STAT_RedisPendingZRange, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending ZScore"), STAT_RedisPendingZScore, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Script"), STAT_RedisPendingScript, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Scan"), STAT_RedisPendingScan, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Stream"), STAT_RedisPendingStream, STATGROUP_Redis, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Job"), STAT_RedisPendingJob, STATGROUP_Redis, );
+
+/**
+ * Accounting of every command for the stats above and for the "Redis" trace channel, which
+ * carries a begin and an end event per command for Unreal Insights. Safe from any thread;
+ * without STATS and with the channel off it costs a branch per command.
+ */
+struct FRedisStats
+{
+	/** Counts InArgs as sent and traces its begin. The returned id goes to EndCommand. */
+	static uint64 BeginCommand(const FRedisCommandArgs& InArgs);
+
+	/** InReply is null when the connection failed before the reply came. */
+	static void EndCommand(uint64 InId, const redisReply* InReply);
+
+	/** For replies read through FRedisReplyDecoder, which never builds a redisReply. */
+	static void EndCommand(uint64 InId, bool bInSucceeded, uint64 InReplySize);
+
+	/** Turns the counters into per second stats; called every tick, samples once a second. */
+	static void UpdateRates();
+
+	/** Game thread, once per object and tick: keeps the largest age reported this frame. */
+	static void ReportPubSubOldestAge(double InSeconds);
+};
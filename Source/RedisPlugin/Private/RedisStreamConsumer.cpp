@@ -0,0 +1,142 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisStreamConsumer.h"
+#include "RedisClient.h"
+#include "HAL/PlatformProcess.h"
+
+static const TCHAR* RedisStreamCursorStart = TEXT("0-0");
+
+FRedisStreamConsumer::FRedisStreamConsumer() :
+	NextClaimTime(0.0),
+	bClaimSupported(true)
+{
+}
+
+FRedisStreamConsumer::~FRedisStreamConsumer()
+{
+	Shutdown();
+}
+
+bool FRedisStreamConsumer::Start(const FRedisStreamConsumerSettings& InSettings)
+{
+	Settings = InSettings;
+	Settings.Count = FMath::Max(1, Settings.Count);
+	Settings.BlockMs = FMath::Max(0, Settings.BlockMs);
+	if (Settings.Consumer.IsEmpty())
+	{
+		Settings.Consumer = FString::Printf(TEXT("%s-%u"), FPlatformProcess::ComputerName(), FPlatformProcess::GetCurrentProcessId());
+	}
+	return StartThread(TEXT("RedisStreamConsumer"));
+}
+
+bool FRedisStreamConsumer::OnConnected(URedisClient& InRedisClient)
+{
+	for (const FString& it : Settings.Streams)
+	{
+		if (!InRedisClient.XGroupCreate(it, Settings.Group, TEXT("$")))
+		{
+			return false;
+		}
+	}
+	return ReadPending(InRedisClient);
+}
+
+bool FRedisStreamConsumer::Poll(URedisClient& InRedisClient)
+{
+	if (Settings.ClaimMinIdleMs > 0 && bClaimSupported && FPlatformTime::Seconds() >= NextClaimTime)
+	{
+		NextClaimTime = FPlatformTime::Seconds() + Settings.ClaimInterval;
+		return Claim(InRedisClient);
+	}
+	return ReadNew(InRedisClient);
+}
+
+float FRedisStreamConsumer::GetBlockTime() const
+{
+	return Settings.BlockMs / 1000.f;
+}
+
+FString FRedisStreamConsumer::GetDescription() const
+{
+	return FString::Printf(TEXT("stream consumer %s of %s"), *Settings.Consumer, *Settings.Group);
+}
+
+bool FRedisStreamConsumer::ReadPending(URedisClient& InRedisClient)
+{
+	for (const FString& Stream : Settings.Streams)
+	{
+		TArray<FString> Keys;
+		Keys.Add(Stream);
+		TArray<FString> Ids;
+		Ids.Add(RedisStreamCursorStart);
+
+		while (!bStopping)
+		{
+			TMap<FString, TArray<FRedisStreamEntry>> Read;
+			// Pending entries never block
+			if (!InRedisClient.XReadGroup(Settings.Group, Settings.Consumer, Keys, Ids, Settings.Count, -1, Read))
+			{
+				return false;
+			}
+
+			TArray<FRedisStreamEntry>* Entries = Read.Find(Stream);
+			if (!Entries || Entries->Num() == 0)
+			{
+				break;
+			}
+			Ids[0] = Entries->Last().Id;
+			OnEntries(Stream, MoveTemp(*Entries));
+		}
+	}
+	return true;
+}
+
+bool FRedisStreamConsumer::ReadNew(URedisClient& InRedisClient)
+{
+	TArray<FString> Ids;
+	Ids.Init(TEXT(">"), Settings.Streams.Num());
+
+	TMap<FString, TArray<FRedisStreamEntry>> Read;
+	if (!InRedisClient.XReadGroup(Settings.Group, Settings.Consumer, Settings.Streams, Ids, Settings.Count, Settings.BlockMs, Read))
+	{
+		return false;
+	}
+
+	for (auto& it : Read)
+	{
+		if (it.Value.Num())
+		{
+			OnEntries(it.Key, MoveTemp(it.Value));
+		}
+	}
+	return true;
+}
+
+bool FRedisStreamConsumer::Claim(URedisClient& InRedisClient)
+{
+	for (const FString& Stream : Settings.Streams)
+	{
+		FString Cursor = RedisStreamCursorStart;
+		do
+		{
+			TArray<FRedisStreamEntry> Entries;
+			if (!InRedisClient.XAutoClaim(Stream, Settings.Group, Settings.Consumer, Settings.ClaimMinIdleMs, Cursor, Settings.Count, Entries))
+			{
+				if (!InRedisClient.IsConnected())
+				{
+					return false;
+				}
+				// Answered with an error, e.g. a server older than 6.2
+				UE_LOG(LogTemp, Warning, TEXT("Redis XAUTOCLAIM failed, stuck stream entries are not recovered: %s"), *InRedisClient.GetLastError());
+				bClaimSupported = false;
+				return true;
+			}
+			if (Entries.Num())
+			{
+				OnEntries(Stream, MoveTemp(Entries));
+			}
+		}
+		while (Cursor != RedisStreamCursorStart && !bStopping);
+	}
+	return true;
+}
@@ -0,0 +1,54 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RedisBlockingConsumer.h"
+#include "AsyncRedisDefines.h"
+
+/**
+ * Reads streams as one consumer of a group on a connection of its own, so XREADGROUP ... BLOCK
+ * never holds up a pooled connection. After every (re)connect it first re-reads the entries
+ * still pending for this consumer, then waits for new ones, and now and then claims entries
+ * other consumers left pending for too long.
+ */
+class FRedisStreamConsumer : public FRedisBlockingConsumer
+{
+public:
+
+	FRedisStreamConsumer();
+	virtual ~FRedisStreamConsumer();
+
+	bool Start(const FRedisStreamConsumerSettings& InSettings);
+
+public:
+	/** Consumer thread: one batch read from a stream, in id order. */
+	TFunction<void(const FString&, TArray<FRedisStreamEntry>&&)>	OnEntries;
+
+protected:
+	/* FRedisBlockingConsumer */
+	virtual bool OnConnected(URedisClient& InRedisClient) override;
+
+	virtual bool Poll(URedisClient& InRedisClient) override;
+
+	virtual float GetBlockTime() const override;
+
+	virtual FString GetDescription() const override;
+
+private:
+
+	/** Entries delivered to this consumer before and never acknowledged, e.g. by a crashed run. */
+	bool ReadPending(URedisClient& InRedisClient);
+
+	bool ReadNew(URedisClient& InRedisClient);
+
+	/** One XAUTOCLAIM sweep over every stream. */
+	bool Claim(URedisClient& InRedisClient);
+
+private:
+	FRedisStreamConsumerSettings	Settings;
+
+	/** Consumer thread only. */
+	double		NextClaimTime;
+	bool		bClaimSupported;
+};
@@ -0,0 +1,264 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisStructLayout.h"
+#include "RedisCommandArgs.h"
+#include "RedisReplyParser.h"
+#include "UObject/Class.h"
+#include "UObject/UnrealType.h"
+#include "UObject/EnumProperty.h"
+#include "Misc/ScopeRWLock.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+static FRWLock RedisStructLayoutLock;
+static TMap<const UScriptStruct*, TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe>> RedisStructLayouts;
+
+TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe> FRedisStructLayout::Get(const UScriptStruct* InStruct)
+{
+	{
+		FRWScopeLock ScopeLock(RedisStructLayoutLock, SLT_ReadOnly);
+		const TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe>* Found = RedisStructLayouts.Find(InStruct);
+		if (Found && (*Found)->IsBuiltFor(InStruct))
+		{
+			return *Found;
+		}
+	}
+
+	// Built outside the lock; if two threads race, the first current one added wins
+	TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe> Layout = MakeShareable(new FRedisStructLayout(InStruct));
+	FRWScopeLock ScopeLock(RedisStructLayoutLock, SLT_Write);
+	const TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe>* Found = RedisStructLayouts.Find(InStruct);
+	if (Found && (*Found)->IsBuiltFor(InStruct))
+	{
+		return *Found;
+	}
+	RedisStructLayouts.Add(InStruct, Layout);
+	return Layout;
+}
+
+void FRedisStructLayout::ClearCache()
+{
+	FRWScopeLock ScopeLock(RedisStructLayoutLock, SLT_Write);
+	RedisStructLayouts.Reset();
+}
+
+bool FRedisStructLayout::IsBuiltFor(const UScriptStruct* InStruct) const
+{
+	// The weak pointer fails for a new struct at a freed struct's address; recompiling a
+	// UserDefinedStruct recreates its properties in place
+	return Struct.Get() == InStruct && ChildProperties == InStruct->ChildProperties && StructureSize == InStruct->GetStructureSize();
+}
+
+FRedisStructLayout::FRedisStructLayout(const UScriptStruct* InStruct) :
+	Struct(InStruct),
+	ChildProperties(InStruct->ChildProperties),
+	StructureSize(InStruct->GetStructureSize())
+{
+	for (TFieldIterator<FProperty> It(InStruct); It; ++It)
+	{
+		FProperty* Property = *It;
+		if (Property->HasAnyPropertyFlags(CPF_Transient))
+		{
+			continue;
+		}
+
+		FHashField Field;
+		Field.Property = Property;
+		Field.ValueProperty = Property;
+		Field.Enum = nullptr;
+		Field.Kind = EKind::Text;
+
+		if (Property->IsA<FBoolProperty>())
+		{
+			Field.Kind = EKind::Bool;
+		}
+		else if (FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+		{
+			Field.Kind = EKind::Enum;
+			Field.ValueProperty = EnumProperty->GetUnderlyingProperty();
+			Field.Enum = EnumProperty->GetEnum();
+		}
+		else if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+		{
+			if (NumericProperty->GetIntPropertyEnum())
+			{
+				Field.Kind = EKind::Enum;
+				Field.Enum = NumericProperty->GetIntPropertyEnum();
+			}
+			else if (Property->IsA<FFloatProperty>())
+			{
+				Field.Kind = EKind::Float;
+			}
+			else if (NumericProperty->IsFloatingPoint())
+			{
+				Field.Kind = EKind::Double;
+			}
+			else if (Property->IsA<FByteProperty>() || Property->IsA<FUInt16Property>() || Property->IsA<FUInt32Property>() || Property->IsA<FUInt64Property>())
+			{
+				Field.Kind = EKind::UInt;
+			}
+			else
+			{
+				Field.Kind = EKind::Int;
+			}
+		}
+		else if (Property->IsA<FStrProperty>())
+		{
+			Field.Kind = EKind::String;
+		}
+		else if (Property->IsA<FNameProperty>())
+		{
+			Field.Kind = EKind::Name;
+		}
+
+		// UserDefinedStruct members are named Field_N_<GUID> internally; the authored name is the one a user knows
+		const FString PropertyName = Property->GetAuthoredName();
+		for (int32 i = 0; i < Property->ArrayDim; ++i)
+		{
+			const FString Name = Property->ArrayDim > 1 ? FString::Printf(TEXT("%s[%d]"), *PropertyName, i) : PropertyName;
+			FTCHARToUTF8 NameUtf8(*Name);
+			Field.Name.Reset();
+			Field.Name.Append(NameUtf8.Get(), NameUtf8.Length());
+			Field.Offset = Property->GetOffset_ForInternal() + Property->ElementSize * i;
+			Fields.Add(Field);
+		}
+	}
+}
+
+int32 FRedisStructLayout::BuildHSet(FRedisCommandArgs& OutArgs, const FString& InKey, const void* InData, const void* InBaseline) const
+{
+	int32 WrittenNum = 0;
+	for (const FHashField& Field : Fields)
+	{
+		const uint8* Value = (const uint8*)InData + Field.Offset;
+		if (InBaseline && Field.Property->Identical(Value, (const uint8*)InBaseline + Field.Offset, PPF_None))
+		{
+			continue;
+		}
+
+		if (WrittenNum++ == 0)
+		{
+			OutArgs.Reset().Add("HSET").Add(InKey);
+		}
+		OutArgs.AddRaw(Field.Name.GetData(), Field.Name.Num());
+		AddValue(OutArgs, Field, Value);
+	}
+	return WrittenNum;
+}
+
+void FRedisStructLayout::BuildHMGet(FRedisCommandArgs& OutArgs, const FString& InKey) const
+{
+	OutArgs.Reset().Add("HMGET").Add(InKey);
+	for (const FHashField& Field : Fields)
+	{
+		OutArgs.AddRaw(Field.Name.GetData(), Field.Name.Num());
+	}
+}
+
+bool FRedisStructLayout::Decode(const redisReply* InReply, void* OutData) const
+{
+	if (!InReply || InReply->type != REDIS_REPLY_ARRAY || (int32)InReply->elements != Fields.Num())
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < Fields.Num(); ++i)
+	{
+		const redisReply* Element = InReply->element[i];
+		if (Element->type == REDIS_REPLY_STRING)
+		{
+			DecodeValue(Fields[i], Element->str, (int32)Element->len, (uint8*)OutData + Fields[i].Offset);
+		}
+	}
+	return true;
+}
+
+void FRedisStructLayout::AddValue(FRedisCommandArgs& OutArgs, const FHashField& InField, const void* InData) const
+{
+	ANSICHAR Digits[32];
+	switch (InField.Kind)
+	{
+	case EKind::Bool:
+		OutArgs.Add(((const FBoolProperty*)InField.Property)->GetPropertyValue(InData) ? "1" : "0");
+		break;
+	case EKind::Int:
+		OutArgs.Add(((const FNumericProperty*)InField.ValueProperty)->GetSignedIntPropertyValue(InData));
+		break;
+	case EKind::UInt:
+		OutArgs.AddRaw(Digits, FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%llu", (unsigned long long)((const FNumericProperty*)InField.ValueProperty)->GetUnsignedIntPropertyValue(InData)));
+		break;
+	case EKind::Float:
+		// Enough digits to read back the same float, without the noise of printing it as a double
+		OutArgs.AddRaw(Digits, FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%.9g", *(const float*)InData));
+		break;
+	case EKind::Double:
+		OutArgs.Add(((const FNumericProperty*)InField.ValueProperty)->GetFloatingPointPropertyValue(InData));
+		break;
+	case EKind::String:
+		OutArgs.Add(*(const FString*)InData);
+		break;
+	case EKind::Name:
+		OutArgs.Add(((const FName*)InData)->ToString());
+		break;
+	case EKind::Enum:
+		// By name, so reordering the enum does not change what is stored
+		OutArgs.Add(InField.Enum->GetNameStringByValue(((const FNumericProperty*)InField.ValueProperty)->GetSignedIntPropertyValue(InData)));
+		break;
+	default:
+	{
+		FString Text;
+		InField.Property->ExportTextItem(Text, InData, nullptr, nullptr, PPF_None);
+		OutArgs.Add(Text);
+		break;
+	}
+	}
+}
+
+void FRedisStructLayout::DecodeValue(const FHashField& InField, const ANSICHAR* InStr, int32 InLen, void* OutData) const
+{
+	// hiredis terminates every string, so the numeric parsers can read it in place
+	switch (InField.Kind)
+	{
+	case EKind::Bool:
+		((const FBoolProperty*)InField.Property)->SetPropertyValue(OutData, InLen > 0 && (InStr[0] == '1' || InStr[0] == 't' || InStr[0] == 'T'));
+		break;
+	case EKind::Int:
+		((const FNumericProperty*)InField.ValueProperty)->SetIntPropertyValue(OutData, (int64)FCStringAnsi::Strtoi64(InStr, nullptr, 10));
+		break;
+	case EKind::UInt:
+		((const FNumericProperty*)InField.ValueProperty)->SetIntPropertyValue(OutData, (uint64)FCStringAnsi::Strtoui64(InStr, nullptr, 10));
+		break;
+	case EKind::Float:
+	case EKind::Double:
+		((const FNumericProperty*)InField.ValueProperty)->SetFloatingPointPropertyValue(OutData, FCStringAnsi::Atod(InStr));
+		break;
+	case EKind::String:
+		*(FString*)OutData = FRedisReplyParser::ToString(InStr, InLen);
+		break;
+	case EKind::Name:
+		*(FName*)OutData = FName(*FRedisReplyParser::ToString(InStr, InLen));
+		break;
+	case EKind::Enum:
+	{
+		int64 Value = InField.Enum->GetValueByNameString(FRedisReplyParser::ToString(InStr, InLen));
+		if (Value == INDEX_NONE)
+		{
+			Value = FCStringAnsi::Strtoi64(InStr, nullptr, 10);
+		}
+		((const FNumericProperty*)InField.ValueProperty)->SetIntPropertyValue(OutData, Value);
+		break;
+	}
+	default:
+		InField.Property->ImportText(*FRedisReplyParser::ToString(InStr, InLen), OutData, PPF_None, nullptr);
+		break;
+	}
+}
@@ -0,0 +1,92 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UScriptStruct;
+class FField;
+class FProperty;
+class UEnum;
+class FRedisCommandArgs;
+struct redisReply;
+
+/**
+ * How the properties of one UScriptStruct map to the fields of a Redis hash, worked out once
+ * and shared by every save and load of that struct. Each property (each element of a static
+ * array) is one field named after it; transient properties are left out. Numbers, bools,
+ * strings, names and enums are converted directly, anything else goes through export/import text.
+ */
+class FRedisStructLayout
+{
+public:
+
+	/**
+	 * Built on first use and cached; safe from any thread. Rebuilt when InStruct is not the struct
+	 * it was built for any more (a freed struct's address reused) or its properties were recreated
+	 * (a recompiled UserDefinedStruct).
+	 */
+	static TSharedRef<const FRedisStructLayout, ESPMode::ThreadSafe> Get(const UScriptStruct* InStruct);
+
+	/** Drops every cached layout, e.g. after hot reload replaced struct objects. */
+	static void ClearCache();
+
+	/**
+	 * HSET of every field, or only of those that differ from InBaseline when given.
+	 * Returns the number of fields written; OutArgs is left untouched when that is 0.
+	 */
+	int32 BuildHSet(FRedisCommandArgs& OutArgs, const FString& InKey, const void* InData, const void* InBaseline) const;
+
+	/** HMGET of every field, in layout order. */
+	void BuildHMGet(FRedisCommandArgs& OutArgs, const FString& InKey) const;
+
+	/** Decodes an HMGET reply built by BuildHMGet straight into OutData; nil fields are left as they are. */
+	bool Decode(const redisReply* InReply, void* OutData) const;
+
+	int32 Num() const
+	{
+		return Fields.Num();
+	}
+
+private:
+	enum class EKind : uint8
+	{
+		Bool,
+		Int,
+		UInt,
+		Float,
+		Double,
+		String,
+		Name,
+		Enum,
+		Text,
+	};
+
+	struct FHashField
+	{
+		FProperty*			Property;
+		/** Of the numeric value for Int/UInt/Enum, of the element otherwise. */
+		FProperty*			ValueProperty;
+		UEnum*				Enum;
+		int32				Offset;
+		EKind				Kind;
+		/** UTF-8, ready to go on the wire. */
+		TArray<ANSICHAR>	Name;
+	};
+
+	explicit FRedisStructLayout(const UScriptStruct* InStruct);
+
+	bool IsBuiltFor(const UScriptStruct* InStruct) const;
+
+	void AddValue(FRedisCommandArgs& OutArgs, const FHashField& InField, const void* InData) const;
+
+	void DecodeValue(const FHashField& InField, const ANSICHAR* InStr, int32 InLen, void* OutData) const;
+
+private:
+	TArray<FHashField>		Fields;
+
+	/** What the layout was built from, to tell when it went stale. */
+	TWeakObjectPtr<const UScriptStruct>	Struct;
+	const FField*						ChildProperties;
+	int32								StructureSize;
+};
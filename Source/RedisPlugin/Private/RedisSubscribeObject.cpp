@@ -87,12 +87,10 @@ void URedisSubscribeObject::Unsubscribe()
 
 bool URedisSubscribeObject::Tick(float DeltaTime)
 {
-	if (!ReplyQueue.IsEmpty())
+	FString Channel;
+	FString Message;
+	while (ReplyQueue.Dequeue(Channel) && ReplyQueue.Dequeue(Message))
 	{
-		FString Channel;
-		FString Message;
-		ReplyQueue.Dequeue(Channel);
-		ReplyQueue.Dequeue(Message);
 		OnSubscribeReply.ExecuteIfBound(Channel, Message);
 	}
 	return true;
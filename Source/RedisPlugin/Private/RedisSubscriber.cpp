@@ -0,0 +1,449 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#include "RedisSubscriber.h"
+#include "RedisClient.h"
+#include "RedisCommandArgs.h"
+#include "RedisReplyParser.h"
+#include "RedisStats.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <winsock2.h>
+#endif
+
+#include "hiredis.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#define RedisPoll WSAPoll
+#else
+#include <poll.h>
+#define RedisPoll poll
+#endif
+
+/** Seconds to wait before reopening a dropped subscriber connection. */
+static const float RedisSubscriberReconnectDelay = 1.f;
+
+/** Upper bound on how long the thread blocks on the socket, so queued (un)subscriptions go out. */
+static const int32 RedisSubscriberPollTimeoutMs = 50;
+
+static bool RedisIsKind(const redisReply* InReply, const ANSICHAR* InKind)
+{
+	const int32 KindLen = FCStringAnsi::Strlen(InKind);
+	return (int32)InReply->len == KindLen && FCStringAnsi::Strncmp(InReply->str, InKind, KindLen) == 0;
+}
+
+FRedisSubscriber::FRedisSubscriber() :
+	Port(0),
+	ConnectTimeout(1.f),
+	Context(nullptr),
+	RepointPort(0),
+	Thread(nullptr)
+{
+	StopEvent = FPlatformProcess::GetSynchEventFromPool(true);
+}
+
+FRedisSubscriber::~FRedisSubscriber()
+{
+	Shutdown();
+	FPlatformProcess::ReturnSynchEventToPool(StopEvent);
+	StopEvent = nullptr;
+}
+
+bool FRedisSubscriber::Start(const FString& InHost, int32 InPort, const FString& InPassword, float InConnectTimeout)
+{
+	if (Thread)
+	{
+		return true;
+	}
+
+	Host = InHost;
+	Port = InPort;
+	Password = InPassword;
+	ConnectTimeout = InConnectTimeout;
+
+	bStopping = false;
+	StopEvent->Reset();
+	Thread = FRunnableThread::Create(this, TEXT("RedisSubscriber"), 0, TPri_Normal);
+	return Thread != nullptr;
+}
+
+void FRedisSubscriber::Shutdown()
+{
+	if (Thread)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FRedisSubscriber::Stop()
+{
+	bStopping = true;
+	StopEvent->Trigger();
+}
+
+void FRedisSubscriber::Subscribe(const FString& InChannel, bool bConflate, const FString& InKeyField)
+{
+	Enqueue(false, true, InChannel, bConflate, InKeyField);
+}
+
+void FRedisSubscriber::Unsubscribe(const FString& InChannel)
+{
+	Enqueue(false, false, InChannel);
+}
+
+void FRedisSubscriber::PSubscribe(const FString& InPattern, bool bConflate, const FString& InKeyField)
+{
+	Enqueue(true, true, InPattern, bConflate, InKeyField);
+}
+
+void FRedisSubscriber::PUnsubscribe(const FString& InPattern)
+{
+	Enqueue(true, false, InPattern);
+}
+
+void FRedisSubscriber::Enqueue(bool bPattern, bool bSubscribe, const FString& InName, bool bConflate, const FString& InKeyField)
+{
+	PendingSubscriptions.Enqueue({ bPattern, bSubscribe, bConflate, InName, InKeyField });
+	// Cuts short a reconnect wait so the first subscription connects right away
+	StopEvent->Trigger();
+}
+
+void FRedisSubscriber::Repoint(const FString& InHost, int32 InPort)
+{
+	{
+		FScopeLock ScopeLock(&RepointLock);
+		RepointHost = InHost;
+		RepointPort = InPort;
+	}
+	bRepointPending = true;
+}
+
+uint32 FRedisSubscriber::Run()
+{
+	while (!bStopping)
+	{
+		if (bRepointPending.AtomicSet(false))
+		{
+			FScopeLock ScopeLock(&RepointLock);
+			Host = RepointHost;
+			Port = RepointPort;
+			Disconnect();
+		}
+
+		if (!Context && (Channels.Num() || Patterns.Num() || !PendingSubscriptions.IsEmpty()))
+		{
+			if (!Connect())
+			{
+				StopEvent->Wait(FMath::RoundToInt(RedisSubscriberReconnectDelay * 1000.f));
+				StopEvent->Reset();
+				// Still track (un)subscriptions made while disconnected
+				ApplySubscriptions();
+				continue;
+			}
+		}
+
+		ApplySubscriptions();
+
+		if (!Context)
+		{
+			// Nothing to listen to yet
+			StopEvent->Wait(RedisSubscriberPollTimeoutMs);
+			StopEvent->Reset();
+			continue;
+		}
+
+		if (!Pump())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Redis subscriber connection lost, reconnecting"));
+			Disconnect();
+		}
+	}
+
+	Disconnect();
+	return 0;
+}
+
+bool FRedisSubscriber::Connect()
+{
+	Context = URedisClient::ConnectContext(Host, Port, ConnectTimeout);
+	if (!Context || Context->err)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Redis subscriber connect failed. error = %d"), Context ? Context->err : 0);
+		Disconnect();
+		return false;
+	}
+
+	if (!Password.IsEmpty())
+	{
+		FRedisCommandArgs Args;
+		Args.Add("AUTH").Add(Password);
+		redisReply* Reply = (redisReply*)redisCommandArgv(Context, Args.Num(), Args.GetArgv(), Args.GetArgvLen());
+		const bool bAuthed = Reply && Reply->type != REDIS_REPLY_ERROR;
+		if (Reply)
+		{
+			freeReplyObject(Reply);
+		}
+		if (!bAuthed)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Redis subscriber AUTH failed"));
+			Disconnect();
+			return false;
+		}
+	}
+
+	// Everything subscribed before the connection dropped
+	AppendCommand("SUBSCRIBE", Channels);
+	AppendCommand("PSUBSCRIBE", Patterns);
+	return true;
+}
+
+void FRedisSubscriber::Disconnect()
+{
+	if (Context)
+	{
+		redisFree(Context);
+		Context = nullptr;
+	}
+}
+
+void FRedisSubscriber::ApplySubscriptions()
+{
+	TSet<FString> Changed[2][2];
+	FSubscription Subscription;
+	while (PendingSubscriptions.Dequeue(Subscription))
+	{
+		TSet<FString>& Names = Subscription.bPattern ? Patterns : Channels;
+		TMap<FString, FString>& Conflated = Subscription.bPattern ? ConflatedPatterns : ConflatedChannels;
+		if (Subscription.bSubscribe && Subscription.bConflate)
+		{
+			Conflated.Add(Subscription.Name, Subscription.KeyField);
+		}
+		else
+		{
+			Conflated.Remove(Subscription.Name);
+		}
+
+		bool bChanged = false;
+		if (Subscription.bSubscribe)
+		{
+			bool bAlreadySet = false;
+			Names.Add(Subscription.Name, &bAlreadySet);
+			bChanged = !bAlreadySet;
+		}
+		else
+		{
+			bChanged = Names.Remove(Subscription.Name) > 0;
+		}
+		if (bChanged)
+		{
+			Changed[Subscription.bPattern][Subscription.bSubscribe].Add(Subscription.Name);
+			Changed[Subscription.bPattern][!Subscription.bSubscribe].Remove(Subscription.Name);
+		}
+	}
+
+	if (Context)
+	{
+		AppendCommand("SUBSCRIBE", Changed[0][1]);
+		AppendCommand("UNSUBSCRIBE", Changed[0][0]);
+		AppendCommand("PSUBSCRIBE", Changed[1][1]);
+		AppendCommand("PUNSUBSCRIBE", Changed[1][0]);
+	}
+}
+
+void FRedisSubscriber::AppendCommand(const ANSICHAR* InCommand, const TSet<FString>& InNames)
+{
+	if (InNames.Num() == 0)
+	{
+		return;
+	}
+
+	FRedisCommandArgs Args;
+	Args.Add(InCommand);
+	for (const FString& it : InNames)
+	{
+		Args.Add(it);
+	}
+	redisAppendCommandArgv(Context, Args.Num(), Args.GetArgv(), Args.GetArgvLen());
+}
+
+bool FRedisSubscriber::Pump()
+{
+	int Done = 0;
+	while (!Done)
+	{
+		if (redisBufferWrite(Context, &Done) != REDIS_OK)
+		{
+			return false;
+		}
+	}
+
+	// Drain what the reader already holds before going back to the socket
+	for (;;)
+	{
+		redisReply* Reply = nullptr;
+		if (redisGetReplyFromReader(Context, (void**)&Reply) != REDIS_OK)
+		{
+			return false;
+		}
+		if (!Reply)
+		{
+			break;
+		}
+		HandleReply(Reply);
+		freeReplyObject(Reply);
+	}
+
+	pollfd Fd;
+	Fd.fd = Context->fd;
+	Fd.events = POLLIN;
+	Fd.revents = 0;
+	const int32 Ready = RedisPoll(&Fd, 1, RedisSubscriberPollTimeoutMs);
+	if (Ready < 0)
+	{
+		return false;
+	}
+	return Ready == 0 || redisBufferRead(Context) == REDIS_OK;
+}
+
+bool FRedisSubscriber::PopMessage(FRedisPubSubMessage& OutMessage)
+{
+	if (!Messages.Dequeue(OutMessage))
+	{
+		return false;
+	}
+	Backlog.Decrement();
+
+	if (!OutMessage.ConflationKey.IsEmpty())
+	{
+		// The placeholder keeps the first arrival time; the content is whatever came last
+		const double FirstReceiveTime = OutMessage.ReceiveTime;
+		FScopeLock ScopeLock(&ConflationLock);
+		Latest.RemoveAndCopyValue(OutMessage.ConflationKey, OutMessage);
+		OutMessage.ReceiveTime = FirstReceiveTime;
+	}
+	return true;
+}
+
+void FRedisSubscriber::PushMessage(FRedisPubSubMessage&& InMessage, const FString* InKeyField)
+{
+	InMessage.ReceiveTime = FPlatformTime::Seconds();
+	if (!InKeyField)
+	{
+		Backlog.Increment();
+		Messages.Enqueue(MoveTemp(InMessage));
+		return;
+	}
+
+	// Per channel, also under a pattern: one pattern usually matches many channels
+	FString ConflationKey = InMessage.Pattern.IsEmpty() ? FString(TEXT("c:")) : TEXT("p:") + InMessage.Pattern + TEXT("\n");
+	ConflationKey += InMessage.Channel;
+	if (!InKeyField->IsEmpty())
+	{
+		ConflationKey += TEXT("\n");
+		ConflationKey += ExtractJsonField(InMessage.Message, *InKeyField);
+	}
+
+	FRedisPubSubMessage Placeholder;
+	{
+		FScopeLock ScopeLock(&ConflationLock);
+		if (FRedisPubSubMessage* Waiting = Latest.Find(ConflationKey))
+		{
+			*Waiting = MoveTemp(InMessage);
+			INC_DWORD_STAT(STAT_RedisPubSubConflated);
+			return;
+		}
+		Latest.Add(ConflationKey, MoveTemp(InMessage));
+	}
+
+	Placeholder.ReceiveTime = FPlatformTime::Seconds();
+	Placeholder.ConflationKey = MoveTemp(ConflationKey);
+	Backlog.Increment();
+	Messages.Enqueue(MoveTemp(Placeholder));
+}
+
+FString FRedisSubscriber::ExtractJsonField(const FString& InJson, const FString& InField)
+{
+	const FString Needle = TEXT("\"") + InField + TEXT("\"");
+	int32 Pos = InJson.Find(Needle, ESearchCase::CaseSensitive);
+	if (Pos == INDEX_NONE)
+	{
+		return FString();
+	}
+
+	const TCHAR* Cursor = *InJson + Pos + Needle.Len();
+	while (FChar::IsWhitespace(*Cursor))
+	{
+		++Cursor;
+	}
+	if (*Cursor != TEXT(':'))
+	{
+		return FString();
+	}
+	++Cursor;
+	while (FChar::IsWhitespace(*Cursor))
+	{
+		++Cursor;
+	}
+
+	const TCHAR* Start = Cursor;
+	if (*Cursor == TEXT('"'))
+	{
+		for (++Cursor; *Cursor && *Cursor != TEXT('"'); ++Cursor)
+		{
+			if (*Cursor == TEXT('\\') && Cursor[1])
+			{
+				++Cursor;
+			}
+		}
+		return FString(Cursor - Start - 1, Start + 1);
+	}
+	while (*Cursor && *Cursor != TEXT(',') && *Cursor != TEXT('}') && !FChar::IsWhitespace(*Cursor))
+	{
+		++Cursor;
+	}
+	return FString(Cursor - Start, Start);
+}
+
+double FRedisSubscriber::GetOldestAge() const
+{
+	// TQueue::Peek is not const, but peeking is safe from the single consumer
+	const FRedisPubSubMessage* Oldest = const_cast<TQueue<FRedisPubSubMessage, EQueueMode::Spsc>&>(Messages).Peek();
+	return Oldest ? FPlatformTime::Seconds() - Oldest->ReceiveTime : 0.0;
+}
+
+void FRedisSubscriber::HandleReply(const redisReply* InReply)
+{
+	if (InReply->type != REDIS_REPLY_ARRAY || InReply->elements < 3 || InReply->element[0]->type != REDIS_REPLY_STRING)
+	{
+		return;
+	}
+
+	// ["message", channel, payload] or ["pmessage", pattern, channel, payload]; (un)subscribe confirmations are skipped
+	const redisReply* const* Elements = InReply->element;
+	if (RedisIsKind(Elements[0], "message") && InReply->elements == 3)
+	{
+		FRedisPubSubMessage Message;
+		Message.Channel = FRedisReplyParser::ToString(Elements[1]->str, Elements[1]->len);
+		Message.Message = FRedisReplyParser::ToString(Elements[2]->str, Elements[2]->len);
+		const FString* KeyField = ConflatedChannels.Find(Message.Channel);
+		PushMessage(MoveTemp(Message), KeyField);
+	}
+	else if (RedisIsKind(Elements[0], "pmessage") && InReply->elements == 4)
+	{
+		FRedisPubSubMessage Message;
+		Message.Pattern = FRedisReplyParser::ToString(Elements[1]->str, Elements[1]->len);
+		Message.Channel = FRedisReplyParser::ToString(Elements[2]->str, Elements[2]->len);
+		Message.Message = FRedisReplyParser::ToString(Elements[3]->str, Elements[3]->len);
+		const FString* KeyField = ConflatedPatterns.Find(Message.Pattern);
+		PushMessage(MoveTemp(Message), KeyField);
+	}
+}
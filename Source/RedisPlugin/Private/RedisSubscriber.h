@@ -0,0 +1,147 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/Queue.h"
+
+class FRunnableThread;
+class FEvent;
+struct redisContext;
+struct redisReply;
+
+/** One message read from the subscriber connection. Pattern is set for PSUBSCRIBE matches. */
+struct FRedisPubSubMessage
+{
+	FRedisPubSubMessage() :
+		ReceiveTime(0.0)
+	{	}
+
+	FString		Pattern;
+	FString		Channel;
+	FString		Message;
+	/** FPlatformTime::Seconds() when the subscriber thread read it. */
+	double		ReceiveTime;
+	/** Set on the queued placeholder of a conflated message; the newest value is looked up by it. */
+	FString		ConflationKey;
+};
+
+/**
+ * One subscriber connection shared by every channel and pattern of a URedisObject.
+ * SUBSCRIBE/UNSUBSCRIBE/PSUBSCRIBE/PUNSUBSCRIBE are queued from any thread and written by a
+ * single background thread, which also reads the messages and queues them for the game thread.
+ * The connection is only opened once there is something to listen to, and every channel and
+ * pattern is subscribed again after a reconnect.
+ *
+ * Conflated subscriptions keep at most one undelivered message per channel (or per value of a
+ * JSON field of the payload): a newer message overwrites the waiting one in place, so a burst
+ * of snapshots costs one handler call and one buffered message.
+ */
+class FRedisSubscriber : public FRunnable
+{
+public:
+
+	FRedisSubscriber();
+	virtual ~FRedisSubscriber();
+
+	/** InConnectTimeout bounds every connect, including the reconnects after a Repoint. */
+	bool Start(const FString& InHost, int32 InPort, const FString& InPassword, float InConnectTimeout = 1.f);
+
+	void Shutdown();
+
+	/** InKeyField only applies with bConflate: the top-level JSON field messages are told apart by. */
+	void Subscribe(const FString& InChannel, bool bConflate = false, const FString& InKeyField = FString());
+
+	void Unsubscribe(const FString& InChannel);
+
+	void PSubscribe(const FString& InPattern, bool bConflate = false, const FString& InKeyField = FString());
+
+	void PUnsubscribe(const FString& InPattern);
+
+	/** Reconnects to a new server (e.g. after a failover) and subscribes everything again. */
+	void Repoint(const FString& InHost, int32 InPort);
+
+	/** Game thread: next message received, in arrival order; a conflated one comes at its first arrival slot. */
+	bool PopMessage(FRedisPubSubMessage& OutMessage);
+
+	/** Messages read but not popped yet. */
+	int32 GetBacklog() const
+	{
+		return Backlog.GetValue();
+	}
+
+	/** Game thread: seconds the next message to pop has been waiting, 0 when there is none. */
+	double GetOldestAge() const;
+
+	/* FRunnable */
+	virtual uint32 Run() override;
+
+	virtual void Stop() override;
+
+private:
+	struct FSubscription
+	{
+		bool		bPattern;
+		bool		bSubscribe;
+		bool		bConflate;
+		FString		Name;
+		FString		KeyField;
+	};
+
+	void Enqueue(bool bPattern, bool bSubscribe, const FString& InName, bool bConflate = false, const FString& InKeyField = FString());
+
+	/** Queues InMessage, or overwrites the waiting message with the same conflation key. */
+	void PushMessage(FRedisPubSubMessage&& InMessage, const FString* InKeyField);
+
+	/** Raw value of a top-level "InField": ... of a JSON object; empty if absent. */
+	static FString ExtractJsonField(const FString& InJson, const FString& InField);
+
+	bool Connect();
+
+	void Disconnect();
+
+	/** Applies queued changes to the subscription sets and writes them if connected. */
+	void ApplySubscriptions();
+
+	void AppendCommand(const ANSICHAR* InCommand, const TSet<FString>& InNames);
+
+	/** Writes pending commands and reads whatever arrived, waiting up to one poll interval. */
+	bool Pump();
+
+	void HandleReply(const redisReply* InReply);
+
+private:
+	FString		Host;
+	int32		Port;
+	FString		Password;
+	float		ConnectTimeout;
+
+	/** Subscriber thread only. */
+	TSet<FString>	Channels;
+	TSet<FString>	Patterns;
+	/** Conflated subscriptions and their key field. */
+	TMap<FString, FString>	ConflatedChannels;
+	TMap<FString, FString>	ConflatedPatterns;
+	redisContext*	Context;
+
+	TQueue<FSubscription, EQueueMode::Mpsc>			PendingSubscriptions;
+	TQueue<FRedisPubSubMessage, EQueueMode::Spsc>	Messages;
+	FThreadSafeCounter								Backlog;
+
+	/** Newest undelivered message per conflation key. */
+	FCriticalSection						ConflationLock;
+	TMap<FString, FRedisPubSubMessage>		Latest;
+
+	FCriticalSection	RepointLock;
+	FString				RepointHost;
+	int32				RepointPort;
+	FThreadSafeBool		bRepointPending;
+
+	FRunnableThread*	Thread;
+	FThreadSafeBool		bStopping;
+	/** Interrupts the wait between reconnect attempts. */
+	FEvent*				StopEvent;
+};
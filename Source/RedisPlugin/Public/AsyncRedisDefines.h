@@ -6,7 +6,7 @@
 #include "UObject/ObjectMacros.h"
 #include "AsyncRedisDefines.generated.h"
 
-class URedisClient;
+class FRedisScanIterator;
 
 USTRUCT(BlueprintType)
 struct FWrapMap
@@ -26,6 +26,266 @@ struct FWrapArray
 	TArray<FString> RealArray;
 };
 
+/** One binary value, as Blueprint cannot hold an array of arrays. */
+USTRUCT(BlueprintType)
+struct FRedisBytes
+{
+	GENERATED_BODY()
+
+	/** False for a missing key. */
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	bool bFound = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	TArray<uint8> Bytes;
+};
+
+/** Latency distribution of one command type, in milliseconds. */
+USTRUCT(BlueprintType)
+struct FRedisLatencyPercentiles
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	int64 Count = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	float P50 = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	float P90 = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	float P99 = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	float P999 = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	float Max = 0.f;
+};
+
+USTRUCT(BlueprintType)
+struct FRedisCommandLatency
+{
+	GENERATED_BODY()
+
+	/** Upper case command name, e.g. HGET. */
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	FString Command;
+
+	/** Waiting on the client side: for a pooled connection, or in the async engine's queue. */
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	FRedisLatencyPercentiles Queue;
+
+	/** From writing the command to reading its reply. */
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	FRedisLatencyPercentiles RoundTrip;
+};
+
+UENUM(BlueprintType)
+enum class ERedisReplyType : uint8
+{
+	Nil,
+	Status,
+	Error,
+	Integer,
+	String,
+	Array,
+};
+
+/** Typed reply of a single command. Nested arrays are flattened into Elements. */
+USTRUCT(BlueprintType)
+struct FRedisReply
+{
+	GENERATED_BODY()
+
+	FRedisReply() :
+		Type(ERedisReplyType::Nil), Integer(0)
+	{	}
+
+	bool IsError() const
+	{
+		return Type == ERedisReplyType::Error;
+	}
+
+	bool IsNil() const
+	{
+		return Type == ERedisReplyType::Nil;
+	}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	ERedisReplyType Type;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	int64 Integer;
+
+	/** Payload of String, Status and Error replies. */
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	FString Str;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	TArray<FString> Elements;
+};
+
+USTRUCT(BlueprintType)
+struct FRedisScoredMember
+{
+	GENERATED_BODY()
+
+	FRedisScoredMember() :
+		Score(0.0)
+	{	}
+
+	FRedisScoredMember(const FString& InMember, double InScore) :
+		Member(InMember), Score(InScore)
+	{	}
+
+	UPROPERTY(BlueprintReadWrite, Category = "Redis")
+	FString Member;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Redis")
+	double Score;
+};
+
+USTRUCT(BlueprintType)
+struct FWrapScoredArray
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	TArray<FRedisScoredMember> RealArray;
+};
+
+/** One stream entry; the fields of an entry deleted while still pending come back empty. */
+USTRUCT(BlueprintType)
+struct FRedisStreamEntry
+{
+	GENERATED_BODY()
+
+	/** Left empty for XADD to let the server assign one. */
+	UPROPERTY(BlueprintReadWrite, Category = "Redis")
+	FString Id;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Redis")
+	TMap<FString, FString> Fields;
+};
+
+USTRUCT(BlueprintType)
+struct FWrapStreamEntries
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Redis")
+	TArray<FRedisStreamEntry> RealArray;
+};
+
+/** What a stream consumer reads and how; see URedisObject::StartStreamConsumer. */
+USTRUCT(BlueprintType)
+struct FRedisStreamConsumerSettings
+{
+	GENERATED_BODY()
+
+	/** Read together on one connection; in cluster and sharded mode they must share a {hashtag}. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	TArray<FString> Streams;
+
+	/** Created at the end of every stream that does not have it yet. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	FString Group;
+
+	/** Empty for "<computer>-<pid>". Keep it stable across restarts to pick up its own pending entries. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	FString Consumer;
+
+	/** Entries per XREADGROUP, so the largest batch handed over at once. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	int32 Count = 100;
+
+	/** Milliseconds one XREADGROUP waits for new entries; stopping takes up to as long. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	int32 BlockMs = 2000;
+
+	/** Acknowledge each batch with one XACK once the handler returned, instead of calling XAck yourself. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	bool bAckAfterHandler = false;
+
+	/** Entries pending this long with any consumer of the group are claimed with XAUTOCLAIM; 0 never claims. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	int32 ClaimMinIdleMs = 60000;
+
+	/** Seconds between two XAUTOCLAIM sweeps. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	float ClaimInterval = 30.f;
+};
+
+UENUM(BlueprintType)
+enum class ERedisListEnd : uint8
+{
+	Left,
+	Right,
+};
+
+/** What a list consumer pops and how; see URedisObject::StartListConsumer. */
+USTRUCT(BlueprintType)
+struct FRedisListConsumerSettings
+{
+	GENERATED_BODY()
+
+	/** Served in order: each pop takes from the first non-empty one. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	TArray<FString> Keys;
+
+	/** Right for a queue filled with LPush. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	ERedisListEnd PopFrom = ERedisListEnd::Right;
+
+	/** Seconds one blocking pop waits before it is sent again; stopping takes up to as long. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	float Timeout = 5.f;
+
+	/**
+	 * Reliable queue: each job is moved here with BLMOVE (from the first key only) and stays
+	 * until AckJob, so a crash cannot lose it. Jobs left over from a previous run are handed
+	 * out again on start. Must share a {hashtag} with the key in cluster mode. Needs Redis 6.2.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	FString ProcessingList;
+
+	/** Reliable queue: AckJob as soon as the handler returned. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis")
+	bool bAckAfterHandler = false;
+};
+
+/** Codec of a compressed value. Recorded in the value's header, so existing entries must keep their number. */
+UENUM(BlueprintType)
+enum class ERedisCompression : uint8
+{
+	None,
+	LZ4,
+	Zlib,
+	Gzip,
+	/** Only where the engine ships Oodle; values are written uncompressed otherwise. */
+	Oodle,
+	/** Hash field values, against a trained dictionary; see URedisObject::CompressionDictionaryKey. Not a codec for Compression. */
+	ZlibDictionary,
+};
+
+/** ZADD update condition. GT/LT need Redis 6.2 or later. */
+UENUM(BlueprintType)
+enum class ERedisZAddFlag : uint8
+{
+	None,
+	/** Only add new members. */
+	NX,
+	/** Only update existing members. */
+	XX,
+	/** Only update when the new score is greater. */
+	GT,
+	/** Only update when the new score is less. */
+	LT,
+};
+
 /*  */
 DECLARE_DYNAMIC_DELEGATE_OneParam(FExistsKeyFinished, bool, bResult);
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FMGetFinished, bool, bResult, FWrapArray, OutMemberList);
@@ -35,8 +295,14 @@ DECLARE_DYNAMIC_DELEGATE_TwoParams(FHGetFinished, bool, bResult, FString, OutVal
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FHMGetFinished, bool, bResult, FWrapMap, OutMemberMap);
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FHGetAllFinished, bool, bResult, FWrapMap, OutMemberMap);
 DECLARE_DYNAMIC_DELEGATE_TwoParams(FSMembersFinished, bool, bResult, FWrapArray, OutMemberList);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FZRangeFinished, bool, bResult, FWrapScoredArray, OutMemberList);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FZScoreFinished, bool, bResult, double, OutScore);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FEvalScriptFinished, bool, bResult, FRedisReply, OutReply);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FStreamEntriesReceived, FString, Stream, FWrapStreamEntries, Entries);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FListJobReceived, FString, Key, FString, Job);
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FRedisNoReturnFinished, bool);
+DECLARE_DELEGATE_TwoParams(FPipelineFinished, bool, const TArray<FRedisReply>&);
 
 USTRUCT()
 struct FAsyncResultNoReturn
@@ -44,19 +310,17 @@ struct FAsyncResultNoReturn
 	GENERATED_BODY()
 
 	FAsyncResultNoReturn() :
-		bResult(false), AsyncRedisClient(nullptr)
+		bResult(false)
 	{	}
 
 	void Reset()
 	{
 		bResult = false;
 		NoReturnCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	FRedisNoReturnFinished NoReturnCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -65,19 +329,17 @@ struct FAsyncResultExistsKey
 	GENERATED_BODY()
 
 		FAsyncResultExistsKey() :
-		bResult(false), AsyncRedisClient(nullptr)
+		bResult(false)
 	{	}
 
 	void Reset()
 	{
 		bResult = false;
 		ExistsKeyCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	FExistsKeyFinished ExistsKeyCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -86,7 +348,7 @@ struct FAsyncResultMGet
 	GENERATED_BODY()
 
 		FAsyncResultMGet() :
-		bResult(false), AsyncRedisClient(nullptr)
+		bResult(false)
 	{	}
 
 	void Reset()
@@ -94,13 +356,11 @@ struct FAsyncResultMGet
 		bResult = false;
 		ResultMemberList.Reset();
 		MGetCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	TArray<FString> ResultMemberList;
 	FMGetFinished MGetCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -109,7 +369,7 @@ struct FAsyncResultGetInt
 	GENERATED_BODY()
 
 	FAsyncResultGetInt() :
-		bResult(false), ResultValue(0), AsyncRedisClient(nullptr)
+		bResult(false), ResultValue(0)
 	{	}
 
 	void Reset()
@@ -117,13 +377,11 @@ struct FAsyncResultGetInt
 		bResult = false;
 		ResultValue = 0;
 		GetIntCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	int32 ResultValue;
 	FGetIntFinished GetIntCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -132,7 +390,7 @@ struct FAsyncResultGetStr
 	GENERATED_BODY()
 
 	FAsyncResultGetStr() :
-		bResult(false), ResultValue(TEXT("")), AsyncRedisClient(nullptr)
+		bResult(false), ResultValue(TEXT(""))
 	{	}
 
 	void Reset()
@@ -140,13 +398,11 @@ struct FAsyncResultGetStr
 		bResult = false;
 		ResultValue = TEXT("");
 		GetStrCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	FString ResultValue;
 	FGetStrFinished GetStrCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -155,7 +411,7 @@ struct FAsyncResultHGet
 	GENERATED_BODY()
 
 	FAsyncResultHGet() :
-		bResult(false), ResultValue(TEXT("")), AsyncRedisClient(nullptr)
+		bResult(false), ResultValue(TEXT(""))
 	{	}
 
 	void Reset()
@@ -163,13 +419,11 @@ struct FAsyncResultHGet
 		bResult = false;
 		ResultValue = TEXT("");
 		HGetCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	FString ResultValue;
 	FHGetFinished HGetCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -178,7 +432,7 @@ struct FAsyncResultHMGet
 	GENERATED_BODY()
 
 	FAsyncResultHMGet() :
-		bResult(false), AsyncRedisClient(nullptr)
+		bResult(false)
 	{	}
 
 	void Reset()
@@ -186,13 +440,11 @@ struct FAsyncResultHMGet
 		bResult = false;
 		ResultFieldValueMap.Reset();
 		HMGetCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	TMap<FString, FString> ResultFieldValueMap;
 	FHMGetFinished HMGetCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -201,7 +453,7 @@ struct FAsyncResultHGetAll
 	GENERATED_BODY()
 
 	FAsyncResultHGetAll() :
-		bResult(false), AsyncRedisClient(nullptr)
+		bResult(false)
 	{	}
 
 	void Reset()
@@ -209,13 +461,11 @@ struct FAsyncResultHGetAll
 		bResult = false;
 		ResultFieldValueMap.Reset();
 		HGetAllCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	TMap<FString, FString> ResultFieldValueMap;
 	FHGetAllFinished HGetAllCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
 };
 
 USTRUCT()
@@ -224,7 +474,7 @@ struct FAsyncResultSMembers
 	GENERATED_BODY()
 
 	FAsyncResultSMembers() :
-		bResult(false), AsyncRedisClient(nullptr)
+		bResult(false)
 	{	}
 
 	void Reset()
@@ -232,13 +482,166 @@ struct FAsyncResultSMembers
 		bResult = false;
 		ResultMemberList.Reset();
 		SMembersCallback.Clear();
-		AsyncRedisClient = nullptr;
 	}
 
 	bool bResult;
 	TArray<FString> ResultMemberList;
 	FSMembersFinished SMembersCallback;
-	TSharedPtr<URedisClient> AsyncRedisClient;
+};
+
+USTRUCT()
+struct FAsyncResultPipeline
+{
+	GENERATED_BODY()
+
+	FAsyncResultPipeline() :
+		bResult(false)
+	{	}
+
+	void Reset()
+	{
+		bResult = false;
+		Replies.Reset();
+		PipelineCallback.Unbind();
+	}
+
+	bool bResult;
+	TArray<FRedisReply> Replies;
+	FPipelineFinished PipelineCallback;
+};
+
+USTRUCT()
+struct FAsyncResultZRange
+{
+	GENERATED_BODY()
+
+	FAsyncResultZRange() :
+		bResult(false)
+	{	}
+
+	void Reset()
+	{
+		bResult = false;
+		ResultMemberList.Reset();
+		ZRangeCallback.Clear();
+	}
+
+	bool bResult;
+	TArray<FRedisScoredMember> ResultMemberList;
+	FZRangeFinished ZRangeCallback;
+};
+
+USTRUCT()
+struct FAsyncResultZScore
+{
+	GENERATED_BODY()
+
+	FAsyncResultZScore() :
+		bResult(false), ResultScore(0.0)
+	{	}
+
+	void Reset()
+	{
+		bResult = false;
+		ResultScore = 0.0;
+		ZScoreCallback.Clear();
+	}
+
+	bool bResult;
+	double ResultScore;
+	FZScoreFinished ZScoreCallback;
+};
+
+USTRUCT()
+struct FAsyncResultScript
+{
+	GENERATED_BODY()
+
+	FAsyncResultScript() :
+		bResult(false)
+	{	}
+
+	void Reset()
+	{
+		bResult = false;
+		Reply = FRedisReply();
+		ScriptCallback.Clear();
+	}
+
+	bool bResult;
+	FRedisReply Reply;
+	FEvalScriptFinished ScriptCallback;
+};
+
+USTRUCT()
+struct FAsyncResultScan
+{
+	GENERATED_BODY()
+
+	FAsyncResultScan() :
+		bResult(false)
+	{	}
+
+	void Reset()
+	{
+		bResult = false;
+		Cursor.Reset();
+		Elements.Reset();
+		Iterator.Reset();
+	}
+
+	bool bResult;
+	FString Cursor;
+	TArray<FString> Elements;
+	TSharedPtr<FRedisScanIterator, ESPMode::ThreadSafe> Iterator;
+};
+
+/** One batch read by a stream consumer. */
+USTRUCT()
+struct FAsyncResultStream
+{
+	GENERATED_BODY()
+
+	FAsyncResultStream() :
+		bResult(false), ConsumerId(0)
+	{	}
+
+	void Reset()
+	{
+		bResult = false;
+		ConsumerId = 0;
+		Stream.Reset();
+		Entries.Reset();
+	}
+
+	bool bResult;
+	int32 ConsumerId;
+	FString Stream;
+	TArray<FRedisStreamEntry> Entries;
+};
+
+/** One job popped by a list consumer. */
+USTRUCT()
+struct FAsyncResultJob
+{
+	GENERATED_BODY()
+
+	FAsyncResultJob() :
+		bResult(false), ConsumerId(0)
+	{	}
+
+	void Reset()
+	{
+		bResult = false;
+		ConsumerId = 0;
+		Key.Reset();
+		Job.Reset();
+	}
+
+	bool bResult;
+	int32 ConsumerId;
+	FString Key;
+	FString Job;
 };
 
 /** In URedisObject */
@@ -269,6 +672,7 @@ private:																\
 																		\
 	Type* URedisObject::FindOrAdd##Name##Result()						\
 	{																	\
+		INC_DWORD_STAT(STAT_RedisPending##Name);						\
 		if (Name##Free##Results.Num())									\
 		{																\
 			return Name##Free##Results.Pop();							\
@@ -283,6 +687,7 @@ private:																\
 	{																	\
 		if (InResult != nullptr)										\
 		{																\
+			DEC_DWORD_STAT(STAT_RedisPending##Name);					\
 			InResult->Reset();											\
 			Name##Free##Results.Push(InResult);							\
 		}																\
@@ -295,15 +700,13 @@ private:																\
 
 
 #define POP_ASYNC_RESULT(Name, Pointer)									\
-	auto Pointer = FindOrAdd##Name##Result();							\
-	Pointer->AsyncRedisClient = FindOrNewRedisClient();					\
-	if (Pointer->AsyncRedisClient.Get() == nullptr)						\
+	/* Nothing would tick to deliver the result before Init */		\
+	if (!TickerHandle.IsValid())										\
 	{																	\
-		Recycle##Name##Result(Pointer);									\
 		return;															\
 	}																	\
+	auto Pointer = FindOrAdd##Name##Result();							\
 
 #define PUSH_ASYNC_RESULT(Name, Pointer)								\
-	RecycleRedisClient(Pointer->AsyncRedisClient);						\
 	Recycle##Name##Result(Pointer);										
 
@@ -0,0 +1,49 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RedisBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the plugin's hot paths and prints the results to the log:
+ *
+ *   -run=RedisBenchmark -Suite=<Name> [-Host=127.0.0.1] [-Port=6379] [-Password=] [-Iterations=]
+ *
+ * Args	[-Counts=1,10,1000]
+ *		No server needed. Microseconds and engine allocations per MGET of N keys built and formatted
+ *		through a reused FRedisCommandArgs, against the old std::ostringstream + TCHAR_TO_ANSI string.
+ *		hiredis allocates with malloc, so its own allocations are in the times but not the counts.
+ *
+ * Compression	[-Sizes=4096,65536,524288]
+ *		Per codec and value size: compression ratio, CPU time to compress and to decompress, and
+ *		SetStr + GetStr round trips through a URedisObject (left out when no server answers).
+ *
+ * Failover	-RedisServer=<path> [-BasePort=17000] [-Kill] [-MaxStallMs=]
+ *		Starts a primary, a replica and a sentinel on BasePort..BasePort+2, points a URedisObject at
+ *		the sentinel and fails the primary over (SENTINEL FAILOVER, or -Kill to terminate it) while
+ *		ticking it at 60Hz. Reports how long OnSwitchMaster took to repoint the pool, async engine
+ *		and subscriber, the time to the first write on the new primary, and the Tick durations;
+ *		fails when a Tick took longer than MaxStallMs.
+ *
+ * Transaction	[-Threads=8] [-MaxAttempts=100]
+ *		Threads increment one hash field at once, Iterations times each: first with plain HGET + HSET,
+ *		then in WATCH/MULTI/EXEC transactions. Throughput, latency percentiles, retries per increment,
+ *		transactions that gave up, and the updates lost against the expected count.
+ *
+ * Transport	[-Socket=/path/to/redis.sock] [-ValueSize=64] [-Batch=100]
+ *		SET, GET and HGETALL latency percentiles and pipelined SET + GET throughput over TCP to
+ *		Host:Port, then over the unix socket when given (not supported on Windows).
+ */
+UCLASS()
+class URedisBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	URedisBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
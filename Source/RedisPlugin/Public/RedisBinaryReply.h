@@ -0,0 +1,66 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct redisReply;
+
+/**
+ * Owns the reply of a binary read and exposes the value bytes where hiredis parsed them, so
+ * they are never copied. A GET/HGET holds one value at index 0, an MGET one per key.
+ * The views stay valid until the reply is reset, moved from or destroyed.
+ */
+class REDISPLUGIN_API FRedisBinaryReply
+{
+public:
+
+	FRedisBinaryReply() :
+		Reply(nullptr)
+	{	}
+
+	~FRedisBinaryReply()
+	{
+		Reset();
+	}
+
+	FRedisBinaryReply(FRedisBinaryReply&& Other) :
+		Reply(Other.Reply)
+	{
+		Other.Reply = nullptr;
+	}
+
+	FRedisBinaryReply& operator=(FRedisBinaryReply&& Other)
+	{
+		if (this != &Other)
+		{
+			Reset(Other.Reply);
+			Other.Reply = nullptr;
+		}
+		return *this;
+	}
+
+	/** Takes ownership of InReply, freeing the one held so far. */
+	void Reset(redisReply* InReply = nullptr);
+
+	int32 Num() const;
+
+	/** False for a missing key or field. */
+	bool IsValid(int32 Index = 0) const;
+
+	/** Empty for a missing key or field. */
+	TArrayView<const uint8> Get(int32 Index = 0) const;
+
+	TArrayView<const uint8> operator[](int32 Index) const
+	{
+		return Get(Index);
+	}
+
+private:
+	FRedisBinaryReply(const FRedisBinaryReply&) = delete;
+	FRedisBinaryReply& operator=(const FRedisBinaryReply&) = delete;
+
+	const redisReply* GetValue(int32 Index) const;
+
+	redisReply*		Reply;
+};
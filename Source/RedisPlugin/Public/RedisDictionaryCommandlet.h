@@ -0,0 +1,30 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RedisDictionaryCommandlet.generated.h"
+
+/**
+ * Trains a compression dictionary on hash field values sampled from a live server and stores
+ * it there, for URedisObject::CompressionDictionaryKey:
+ *
+ *   -run=RedisDictionary -Key=dict:player -Match=player:* [-Host=127.0.0.1] [-Port=6379] [-Password=]
+ *                        [-Samples=20000] [-Size=32506] [-Activate=true]
+ *
+ * The dictionary is added to the hash at Key under its id and, unless -Activate=false, made
+ * the current one. Running servers pick it up with LoadCompressionDictionaries; values written
+ * with older dictionaries stay readable as long as those are kept in the hash.
+ */
+UCLASS()
+class URedisDictionaryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	URedisDictionaryCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
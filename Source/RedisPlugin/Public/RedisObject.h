@@ -4,17 +4,55 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "HAL/CriticalSection.h"
 #include "Runtime/Core/Public/Containers/Queue.h"
 #include "Runtime/Core/Public/Containers/Ticker.h"
 #include "AsyncRedisDefines.h"
-#include "RedisSubscribeObject.h"
+#include "RedisPipeline.h"
+#include "RedisScanIterator.h"
+#include "RedisTransaction.h"
+#include "RedisBinaryReply.h"
 #include "RedisObject.generated.h"
 
 
 class URedisClient;
-class URedisSubscribeObject;
+class FRedisAsyncEngine;
+class FRedisConnectionPool;
+class FRedisCluster;
+class FRedisReplicaSet;
+class FRedisSentinel;
+class FRedisSubscriber;
+class FRedisBlockingConsumer;
+class FRedisStreamConsumer;
+class FRedisListConsumer;
+class FRedisTransaction;
+class FRedisCompressionDictionary;
+struct FRedisAsyncRequest;
+struct redisReply;
+
+/** How reads pick among ReplicaHosts. */
+UENUM(BlueprintType)
+enum class ERedisReplicaBalance : uint8
+{
+	RoundRobin,
+	/** The replica with the fewest requests in flight. */
+	LeastOutstanding,
+};
+
+/** How many pub/sub messages Tick hands to the handlers per frame. */
+UENUM(BlueprintType)
+enum class ERedisPubSubDrain : uint8
+{
+	/** Everything received so far. */
+	All,
+	/** Up to PubSubMaxMessagesPerTick. */
+	MaxMessages,
+	/** Until PubSubTickBudgetUs is spent; at least one message per tick. */
+	TimeBudget,
+};
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FSubscribeReply, FString, Channel, FString, Message);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FRedisMessageHandler, FString, Channel, FString, Message);
 
 
 /**
@@ -27,6 +65,7 @@ class REDISPLUGIN_API URedisObject : public UObject
 	
 public:
 
+	/** InHost may be unix:///path/to/redis.sock to reach a co-located server over a Unix domain socket. */
 	UFUNCTION(BlueprintCallable, Category = "Redis|Connect", meta = (DisplayName = "InitRedisConnection"))
 		virtual void Init(const FString& InHost, int32 InPort, const FString& InPassword);
 
@@ -41,11 +80,17 @@ public:
 
 	virtual bool ExecCommand(const FString& InCommand);
 
+	/** Send every queued command in one batch; OutReplies holds one reply per command, in queue order. */
+	virtual bool ExecPipeline(const FRedisPipeline& InPipeline, TArray<FRedisReply>& OutReplies);
+
+	/** Run a WATCH/MULTI/EXEC transaction on one pooled connection; OutReplies holds the EXEC results. */
+	virtual bool ExecTransaction(const FRedisTransaction& InTransaction, TArray<FRedisReply>& OutReplies);
+
 	UFUNCTION(BlueprintCallable, Category = "Redis|Key", meta = (DisplayName = "ExpireKey"))
 		virtual bool ExpireKey(const FString& InKey, int32 InSec);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Key", meta = (DisplayName = "ExistsKey"))
-		virtual bool ExistsKey(const FString& InKey);
+		virtual bool ExistsKey(const FString& InKey, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Key", meta = (DisplayName = "PersistKey"))
 		virtual bool PersistKey(const FString& InKey);
@@ -57,29 +102,80 @@ public:
 		virtual bool DelKey(const FString& InKey);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Key", meta = (DisplayName = "TypeKey"))
-		virtual bool TypeKey(const FString& InKey, FString& OutType);
+		virtual bool TypeKey(const FString& InKey, FString& OutType, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "MSet"))
 		virtual bool MSet(TMap<FString, FString>& InMemberMap);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "MGet"))
-		virtual bool MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList);
+		virtual bool MGet(const TArray<FString>& InKeyList, TArray<FString>& OutMemberList, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "SetInt"))
 		virtual bool SetInt(const FString& InKey, int32 InValue);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "GetInt"))
-		virtual bool GetInt(const FString& InKey, int32& OutValue);
+		virtual bool GetInt(const FString& InKey, int32& OutValue, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "SetStr"))
 		virtual bool SetStr(const FString& InKey, const FString& InValue);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "GetStr"))
-		virtual bool GetStr(const FString& InKey, FString& OutValue);
+		virtual bool GetStr(const FString& InKey, FString& OutValue, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "Append"))
 		virtual bool Append(const FString& InKey, const FString& InValue);
 
+	/** Stored byte for byte; for serialized structs, compressed blobs and other non-text values. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Binary", meta = (DisplayName = "SetBytes"))
+		virtual bool SetBytes(const FString& InKey, const TArray<uint8>& InValue);
+
+	/** False for a missing key. OutValue's allocation is reused. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Binary", meta = (DisplayName = "GetBytes"))
+		virtual bool GetBytes(const FString& InKey, TArray<uint8>& OutValue, bool bReadFromReplica = false);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|Binary", meta = (DisplayName = "HSetBytes"))
+		virtual bool HSetBytes(const FString& InKey, const FString& InField, const TArray<uint8>& InValue);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|Binary", meta = (DisplayName = "HGetBytes"))
+		virtual bool HGetBytes(const FString& InKey, const FString& InField, TArray<uint8>& OutValue, bool bReadFromReplica = false);
+
+	/** OutValues lines up with InKeyList, missing keys included. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Binary", meta = (DisplayName = "MGetBytes"))
+		virtual bool MGetBytes(const TArray<FString>& InKeyList, TArray<FRedisBytes>& OutValues, bool bReadFromReplica = false);
+
+	virtual bool SetBytesView(const FString& InKey, TArrayView<const uint8> InValue);
+
+	virtual bool HSetBytesView(const FString& InKey, const FString& InField, TArrayView<const uint8> InValue);
+
+	/** The value stays in the reply buffer, see FRedisBinaryReply. True with nothing in OutValue for a missing key. */
+	virtual bool GetBytesView(const FString& InKey, FRedisBinaryReply& OutValue, bool bReadFromReplica = false);
+
+	virtual bool HGetBytesView(const FString& InKey, const FString& InField, FRedisBinaryReply& OutValue, bool bReadFromReplica = false);
+
+	/** One MGET into a single reply, so in cluster and sharded mode the keys must share a {hashtag}. */
+	virtual bool MGetBytesView(const TArray<FString>& InKeyList, FRedisBinaryReply& OutValues, bool bReadFromReplica = false);
+
+	/**
+	 * One hash field per property of InStruct. With InBaseline, only the fields whose value
+	 * differs from it are written; nothing is sent when none do.
+	 */
+	virtual bool SaveStructToHash(const FString& InKey, const UScriptStruct* InStruct, const void* InData, const void* InBaseline = nullptr);
+
+	/** Fields missing from the hash leave their property untouched. */
+	virtual bool LoadStructFromHash(const FString& InKey, const UScriptStruct* InStruct, void* OutData, bool bReadFromReplica = false);
+
+	template<typename StructType>
+	bool SaveStructToHash(const FString& InKey, const StructType& InData, const StructType* InBaseline = nullptr)
+	{
+		return SaveStructToHash(InKey, StructType::StaticStruct(), &InData, InBaseline);
+	}
+
+	template<typename StructType>
+	bool LoadStructFromHash(const FString& InKey, StructType& OutData, bool bReadFromReplica = false)
+	{
+		return LoadStructFromHash(InKey, StructType::StaticStruct(), &OutData, bReadFromReplica);
+	}
+
 	UFUNCTION(BlueprintCallable, Category = "Redis|Set", meta = (DisplayName = "SAdd"))
 		virtual bool SAdd(const FString& InKey, const TArray<FString>& InMemberList);
 
@@ -90,13 +186,41 @@ public:
 		virtual bool SRem(const FString& InKey, const TArray<FString>& InMemberList);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Set", meta = (DisplayName = "SMembers"))
-		virtual bool SMembers(const FString& InKey, TArray<FString>& OutMemberList);
+		virtual bool SMembers(const FString& InKey, TArray<FString>& OutMemberList, bool bReadFromReplica = false);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZAdd"))
+		virtual bool ZAdd(const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag, int32& OutAdded);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZIncrby"))
+		virtual bool ZIncrby(const FString& InKey, const FString& InMember, double Incre, double& OutScore);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRange"))
+		virtual bool ZRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRevRange"))
+		virtual bool ZRevRange(const FString& InKey, int32 Start, int32 Stop, TArray<FRedisScoredMember>& OutMemberList);
+
+	/** Count <= 0 returns every member from Offset on. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRangeByScore"))
+		virtual bool ZRangeByScore(const FString& InKey, double Min, double Max, int32 Offset, int32 Count, TArray<FRedisScoredMember>& OutMemberList);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRank"))
+		virtual bool ZRank(const FString& InKey, const FString& InMember, int32& OutRank);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZScore"))
+		virtual bool ZScore(const FString& InKey, const FString& InMember, double& OutScore);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZMScore"))
+		virtual bool ZMScore(const FString& InKey, const TArray<FString>& InMemberList, TArray<FRedisScoredMember>& OutMemberList);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRem"))
+		virtual bool ZRem(const FString& InKey, const TArray<FString>& InMemberList);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HSet"))
 		virtual bool HSet(const FString& InKey, const FString& InField, const FString& InValue);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HGet"))
-		virtual bool HGet(const FString& InKey, const FString& InField, FString& OutValue);
+		virtual bool HGet(const FString& InKey, const FString& InField, FString& OutValue, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HMSet"))
 		virtual bool HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap);
@@ -108,10 +232,17 @@ public:
 		virtual bool HExists(const FString& InKey, const FString& Field);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HMGet"))
-		virtual bool HMGet(const FString& InKey, const TSet<FString>& InFieldList, TMap<FString, FString>& OutMemberMap);
+		virtual bool HMGet(const FString& InKey, const TSet<FString>& InFieldList, TMap<FString, FString>& OutMemberMap, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable,  Category = "Redis|Hash", meta = (DisplayName = "HGetAll"))
-		virtual bool HGetAll(const FString& InKey, TMap<FString, FString>& OutMemberMap);
+		virtual bool HGetAll(const FString& InKey, TMap<FString, FString>& OutMemberMap, bool bReadFromReplica = false);
+
+	/**
+	 * (Re)loads every dictionary stored at CompressionDictionaryKey and writes with the current
+	 * one from then on. Init calls it; call it again after training a new dictionary.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Compression", meta = (DisplayName = "LoadCompressionDictionaries"))
+		virtual bool LoadCompressionDictionaries();
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HIncrby"))
 		virtual bool HIncrby(const FString& Key, const FString& Field, int32 Value);
@@ -135,7 +266,7 @@ public:
 		virtual bool LPush(const FString& InKey, const TArray<FString>& InFieldList);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|List", meta = (DisplayName = "LRange"))
-		virtual bool LRange(const FString& InKey, int32 Start, int32 End, TArray<FString>& OutMemberList);
+		virtual bool LRange(const FString& InKey, int32 Start, int32 End, TArray<FString>& OutMemberList, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|List", meta = (DisplayName = "LRem"))
 		virtual bool LRem(const FString& InKey, const FString& InValue, int32 Count = 0);
@@ -152,10 +283,51 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Redis|List", meta = (DisplayName = "RPush"))
 		virtual bool RPush(const FString& InKey, const TArray<FString>& InFieldList);
 
+	/**
+	 * One XADD per entry, sent as one batch; InMaxLen > 0 trims the stream to about that many entries (MAXLEN ~).
+	 * OutIds[i] is the id of InEntries[i], or empty if that entry was not added.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Stream", meta = (DisplayName = "XAdd"))
+		virtual bool XAdd(const FString& InKey, const TArray<FRedisStreamEntry>& InEntries, int32 InMaxLen, TArray<FString>& OutIds);
+
+	/** Every id in one XACK. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Stream", meta = (DisplayName = "XAck"))
+		virtual bool XAck(const FString& InKey, const FString& InGroup, const TArray<FString>& InIds, int32& OutAcked);
+
+	/** Takes over entries pending for longer than InMinIdleMs; start InOutCursor at "0-0", done once it is "0-0" again. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Stream", meta = (DisplayName = "XAutoClaim"))
+		virtual bool XAutoClaim(const FString& InKey, const FString& InGroup, const FString& InConsumer, int32 InMinIdleMs, int32 InCount, FString& InOutCursor, TArray<FRedisStreamEntry>& OutEntries);
+
+	/**
+	 * Reads Settings.Streams as a consumer of Settings.Group on a connection of its own and hands
+	 * every batch to OnEntries from Tick. Returns the id for StopStreamConsumer, 0 if it could not start.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Stream")
+		virtual int32 StartStreamConsumer(const FRedisStreamConsumerSettings& Settings, FStreamEntriesReceived OnEntries);
+
+	/** Batches still on their way are dropped; their entries stay pending in the group. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Stream")
+		virtual void StopStreamConsumer(int32 ConsumerId);
+
+	/**
+	 * Pops jobs off Settings.Keys with a blocking pop on a connection of its own and hands each
+	 * one to OnJob from Tick. Returns the id for StopListConsumer, 0 if it could not start.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Redis|List")
+		virtual int32 StartListConsumer(const FRedisListConsumerSettings& Settings, FListJobReceived OnJob);
+
+	/** Jobs still on their way are dropped; in a reliable queue they stay in the processing list. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|List")
+		virtual void StopListConsumer(int32 ConsumerId);
+
+	/** Removes a finished job from the processing list of a reliable queue. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|List")
+		virtual bool AckJob(const FString& ProcessingList, const FString& Job);
+
 	/* Async redis operations. (Non-blocking call to the Redis command) */
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Key", meta = (DisplayName = "ExistsKey-Async"))
-		virtual void AsyncExistsKey(const FString& InKey, FExistsKeyFinished OnFinished);
+		virtual void AsyncExistsKey(const FString& InKey, FExistsKeyFinished OnFinished, bool bReadFromReplica = false);
 
 //	UFUNCTION(BlueprintCallable, Category = "Redis|Key", meta = (DisplayName = "ExpireKey-Async"))
 		virtual void AsyncExpireKey(const FString& InKey, int32 InSec);
@@ -164,19 +336,19 @@ public:
 		virtual void AsyncDelKey(const FString& InKey);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "MGet-Async"))
-		virtual void AsyncMGet(const TArray<FString>& InKeyList, FMGetFinished OnFinished);
+		virtual void AsyncMGet(const TArray<FString>& InKeyList, FMGetFinished OnFinished, bool bReadFromReplica = false);
 
 //	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "SetInt-Async"))
 		virtual void AsyncSetInt(const FString& InKey, int32 InValue);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "GetInt-Async"))
-		virtual void AsyncGetInt(const FString& InKey, FGetIntFinished OnFinished);
+		virtual void AsyncGetInt(const FString& InKey, FGetIntFinished OnFinished, bool bReadFromReplica = false);
 
 //	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "SetStr-Async"))
 		virtual void AsyncSetStr(const FString& InKey, const FString& InValue);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|String", meta = (DisplayName = "GetStr-Async"))
-		virtual void AsyncGetStr(const FString& InKey, FGetStrFinished OnFinished);
+		virtual void AsyncGetStr(const FString& InKey, FGetStrFinished OnFinished, bool bReadFromReplica = false);
 
 //	UFUNCTION(BlueprintCallable, Category = "Redis|Set", meta = (DisplayName = "SAdd-Async"))
 		virtual void AsyncSAdd(const FString& InKey, const TArray<FString>& InMemberList);
@@ -185,13 +357,41 @@ public:
 		virtual void AsyncSRem(const FString& InKey, const TArray<FString>& InMemberList);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Set", meta = (DisplayName = "SMembers-Async"))
-		virtual void AsyncSMembers(const FString& InKey, FSMembersFinished OnFinished);
+		virtual void AsyncSMembers(const FString& InKey, FSMembersFinished OnFinished, bool bReadFromReplica = false);
+
+//	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZAdd-Async"))
+		virtual void AsyncZAdd(const FString& InKey, const TArray<FRedisScoredMember>& InMemberList, ERedisZAddFlag InFlag);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZIncrby-Async"))
+		virtual void AsyncZIncrby(const FString& InKey, const FString& InMember, double Incre, FZScoreFinished OnFinished);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRange-Async"))
+		virtual void AsyncZRange(const FString& InKey, int32 Start, int32 Stop, FZRangeFinished OnFinished);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRevRange-Async"))
+		virtual void AsyncZRevRange(const FString& InKey, int32 Start, int32 Stop, FZRangeFinished OnFinished);
+
+	/** Count <= 0 returns every member from Offset on. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRangeByScore-Async"))
+		virtual void AsyncZRangeByScore(const FString& InKey, double Min, double Max, int32 Offset, int32 Count, FZRangeFinished OnFinished);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRank-Async"))
+		virtual void AsyncZRank(const FString& InKey, const FString& InMember, FGetIntFinished OnFinished);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZScore-Async"))
+		virtual void AsyncZScore(const FString& InKey, const FString& InMember, FZScoreFinished OnFinished);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZMScore-Async"))
+		virtual void AsyncZMScore(const FString& InKey, const TArray<FString>& InMemberList, FZRangeFinished OnFinished);
+
+//	UFUNCTION(BlueprintCallable, Category = "Redis|SortedSet", meta = (DisplayName = "ZRem-Async"))
+		virtual void AsyncZRem(const FString& InKey, const TArray<FString>& InMemberList);
 
 //	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HSet-Async"))
 		virtual void AsyncHSet(const FString& InKey, const FString& InField, const FString& InValue);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HGet-Async"))
-		virtual void AsyncHGet(const FString& InKey, const FString& InField, FHGetFinished OnFinished);
+		virtual void AsyncHGet(const FString& InKey, const FString& InField, FHGetFinished OnFinished, bool bReadFromReplica = false);
 
 //	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HMSet-Async"))
 		virtual void AsyncHMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap);
@@ -199,37 +399,254 @@ public:
 //	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HDel-Async"))
 		virtual void AsyncHDel(const FString& InKey, const TArray<FString>& InFieldList);
 
+//	UFUNCTION(BlueprintCallable, Category = "Redis|Stream", meta = (DisplayName = "XAdd-Async"))
+		virtual void AsyncXAdd(const FString& InKey, const TArray<FRedisStreamEntry>& InEntries, int32 InMaxLen);
+
+//	UFUNCTION(BlueprintCallable, Category = "Redis|Stream", meta = (DisplayName = "XAck-Async"))
+		virtual void AsyncXAck(const FString& InKey, const FString& InGroup, const TArray<FString>& InIds);
+
+//	UFUNCTION(BlueprintCallable, Category = "Redis|List", meta = (DisplayName = "AckJob-Async"))
+		virtual void AsyncAckJob(const FString& ProcessingList, const FString& Job);
+
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HMGet-Async"))
-		virtual void AsyncHMGet(const FString& InKey, const TSet<FString>& InFieldList, FHMGetFinished OnFinished);
+		virtual void AsyncHMGet(const FString& InKey, const TSet<FString>& InFieldList, FHMGetFinished OnFinished, bool bReadFromReplica = false);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Hash", meta = (DisplayName = "HGetAll-Async"))
-		virtual void AsyncHGetAll(const FString& InKey, FHGetAllFinished OnFinished);
+		virtual void AsyncHGetAll(const FString& InKey, FHGetAllFinished OnFinished, bool bReadFromReplica = false);
+
+		virtual void AsyncExecPipeline(const FRedisPipeline& InPipeline, FPipelineFinished OnFinished);
+
+	/** Transactions need a connection of their own, so this runs on the thread pool; Build is called there too. */
+	virtual void AsyncExecTransaction(const TSharedRef<FRedisTransaction, ESPMode::ThreadSafe>& InTransaction, FPipelineFinished OnFinished);
+
+	/** Register a Lua script under InName and load it on the server; it is reloaded on every new pooled connection. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Script", meta = (DisplayName = "RegisterScript"))
+		virtual bool RegisterScript(FName InName, const FString& InSource);
+
+	TSharedPtr<URedisScript, ESPMode::ThreadSafe> FindScript(FName InName) const;
+
+	/** EVALSHA of a registered script, retried as EVAL on NOSCRIPT. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Script", meta = (DisplayName = "EvalScript"))
+		virtual bool EvalScript(FName InName, const TArray<FString>& InKeys, const TArray<FString>& InArgs, FRedisReply& OutReply);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|Script", meta = (DisplayName = "EvalScript-Async"))
+		virtual void AsyncEvalScript(FName InName, const TArray<FString>& InKeys, const TArray<FString>& InArgs, FEvalScriptFinished OnFinished);
+
+	/** Walk a keyspace or collection page by page; InIterator's OnPage runs on the game thread. */
+	virtual void AsyncScan(const TSharedRef<FRedisScanIterator, ESPMode::ThreadSafe>& InIterator);
+
+	/** Blocking: fetch the next page into OutElements. Returns false on error or once the iterator is finished. */
+	virtual bool ScanNext(const TSharedRef<FRedisScanIterator, ESPMode::ThreadSafe>& InIterator, TArray<FString>& OutElements);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
 		virtual bool Publish(const FString& Channel, const FString& Message);
 	
+	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
+		virtual bool PublishBytes(const FString& Channel, const TArray<uint8>& Message);
+
+	/** Messages on Channel are broadcast through SubscribeReply. */
 	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
 		virtual void Subscribe(const FString& Channel);
 
 	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
 		virtual void Unsubscribe(const FString& Channel);
 
+	/** Like Subscribe, with Handler also called for every message on Channel. One handler per channel. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
+		virtual void SubscribeChannel(const FString& Channel, FRedisMessageHandler Handler);
+
+	/**
+	 * For channels carrying snapshots: while Handler is behind, only the newest message per channel
+	 * is kept, or per value of the top-level JSON field KeyField when given. Stale ones are dropped.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
+		virtual void SubscribeConflated(const FString& Channel, FRedisMessageHandler Handler, const FString& KeyField);
+
+	/** Conflated per matching channel (and KeyField value). */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
+		virtual void PSubscribeConflated(const FString& Pattern, FRedisMessageHandler Handler, const FString& KeyField);
+
+	/** Glob-style pattern; Handler gets the channel each message was published to. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
+		virtual void PSubscribe(const FString& Pattern, FRedisMessageHandler Handler);
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|Pub/Sub")
+		virtual void PUnsubscribe(const FString& Pattern);
+
+	/** Messages received and waiting for Tick. */
+	UFUNCTION(BlueprintPure, Category = "Redis|Pub/Sub")
+		int32 GetPubSubBacklog() const;
+
+	/** Seconds the oldest undelivered message has been waiting. */
+	UFUNCTION(BlueprintPure, Category = "Redis|Pub/Sub")
+		float GetPubSubOldestAge() const;
+
+	/**
+	 * Queue and round trip percentiles of every command type run so far, sync and async. Shared by
+	 * every URedisObject in the process.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Latency")
+		void GetCommandLatencies(TArray<FRedisCommandLatency>& OutLatencies) const;
+
+	/** Writes GetCommandLatencies as CSV, one line per command type. */
+	UFUNCTION(BlueprintCallable, Category = "Redis|Latency")
+		bool DumpLatencyCsv(const FString& Path) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Redis|Latency")
+		void ResetLatencies();
+
+	/**
+	 * Primary changes followed through SentinelHosts so far, and the seconds the last one took to
+	 * repoint the pool, the async engine and the subscriber. False when no sentinel is running.
+	 */
+	bool GetSentinelSwitches(int32& OutSwitches, double& OutRepointSeconds) const;
+
 	bool Tick(float DeltaTime);
 
 // 	UFUNCTION(BlueprintCallable, Category = "Redis", meta = (DisplayName = "OnTestRedis"))
 // 		virtual bool OnTest(const FString& InKey);
 
 
+	virtual void BeginDestroy() override;
+
 	UPROPERTY(BlueprintAssignable)
 	FSubscribeReply SubscribeReply;
 
+	/** Connections the async engine multiplexes Async* calls over. Read by Init. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	int32 AsyncConnectionNum = 2;
+
+	/** Blocking connections opened up front by Init and kept open while idle. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	int32 MinPoolSize = 2;
+
+	/** Upper bound on blocking connections; sync calls beyond it wait for one to be released. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	int32 MaxPoolSize = 16;
+
+	/** Seconds an idle connection above MinPoolSize is kept before being closed. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	float PoolIdleTimeout = 60.f;
+
+	/** Connections idle for longer than this many seconds are PINGed before reuse. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	float PoolValidateAfter = 10.f;
+
+	/** Host:Port is one seed node of a Redis Cluster; commands are routed by key slot. Read by Init. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	bool bClusterMode = false;
+
+	/**
+	 * Standalone servers as "host:port" to shard keys over on a consistent-hash ring; Host:Port
+	 * is then ignored. Keys sharing a {hashtag} stay on one shard. Read by Init.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	TArray<FString> ShardHosts;
+
+	/** Ring points per shard; more points even out the key spread. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	int32 ShardVirtualNodes = 160;
+
+	/**
+	 * Read replicas as "host:port", authenticated with the primary's password. Read by Init.
+	 * Read calls opt in with bReadFromReplica, for callers that can live with replication lag;
+	 * without it, and for everything else, commands stay on the primary and see every write.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	TArray<FString> ReplicaHosts;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	ERedisReplicaBalance ReplicaBalance = ERedisReplicaBalance::RoundRobin;
+
+	/**
+	 * Sentinels as "host:port". When set, Init asks them for the primary of SentinelMasterName
+	 * (Host:Port is only the fallback) and follows every failover without a Reconnect.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	TArray<FString> SentinelHosts;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	FString SentinelMasterName = TEXT("mymaster");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Pub/Sub")
+	ERedisPubSubDrain PubSubDrain = ERedisPubSubDrain::All;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Pub/Sub")
+	int32 PubSubMaxMessagesPerTick = 256;
+
+	/** Microseconds of handler time per tick under ERedisPubSubDrain::TimeBudget. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Pub/Sub")
+	int32 PubSubTickBudgetUs = 1000;
+
+	/**
+	 * Codec SetStr and AsyncSetStr compress long values with. GetStr, MGet and their async versions
+	 * recognize compressed values whatever this is set to, and decompress them off the game thread
+	 * when async. Append, like GETRANGE and STRLEN in scripts or pipelines, works on the stored
+	 * bytes, so none of them can be used on keys that may hold compressed values.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Compression")
+	ERedisCompression Compression = ERedisCompression::None;
+
+	/** Values shorter than this many characters are stored as they are. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Compression")
+	int32 CompressionThreshold = 4096;
+
+	/**
+	 * Hash holding the dictionaries trained by the RedisDictionary commandlet. When set, HSet,
+	 * HMSet and their async versions compress field values against the current dictionary;
+	 * HGet, HMGet and HGetAll decompress them with whichever one they were written with.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Compression")
+	FString CompressionDictionaryKey;
+
+	/** Field values shorter than this many characters are stored as they are. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Compression")
+	int32 DictionaryCompressionThreshold = 64;
+
+	/** Seconds a blocking connection may take to connect. Read by Init. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Redis|Connect")
+	float ConnectTimeout = 1.f;
+
 private:
 
-	TSharedPtr<URedisClient> FindOrNewRedisClient();
+	void LoadScripts(URedisClient& InRedisClient);
 
-	void RecycleRedisClient(TSharedPtr<URedisClient> InRedisClient);
+	/** Sets InRequest's completion, resubmitting it as EVAL (InEvalArgs after the source) if the server answers NOSCRIPT. */
+	void SetScriptReply(FRedisAsyncRequest* InRequest, const FString& InKey, const TSharedRef<URedisScript, ESPMode::ThreadSafe>& InScript, TArray<FString>&& InEvalArgs, TFunction<void(redisReply*)>&& InOnReply);
 
-	void SubscribeCallback(FString Channel, FString Message);
+	void RequestScanPage(const TSharedRef<FRedisScanIterator, ESPMode::ThreadSafe>& InIterator);
+
+	void OnScanPage(FAsyncResultScan* InResult);
+
+	/** Runs InCommand on a pooled connection, or on the cluster node owning InKey. */
+	bool RunCommand(const FString& InKey, TFunctionRef<bool(URedisClient&)> InCommand);
+
+	void SubmitRequest(const FString& InKey, FRedisAsyncRequest* InRequest);
+
+	/** Like RunCommand, on a replica when asked and there is one; falls back to the primary if no replica is usable. */
+	bool RunRead(const FString& InKey, bool bReadFromReplica, TFunctionRef<bool(URedisClient&)> InCommand);
+
+	void SubmitRead(const FString& InKey, bool bReadFromReplica, FRedisAsyncRequest* InRequest);
+
+	void StartSubscriber(const FString& InHost, int32 InPort);
+
+	/** Hands queued pub/sub messages to their handlers as PubSubDrain allows. */
+	void DeliverMessages();
+
+	/** Follows failovers of SentinelMasterName, starting from the primary at InHost:InPort. */
+	void StartSentinel(const FString& InHost, int32 InPort);
+
+	/** A connection of its own on the primary owning InKey, for blocking commands. */
+	TSharedPtr<URedisClient> ConnectDedicated(const FString& InKey);
+
+	void OnStreamBatch(FAsyncResultStream* InResult);
+
+	void OnListJob(FAsyncResultJob* InResult);
+
+	/** Slot a transaction runs on: its first watched key, otherwise the key of its first command. */
+	static FString GetTransactionKey(const FRedisTransaction& InTransaction);
+
+	void WarnClusterKeyspaceScan(const FRedisScanIterator& InIterator) const;
 
 private:
 	UPROPERTY()
@@ -243,18 +660,56 @@ private:
 private:
 	bool bInitFinished;
 
-	TSharedPtr<URedisClient> SyncRedisClient;
+	TSharedPtr<FRedisConnectionPool> ConnectionPool;
 
-	TSharedPtr<URedisClient> SubscribeRedisClient;
+	TSharedPtr<FRedisAsyncEngine> AsyncEngine;
 
-	TArray<TSharedPtr<URedisClient>> IdleRedisClients;
+	/** Set instead of ConnectionPool/AsyncEngine in cluster and sharded mode. */
+	TSharedPtr<FRedisCluster, ESPMode::ThreadSafe> Cluster;
 
-	UPROPERTY()
-	URedisSubscribeObject* SubscribeObject;
-	UPROPERTY()
-		TMap<FString, URedisSubscribeObject*> SubscribeMap;
+	TSharedPtr<FRedisReplicaSet> ReplicaSet;
+
+	TSharedPtr<FRedisSentinel> Sentinel;
+
+	/** What hash field values are written with; null until LoadCompressionDictionaries found one. */
+	TSharedPtr<const FRedisCompressionDictionary, ESPMode::ThreadSafe> CompressionDictionary;
+
+	/** The one connection every channel and pattern is subscribed on. */
+	TSharedPtr<FRedisSubscriber> Subscriber;
+
+	/** Game thread only. */
+	TMap<FString, FRedisMessageHandler> ChannelHandlers;
+	TMap<FString, FRedisMessageHandler> PatternHandlers;
+
+	struct FStreamConsumerState
+	{
+		TSharedPtr<FRedisStreamConsumer> Consumer;
+		FStreamEntriesReceived OnEntries;
+		FString Group;
+		bool bAckAfterHandler;
+	};
+
+	struct FListConsumerState
+	{
+		TSharedPtr<FRedisListConsumer> Consumer;
+		FListJobReceived OnJob;
+		FString ProcessingList;
+		bool bAckAfterHandler;
+	};
+
+	/** Game thread only. */
+	TMap<int32, FStreamConsumerState> StreamConsumers;
+	TMap<int32, FListConsumerState> ListConsumers;
+	int32 LastConsumerId = 0;
+	/** Stopped, waiting for their read in flight to return. */
+	TArray<TSharedPtr<FRedisBlockingConsumer>> StoppingConsumers;
+
+	/** Pool-thread work that still holds on to this object. */
+	FThreadSafeCounter BackgroundTasks;
 
-	bool bSubscribed;
+	/** Registered scripts; read from pool and I/O threads. */
+	TMap<FName, TSharedRef<URedisScript, ESPMode::ThreadSafe>> Scripts;
+	mutable FCriticalSection ScriptsLock;
 
 	FDelegateHandle TickerHandle;
 	FTickerDelegate OnTickerDelegate;
@@ -268,5 +723,12 @@ private:
 	DECLARE_ASYNC_RESULTS(FAsyncResultHMGet, HMGet);
 	DECLARE_ASYNC_RESULTS(FAsyncResultHGetAll, HGetAll);
 	DECLARE_ASYNC_RESULTS(FAsyncResultSMembers, SMembers);
+	DECLARE_ASYNC_RESULTS(FAsyncResultPipeline, Pipeline);
+	DECLARE_ASYNC_RESULTS(FAsyncResultZRange, ZRange);
+	DECLARE_ASYNC_RESULTS(FAsyncResultZScore, ZScore);
+	DECLARE_ASYNC_RESULTS(FAsyncResultScript, Script);
+	DECLARE_ASYNC_RESULTS(FAsyncResultScan, Scan);
+	DECLARE_ASYNC_RESULTS(FAsyncResultStream, Stream);
+	DECLARE_ASYNC_RESULTS(FAsyncResultJob, Job);
 
 };
@@ -0,0 +1,128 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RedisScript.h"
+
+/**
+ * Queues commands so they can be written to the server in one batch and their
+ * replies read back in order, paying a single round trip for the whole batch.
+ * Replies are returned as one FRedisReply per queued command.
+ */
+class REDISPLUGIN_API FRedisPipeline
+{
+public:
+
+	FRedisPipeline();
+
+	/** Queue an arbitrary command. The first element is the command name. */
+	FRedisPipeline& Command(const TArray<FString>& InArgs);
+
+	/* Key */
+	FRedisPipeline& ExistsKey(const FString& InKey);
+
+	FRedisPipeline& ExpireKey(const FString& InKey, int32 Sec);
+
+	FRedisPipeline& PersistKey(const FString& InKey);
+
+	FRedisPipeline& DelKey(const FString& InKey);
+
+	/* Str */
+	FRedisPipeline& MSet(const TMap<FString, FString>& InMemberMap);
+
+	FRedisPipeline& MGet(const TArray<FString>& InKeyList);
+
+	FRedisPipeline& SetInt(const FString& InKey, int32 InValue);
+
+	FRedisPipeline& SetStr(const FString& InKey, const FString& InValue);
+
+	FRedisPipeline& GetStr(const FString& InKey);
+
+	FRedisPipeline& Incrby(const FString& InKey, int32 Incre);
+
+	/* Set */
+	FRedisPipeline& SAdd(const FString& InKey, const TArray<FString>& InMemberList);
+
+	FRedisPipeline& SRem(const FString& InKey, const TArray<FString>& InMemberList);
+
+	FRedisPipeline& SMembers(const FString& InKey);
+
+	/* Hash */
+	FRedisPipeline& HSet(const FString& InKey, const FString& InField, const FString& InValue);
+
+	FRedisPipeline& HGet(const FString& InKey, const FString& InField);
+
+	FRedisPipeline& HIncrby(const FString& InKey, const FString& InField, int32 Incre);
+
+	FRedisPipeline& HMSet(const FString& InKey, const TMap<FString, FString>& InMemberMap);
+
+	FRedisPipeline& HDel(const FString& InKey, const TArray<FString>& InFieldList);
+
+	FRedisPipeline& HMGet(const FString& InKey, const TArray<FString>& InFieldList);
+
+	FRedisPipeline& HGetAll(const FString& InKey);
+
+	/* List */
+	FRedisPipeline& LPush(const FString& InKey, const TArray<FString>& InFieldList);
+
+	FRedisPipeline& RPush(const FString& InKey, const TArray<FString>& InFieldList);
+
+	FRedisPipeline& LPop(const FString& InKey);
+
+	FRedisPipeline& RPop(const FString& InKey);
+
+	FRedisPipeline& LRange(const FString& InKey, int32 Start, int32 End);
+
+	/* Pub/Sub */
+	FRedisPipeline& Publish(const FString& InChannel, const FString& InMessage);
+
+	/* Script */
+	/** Queued as EVALSHA; a NOSCRIPT reply is retried as EVAL once the rest of the batch has run. */
+	FRedisPipeline& EvalScript(const TSharedRef<URedisScript, ESPMode::ThreadSafe>& InScript, const TArray<FString>& InKeys, const TArray<FString>& InArgs);
+
+	bool HasScripts() const
+	{
+		return Scripts.Num() > 0;
+	}
+
+	/** Script queued at InCommandIndex, or null if that command is not a script call. */
+	TSharedPtr<URedisScript, ESPMode::ThreadSafe> FindScript(int32 InCommandIndex) const;
+
+	/** Number of queued commands. */
+	int32 Num() const
+	{
+		return ArgCounts.Num();
+	}
+
+	bool IsEmpty() const
+	{
+		return ArgCounts.Num() == 0;
+	}
+
+	void Reset();
+
+	/** Calls Func(const FString* Args, int32 ArgCount) for every queued command, in order. */
+	template<typename FuncType>
+	void ForEachCommand(FuncType Func) const
+	{
+		int32 Offset = 0;
+		for (int32 ArgCount : ArgCounts)
+		{
+			Func(Args.GetData() + Offset, ArgCount);
+			Offset += ArgCount;
+		}
+	}
+
+private:
+
+	FRedisPipeline& Begin(const TCHAR* InCommand);
+
+	FRedisPipeline& AddArg(const FString& InArg);
+
+	TArray<FString>	Args;
+	TArray<int32>	ArgCounts;
+
+	/** Command index of every EvalScript call, for the NOSCRIPT fallback. */
+	TArray<TPair<int32, TSharedRef<URedisScript, ESPMode::ThreadSafe>>>	Scripts;
+};
@@ -0,0 +1,91 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class ERedisScanType : uint8
+{
+	/** SCAN over the keyspace, Key is ignored. */
+	Keys,
+	/** SSCAN, pages hold members. */
+	Set,
+	/** HSCAN, pages hold field/value pairs. */
+	Hash,
+	/** ZSCAN, pages hold member/score pairs. */
+	SortedSet,
+};
+
+/** Called once per page. Return false to stop the walk. */
+DECLARE_DELEGATE_RetVal_OneParam(bool, FRedisScanPage, const TArray<FString>&);
+/** bCompleted is true when the cursor ran out, false on errors, cancel or an early stop. */
+DECLARE_DELEGATE_OneParam(FRedisScanFinished, bool);
+
+/**
+ * Cursor-based walk over the keyspace or one set/hash/sorted set, a page at a time,
+ * so memory stays bounded by the page size whatever the size of the collection.
+ * Pass it to URedisObject::AsyncScan for game-thread callbacks, or call URedisObject::ScanNext
+ * in a loop from any thread. Like SCAN itself, elements may be returned more than once.
+ */
+class REDISPLUGIN_API FRedisScanIterator : public TSharedFromThis<FRedisScanIterator, ESPMode::ThreadSafe>
+{
+public:
+
+	FRedisScanIterator(ERedisScanType InType, const FString& InKey = FString()) :
+		Type(InType),
+		Key(InKey),
+		Count(0),
+		bPrefetch(false),
+		Cursor(TEXT("0")),
+		bStarted(false),
+		bFinished(false),
+		bCancelled(false)
+	{	}
+
+	/** Stops an AsyncScan; OnFinished fires with false once the page in flight lands. */
+	void Cancel()
+	{
+		bCancelled = true;
+	}
+
+	bool IsFinished() const
+	{
+		return bFinished;
+	}
+
+	/** Opaque server cursor, "0" before the first and after the last page. */
+	const FString& GetCursor() const
+	{
+		return Cursor;
+	}
+
+public:
+	const ERedisScanType	Type;
+	const FString			Key;
+
+	/** MATCH glob, empty for none. */
+	FString		Match;
+
+	/** COUNT hint, 0 for the server default. */
+	int32		Count;
+
+	/** AsyncScan only: request the next page before OnPage runs, so fetching overlaps processing. */
+	bool		bPrefetch;
+
+	FRedisScanPage		OnPage;
+	FRedisScanFinished	OnFinished;
+
+private:
+	friend class URedisObject;
+
+	void Finish(bool bCompleted)
+	{
+		bFinished = true;
+		OnFinished.ExecuteIfBound(bCompleted);
+	}
+
+	FString		Cursor;
+	bool		bStarted;
+	bool		bFinished;
+	bool		bCancelled;
+};
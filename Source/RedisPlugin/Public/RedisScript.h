@@ -0,0 +1,44 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Lua script registered with URedisObject::RegisterScript.
+ * The SHA1 is computed locally from the UTF-8 source, so calls can go out as EVALSHA
+ * without asking the server first; a NOSCRIPT reply falls back to EVAL transparently.
+ */
+class REDISPLUGIN_API URedisScript
+{
+public:
+
+	URedisScript(FName InName, const FString& InSource);
+
+	FName GetName() const
+	{
+		return Name;
+	}
+
+	const FString& GetSource() const
+	{
+		return Source;
+	}
+
+	/** Lowercase hex, as SCRIPT LOAD reports it. */
+	const FString& GetSha1() const
+	{
+		return Sha1;
+	}
+
+	/** True for the error Redis returns when EVALSHA names a script it has not cached. */
+	static bool IsNoScriptError(const FString& InError)
+	{
+		return InError.StartsWith(TEXT("NOSCRIPT"));
+	}
+
+private:
+	FName		Name;
+	FString		Source;
+	FString		Sha1;
+};
@@ -0,0 +1,79 @@
+// Copyright (C) 2019 GameSeed - All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RedisPipeline.h"
+
+struct FRedisReply;
+
+/**
+ * MULTI/EXEC transaction with WATCH-based optimistic concurrency.
+ *
+ * Without Build, WATCH, MULTI, Commands and EXEC go out as one pipelined write.
+ * With Build, WATCH and Reads go out first; Build turns their replies into the commands
+ * to run, and MULTI ... EXEC follows as a second write. If a watched key changed in
+ * between, EXEC comes back nil and the whole sequence is retried, up to MaxAttempts.
+ * Replies are one FRedisReply per queued command, as returned by EXEC.
+ */
+class REDISPLUGIN_API FRedisTransaction
+{
+public:
+
+	FRedisTransaction() :
+		MaxAttempts(5)
+	{	}
+
+	FRedisTransaction& Watch(const FString& InKey)
+	{
+		WatchKeys.Add(InKey);
+		return *this;
+	}
+
+	FRedisTransaction& Watch(const TArray<FString>& InKeys)
+	{
+		WatchKeys.Append(InKeys);
+		return *this;
+	}
+
+	/** Issued right after WATCH, outside the transaction. Their replies are handed to Build. */
+	FRedisPipeline& Reads()
+	{
+		return ReadCommands;
+	}
+
+	/** Transaction body when Build is not set. */
+	FRedisPipeline& Commands()
+	{
+		return BodyCommands;
+	}
+
+	const TArray<FString>& GetWatchKeys() const
+	{
+		return WatchKeys;
+	}
+
+	const FRedisPipeline& GetReads() const
+	{
+		return ReadCommands;
+	}
+
+	const FRedisPipeline& GetCommands() const
+	{
+		return BodyCommands;
+	}
+
+	/**
+	 * Fills OutCommands from the replies of Reads(); called once per attempt on the thread
+	 * running the transaction. Return false to give up (the keys are unwatched).
+	 */
+	TFunction<bool(const TArray<FRedisReply>& ReadReplies, FRedisPipeline& OutCommands)> Build;
+
+	/** Attempts before giving up on a contended key. */
+	int32 MaxAttempts;
+
+private:
+	TArray<FString>	WatchKeys;
+	FRedisPipeline	ReadCommands;
+	FRedisPipeline	BodyCommands;
+};
@@ -40,6 +40,7 @@ public class RedisPlugin : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
+				"TraceLog",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -52,6 +53,9 @@ public class RedisPlugin : ModuleRules
 			}
 			);
 
+        // Preset dictionaries for hash value compression, which FCompression does not expose
+        AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
+
         string ThirdPartyPath = "../ThirdParty/";
 
         if (Target.Platform == UnrealTargetPlatform.Win64)